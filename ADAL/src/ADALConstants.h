@@ -31,6 +31,10 @@ extern NSString *const ADAL_BROKER_HASH_KEY;
 
 extern NSString *const ADAL_CLIENT_TELEMETRY;
 
+extern NSString *const ADAL_TELEMETRY_EVENT_CIRCUIT_BREAKER;
+extern NSString *const ADAL_TELEMETRY_KEY_CIRCUIT_BREAKER_HOST;
+extern NSString *const ADAL_TELEMETRY_KEY_CIRCUIT_BREAKER_STATE;
+
 //Diagnostic traces sent to the Azure Active Directory servers:
 extern NSString *const ADAL_ID_VERSION;
 
@@ -32,6 +32,10 @@ NSString *const ADAL_BROKER_HASH_KEY                 = @"hash";
 
 NSString *const ADAL_CLIENT_TELEMETRY           = @"x-ms-clitelem";
 
+NSString *const ADAL_TELEMETRY_EVENT_CIRCUIT_BREAKER       = @"Microsoft.ADAL.circuit_breaker";
+NSString *const ADAL_TELEMETRY_KEY_CIRCUIT_BREAKER_HOST    = @"Microsoft.ADAL.circuit_breaker_host";
+NSString *const ADAL_TELEMETRY_KEY_CIRCUIT_BREAKER_STATE   = @"Microsoft.ADAL.circuit_breaker_state";
+
 //Diagnostic traces sent to the Azure Active Directory servers:
 NSString *const ADAL_ID_VERSION           = @"x-client-Ver";
 
@@ -27,6 +27,7 @@
 #import "ADAL_Internal.h"
 
 @class ADUserIdentifier;
+@class ADRequestTemplate;
 @protocol ADTokenCacheDataSource;
 
 #import "ADAuthenticationContext.h"
@@ -40,6 +41,17 @@ extern NSString* const ADInteractionNotSupportedInExtension;
 extern NSString* const ADServerError;
 extern NSString* const ADRedirectUriInvalidError;
 
+@interface ADAuthenticationContext ()
+
+/*!
+    Returns the request template for the client ID and redirect URI, creating it on first use.
+    Templates are kept per context, so all requests made through it share the encoded segments.
+ */
+- (ADRequestTemplate *)requestTemplateWithClientId:(NSString *)clientId
+                                       redirectUri:(NSString *)redirectUri;
+
+@end
+
 @interface ADAuthenticationContext (Internal)
 
 + (BOOL)handleNilOrEmptyAsResult:(NSObject *)argumentValue
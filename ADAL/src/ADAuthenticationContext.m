@@ -26,6 +26,7 @@
 #import "ADRequestParameters.h"
 #if TARGET_OS_IPHONE
 #import "ADKeychainTokenCache+Internal.h"
+#import "ADKeychainUtil.h"
 #endif 
 
 #import "ADAuthenticationContext+Internal.h"
@@ -40,9 +41,13 @@
 #import "MSIDMacTokenCache.h"
 #import "MSIDKeychainTokenCache.h"
 #import "MSIDLegacyTokenCacheAccessor.h"
-#import "MSIDDefaultTokenCacheAccessor.h"
 #import "ADTokenCache.h"
-#import "MSIDAADV1Oauth2Factory.h"
+#import "ADRequestTemplate.h"
+#import "ADRequestDeadline.h"
+#import "ADCancellationHandle.h"
+#import "ADAuthorityValidation.h"
+#import "ADTokenCacheRegistry.h"
+#import "ADTokenCacheItem+Internal.h"
 
 typedef void(^ADAuthorizationCodeCallback)(NSString*, ADAuthenticationError*);
 
@@ -58,6 +63,8 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
 @property (nonatomic) ADTokenCache *legacyMacCache;
 // iOS keychain group.
 @property (nonatomic) NSString *sharedGroup;
+// Request templates keyed by client ID and redirect URI.
+@property (nonatomic) NSCache *requestTemplates;
 
 @end
 
@@ -68,15 +75,23 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
 @synthesize correlationId = _correlationId;
 @synthesize credentialsType = _credentialsType;
 @synthesize extendedLifetimeEnabled = _extendedLifetimeEnabled;
+@synthesize acquireTokenTimeout = _acquireTokenTimeout;
+@synthesize requestQualityOfService = _requestQualityOfService;
 @synthesize logComponent = _logComponent;
 @synthesize webView = _webView;
 
-+ (void)load
++ (void)initialize
 {
-    // +load is called by the ObjC runtime before main() as it loads in ObjC symbols and
-    // populates the runtime.
+    // Done on the first use of the class rather than in +load, which the ObjC runtime calls
+    // before main() for every app linking ADAL whether it acquires tokens or not.
+    if (self != [ADAuthenticationContext class])
+    {
+        return;
+    }
     
     NSLog(@"ADAL version %@", ADAL_VERSION_VAR);
+    
+    [ADTokenCacheItem setupArchiverClassNames];
 }
 
 - (id)init
@@ -94,12 +109,11 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
 {
     API_ENTRY;
     
-    self.sharedGroup = sharedGroup;
-    MSIDKeychainTokenCache *keychainTokenCache = [[MSIDKeychainTokenCache alloc] initWithGroup:sharedGroup];
+    MSIDKeychainTokenCache *keychainTokenCache = [[ADTokenCacheRegistry sharedRegistry] keychainCacheForGroup:sharedGroup];
     // In case if sharedGroup is nil, keychainTokenCache.keychainGroup will return default group.
     // Note: it is in the following format: <team id>.<sharedGroup>
     self.sharedGroup = keychainTokenCache.keychainGroup;
-    MSIDLegacyTokenCacheAccessor *tokenCache = [self createIosCache:keychainTokenCache];
+    MSIDLegacyTokenCacheAccessor *tokenCache = [self sharedCacheForDataSource:keychainTokenCache];
     
     return [self initWithAuthority:authority
                  validateAuthority:bValidate
@@ -117,7 +131,8 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     self.legacyMacCache = [ADTokenCache new];
     self.legacyMacCache.delegate = delegate;
 
-    MSIDLegacyTokenCacheAccessor *tokenCache = [self createMacCache:self.legacyMacCache.macTokenCache];
+    // The cache belongs to this context alone, so there is nothing to share the accessor with
+    MSIDLegacyTokenCacheAccessor *tokenCache = [ADTokenCacheRegistry createAccessorForDataSource:self.legacyMacCache.macTokenCache];
     
     return [self initWithAuthority:authority
                  validateAuthority:validateAuthority
@@ -133,11 +148,11 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     MSIDLegacyTokenCacheAccessor *tokenCache = nil;
 
 #if TARGET_OS_IPHONE
-    tokenCache = [self createIosCache:[MSIDKeychainTokenCache defaultKeychainCache]];
+    tokenCache = [self sharedCacheForDataSource:[[ADTokenCacheRegistry sharedRegistry] keychainCacheForGroup:nil]];
     self.sharedGroup = MSIDKeychainTokenCache.defaultKeychainGroup;
 #else
     self.legacyMacCache = [ADTokenCache defaultCache];
-    tokenCache = [self createMacCache:self.legacyMacCache.macTokenCache];
+    tokenCache = [[ADTokenCacheRegistry sharedRegistry] accessorForDataSource:self.legacyMacCache.macTokenCache];
 #endif
     
     return [self initWithAuthority:authority
@@ -167,11 +182,34 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     _validateAuthority = validateAuthority;
     _credentialsType = AD_CREDENTIALS_EMBEDDED;
     _extendedLifetimeEnabled = NO;
+    _requestQualityOfService = NSQualityOfServiceDefault;
     _tokenCache = tokenCache;
+    _requestTemplates = [NSCache new];
     
     return self;
 }
 
+- (ADRequestTemplate *)requestTemplateWithClientId:(NSString *)clientId
+                                       redirectUri:(NSString *)redirectUri
+{
+    NSString *key = [NSString stringWithFormat:@"%@|%@", clientId, redirectUri];
+    
+    @synchronized (_requestTemplates)
+    {
+        ADRequestTemplate *requestTemplate = [_requestTemplates objectForKey:key];
+        
+        if (!requestTemplate)
+        {
+            requestTemplate = [[ADRequestTemplate alloc] initWithAuthority:_authority
+                                                           clientId:clientId
+                                                        redirectUri:redirectUri];
+            [_requestTemplates setObject:requestTemplate forKey:key];
+        }
+        
+        return requestTemplate;
+    }
+}
+
 - (ADAuthenticationRequest*)requestWithRedirectString:(NSString*)redirectUri
                                              clientId:(NSString*)clientId
                                              resource:(NSString*)resource
@@ -187,6 +225,8 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [requestParams setRedirectUri:redirectUri];
     [requestParams setExtendedLifetime:_extendedLifetimeEnabled];
     [requestParams setLogComponent:_logComponent];
+    [requestParams setCancellationHandle:[ADCancellationHandle new]];
+    [requestParams setQosClass:[ADHelpers qosClassForQualityOfService:_requestQualityOfService]];
 
     ADAuthenticationRequest *request = [ADAuthenticationRequest requestWithContext:self
                                                                      requestParams:requestParams
@@ -194,6 +234,11 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
                                                                              error:&error];
     request.sharedGroup = self.sharedGroup;
     
+    if (_acquireTokenTimeout > 0)
+    {
+        [request setDeadline:[ADRequestDeadline deadlineWithTimeout:_acquireTokenTimeout]];
+    }
+    
     if (!request)
     {
         completionBlock([ADAuthenticationResult resultFromError:error correlationId:_correlationId]);
@@ -288,29 +333,29 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     THROW_ON_NIL_ARGUMENT(completionBlock) \
     CHECK_STRING_ARG_BLOCK(_clientId) \
     ADAuthenticationRequest* request = [self requestWithRedirectString:_redirect clientId:_clientId resource:_resource completionBlock:completionBlock]; \
-    if (!request) { return; } \
+    if (!request) { return nil; } \
     [request setLogComponent:_logComponent];
 
 #define REQUEST_WITH_REDIRECT_URL(_redirect, _clientId, _resource) \
     THROW_ON_NIL_ARGUMENT(completionBlock) \
     CHECK_STRING_ARG_BLOCK(_clientId) \
     ADAuthenticationRequest* request = [self requestWithRedirectUrl:_redirect clientId:_clientId resource:_resource completionBlock:completionBlock]; \
-    if (!request) { return; } \
+    if (!request) { return nil; } \
     [request setLogComponent:_logComponent];
 
 #define CHECK_STRING_ARG_BLOCK(_arg) \
     if ([NSString msidIsStringNilOrBlank:_arg]) { \
         ADAuthenticationError* error = [ADAuthenticationError invalidArgumentError:@#_arg " cannot be nil" correlationId:_correlationId]; \
         completionBlock([ADAuthenticationResult resultFromError:error correlationId:_correlationId]); \
-        return; \
+        return nil; \
     }
 
-- (void)acquireTokenForAssertion:(NSString*)assertion
-                   assertionType:(ADAssertionType)assertionType
-                        resource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                          userId:(NSString*)userId
-                 completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenForAssertion:(NSString*)assertion
+                                     assertionType:(ADAssertionType)assertionType
+                                          resource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                            userId:(NSString*)userId
+                                   completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_STRING(nil, clientId, resource);
@@ -323,25 +368,28 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     
     [request acquireToken:@"6" completionBlock:completionBlock];
     
+    return [request cancellationHandle];
 }
 
 
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                 completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                   completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
     
     [request acquireToken:@"118" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                          userId:(NSString*)userId
-                 completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                            userId:(NSString*)userId
+                                   completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
@@ -349,14 +397,16 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [request setUserId:userId];
     
     [request acquireToken:@"121" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                          userId:(NSString*)userId
-            extraQueryParameters:(NSString*)queryParams
-                 completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                            userId:(NSString*)userId
+                              extraQueryParameters:(NSString*)queryParams
+                                   completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
@@ -365,25 +415,29 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [request setExtraQueryParameters:queryParams];
     
     [request acquireToken:@"124" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenSilentWithResource:(NSString*)resource
-                              clientId:(NSString*)clientId
-                           redirectUri:(NSURL*)redirectUri
-                       completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenSilentWithResource:(NSString*)resource
+                                                clientId:(NSString*)clientId
+                                             redirectUri:(NSURL*)redirectUri
+                                         completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
     [request setSilent:YES];
     
     [request acquireToken:@"7" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenSilentWithResource:(NSString*)resource
-                              clientId:(NSString*)clientId
-                           redirectUri:(NSURL*)redirectUri
-                                userId:(NSString*)userId
-                       completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenSilentWithResource:(NSString*)resource
+                                                clientId:(NSString*)clientId
+                                             redirectUri:(NSURL*)redirectUri
+                                                  userId:(NSString*)userId
+                                         completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
@@ -392,15 +446,36 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [request setSilent:YES];
     
     [request acquireToken:@"8" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
+}
+
+- (ADCancellationHandle *)acquireTokenSilentWithResource:(NSString*)resource
+                                                clientId:(NSString*)clientId
+                                             redirectUri:(NSURL*)redirectUri
+                                                  userId:(NSString*)userId
+                                    staleWhileRevalidate:(BOOL)staleWhileRevalidate
+                                         completionBlock:(ADAuthenticationCallback)completionBlock
+{
+    API_ENTRY;
+    REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
+    
+    [request setUserId:userId];
+    [request setSilent:YES];
+    [request setStaleWhileRevalidate:staleWhileRevalidate];
+    
+    [request acquireToken:@"138" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                  promptBehavior:(ADPromptBehavior)promptBehavior
-                          userId:(NSString*)userId
-            extraQueryParameters:(NSString*)queryParams
-                 completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                    promptBehavior:(ADPromptBehavior)promptBehavior
+                                            userId:(NSString*)userId
+                              extraQueryParameters:(NSString*)queryParams
+                                   completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
@@ -410,15 +485,17 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [request setExtraQueryParameters:queryParams];
     
     [request acquireToken:@"127" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                  promptBehavior:(ADPromptBehavior)promptBehavior
-                  userIdentifier:(ADUserIdentifier*)userId
-            extraQueryParameters:(NSString*)queryParams
-                 completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                    promptBehavior:(ADPromptBehavior)promptBehavior
+                                    userIdentifier:(ADUserIdentifier*)userId
+                              extraQueryParameters:(NSString*)queryParams
+                                   completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
@@ -428,16 +505,18 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [request setExtraQueryParameters:queryParams];
     
     [request acquireToken:@"130" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenWithResource:(NSString *)resource
-                        clientId:(NSString *)clientId
-                     redirectUri:(NSURL *)redirectUri
-                  promptBehavior:(ADPromptBehavior)promptBehavior
-                  userIdentifier:(ADUserIdentifier *)userId
-            extraQueryParameters:(NSString *)queryParams
-                          claims:(NSString *)claims
-                 completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString *)resource
+                                          clientId:(NSString *)clientId
+                                       redirectUri:(NSURL *)redirectUri
+                                    promptBehavior:(ADPromptBehavior)promptBehavior
+                                    userIdentifier:(ADUserIdentifier *)userId
+                              extraQueryParameters:(NSString *)queryParams
+                                            claims:(NSString *)claims
+                                   completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
@@ -448,13 +527,15 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [request setClaims:claims];
     
     [request acquireToken:@"133" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenWithRefreshToken:(NSString *)refreshToken
-                            resource:(NSString *)resource
-                            clientId:(NSString *)clientId
-                         redirectUri:(NSURL *)redirectUri
-                     completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenWithRefreshToken:(NSString *)refreshToken
+                                              resource:(NSString *)resource
+                                              clientId:(NSString *)clientId
+                                           redirectUri:(NSURL *)redirectUri
+                                       completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
@@ -464,14 +545,16 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [request setSilent:YES];
     
     [request acquireToken:@"136" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-- (void)acquireTokenWithRefreshToken:(NSString *)refreshToken
-                            resource:(NSString *)resource
-                            clientId:(NSString *)clientId
-                         redirectUri:(NSURL *)redirectUri
-                              userId:(NSString *)userId
-                     completionBlock:(ADAuthenticationCallback)completionBlock
+- (ADCancellationHandle *)acquireTokenWithRefreshToken:(NSString *)refreshToken
+                                              resource:(NSString *)resource
+                                              clientId:(NSString *)clientId
+                                           redirectUri:(NSURL *)redirectUri
+                                                userId:(NSString *)userId
+                                       completionBlock:(ADAuthenticationCallback)completionBlock
 {
     API_ENTRY;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
@@ -482,22 +565,70 @@ NSString* ADAL_VERSION_VAR = @ADAL_VERSION_STRING;
     [request setSilent:YES];
     
     [request acquireToken:@"137" completionBlock:completionBlock];
+    
+    return [request cancellationHandle];
 }
 
-#pragma mark - Private
+#pragma mark - Prewarm
 
-#if TARGET_OS_IPHONE
-- (MSIDLegacyTokenCacheAccessor *)createIosCache:(id<MSIDTokenCacheDataSource>)dataSource
+- (void)prewarmWithCompletionBlock:(void (^)(void))completionBlock
 {
-    MSIDOauth2Factory *factory = [MSIDAADV1Oauth2Factory new];
-    MSIDDefaultTokenCacheAccessor *defaultAccessor = [[MSIDDefaultTokenCacheAccessor alloc] initWithDataSource:dataSource otherCacheAccessors:nil factory:factory];
-    MSIDLegacyTokenCacheAccessor *legacyAccessor = [[MSIDLegacyTokenCacheAccessor alloc] initWithDataSource:dataSource otherCacheAccessors:@[defaultAccessor] factory:factory];
-    return legacyAccessor;
+    API_ENTRY;
+    
+    ADRequestParameters *requestParams = [ADRequestParameters new];
+    [requestParams setAuthority:_authority];
+    [requestParams setCorrelationId:_correlationId ? _correlationId : [NSUUID UUID]];
+    [requestParams setTelemetryRequestId:[[MSIDTelemetry sharedInstance] generateRequestId]];
+    [requestParams setLogComponent:_logComponent];
+    // Nobody is waiting on it yet, so it gives way to calls someone is
+    [requestParams setQosClass:QOS_CLASS_UTILITY];
+    
+    MSID_LOG_INFO(requestParams, @"Prewarming authentication context");
+    
+    dispatch_queue_t queue = [ADHelpers globalQueueForQOSClass:QOS_CLASS_UTILITY];
+    dispatch_group_t group = dispatch_group_create();
+    
+#if TARGET_OS_IPHONE
+    dispatch_group_async(group, queue, ^{
+        // Cached for the lifetime of the process once looked up
+        [ADKeychainUtil keychainTeamId:nil];
+    });
+#endif
+    
+    // Validated authorities are cached for the lifetime of the process, ADFS and contexts
+    // not validating authorities get back not validated without an error.
+    dispatch_group_enter(group);
+    [[ADAuthorityValidation sharedInstance] checkAuthority:requestParams
+                                         validateAuthority:_validateAuthority
+                                           completionBlock:^(__unused BOOL validated, ADAuthenticationError *error)
+     {
+         if (error)
+         {
+             MSID_LOG_WARN(requestParams, @"Authority validation failed while prewarming");
+         }
+         
+         dispatch_group_leave(group);
+     }];
+    
+    dispatch_group_notify(group, queue, ^{
+        MSID_LOG_INFO(requestParams, @"Prewarm done");
+        [[MSIDTelemetry sharedInstance] flush:requestParams.telemetryRequestId];
+        
+        if (completionBlock)
+        {
+            completionBlock();
+        }
+    });
 }
-#else
-- (MSIDLegacyTokenCacheAccessor *)createMacCache:(id<MSIDTokenCacheDataSource>)dataSource
+
+#pragma mark - Private
+
+#if TARGET_OS_IPHONE
+- (MSIDLegacyTokenCacheAccessor *)sharedCacheForDataSource:(id<MSIDTokenCacheDataSource>)dataSource
 {
-    return [[MSIDLegacyTokenCacheAccessor alloc] initWithDataSource:dataSource otherCacheAccessors:nil factory:[MSIDAADV1Oauth2Factory new]];
+    // Contexts using the same keychain group share the accessor, as well as whatever it keeps
+    // in memory.
+    return [[ADTokenCacheRegistry sharedRegistry] accessorForDataSource:dataSource];
 }
 #endif
 
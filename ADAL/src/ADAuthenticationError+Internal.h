@@ -102,6 +102,9 @@
  on the authorization UI page. */
 + (ADAuthenticationError*)errorFromCancellation:(NSUUID *)correlationId;
 
+/*! Generates an error for requests cancelled through their ADCancellationHandle */
++ (ADAuthenticationError*)errorFromRequestCancellation:(NSUUID *)correlationId;
+
 /*! Generates an error for the case that server redirects authentication process to a non-https url */
 + (ADAuthenticationError*)errorFromNonHttpsRedirect:(NSUUID *)correlationId;
 
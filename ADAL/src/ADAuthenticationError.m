@@ -35,6 +35,7 @@ NSString* const ADHTTPHeadersKey = @"ADHTTPHeadersKey";
 NSString* const ADInvalidArgumentMessage = @"The argument '%@' is invalid. Value:%@";
 
 NSString* const ADCancelError = @"The user has cancelled the authorization.";
+NSString* const ADRequestCancelError = @"The application has cancelled the request.";
 NSString* const ADNonHttpsRedirectError = @"The server has redirected to a non-https url.";
 
 @implementation ADAuthenticationError
@@ -233,6 +234,14 @@ NSString* const ADNonHttpsRedirectError = @"The server has redirected to a non-h
                                                  correlationId:correlationId];
 }
 
++ (ADAuthenticationError*)errorFromRequestCancellation:(NSUUID *)correlationId
+{
+    return [ADAuthenticationError errorFromAuthenticationError:AD_ERROR_REQUEST_CANCELLED
+                                                  protocolCode:nil
+                                                  errorDetails:ADRequestCancelError
+                                                 correlationId:correlationId];
+}
+
 + (ADAuthenticationError*)errorFromNonHttpsRedirect:(NSUUID *)correlationId
 {
     return [ADAuthenticationError errorFromAuthenticationError:AD_ERROR_SERVER_NON_HTTPS_REDIRECT
@@ -304,6 +313,7 @@ NSString* const ADNonHttpsRedirectError = @"The server has redirected to a non-h
     {
             AD_ERROR_CODE_ENUM_CASE(AD_ERROR_SUCCEEDED);
             AD_ERROR_CODE_ENUM_CASE(AD_ERROR_UNEXPECTED);
+            AD_ERROR_CODE_ENUM_CASE(AD_ERROR_REQUEST_CANCELLED);
             AD_ERROR_CODE_ENUM_CASE(AD_ERROR_DEVELOPER_INVALID_ARGUMENT);
             AD_ERROR_CODE_ENUM_CASE(AD_ERROR_DEVELOPER_AUTHORITY_VALIDATION);
             AD_ERROR_CODE_ENUM_CASE(AD_ERROR_SERVER_USER_INPUT_NEEDED);
@@ -50,4 +50,7 @@ extern NSString* const UnauthorizedHTTStatusExpected;
 + (NSDictionary*) extractChallengeParameters: (NSString*) headerContents
                                        error: (ADAuthenticationError* __autoreleasing*) error;
 
+/*! Drops the challenge parameters cached by parametersFromResourceUrl:completionBlock:. */
++ (void)clearChallengeCache;
+
 @end
@@ -24,6 +24,7 @@
 #import "ADAL_Internal.h"
 #import "ADAuthenticationParameters.h"
 #import "ADAuthenticationParameters+Internal.h"
+#import "ADChallengeHeaderScanner.h"
 
 NSString* const OAuth2_Bearer  = @"Bearer";
 NSString* const OAuth2_Authenticate_Header = @"WWW-Authenticate";
@@ -36,9 +37,6 @@ NSString* const InvalidHeader = @"The authentication header '%@' for the Unautho
 NSString* const ConnectionError = @"Connection error: %@";
 NSString* const InvalidResponse = @"Missing or invalid Url response.";
 NSString* const UnauthorizedHTTStatusExpected = @"Unauthorized (401) HTTP status code is expected, but the actual status code is %d";
-const unichar Quote = '\"';
-// Bearer's parameters extration regex.
-NSString* const ExtractionExpression = @"\\s*([^,\\s=\"]+?)\\s*=\\s*\"([^\"]*?)\"\\s*";
 
 @implementation ADAuthenticationParameters (Internal)
 
@@ -94,178 +92,63 @@ NSString* const ExtractionExpression = @"\\s*([^,\\s=\"]+?)\\s*=\\s*\"([^\"]*?)\
 + (NSDictionary *)extractChallengeParameters:(NSString *)headerContents
                                        error:(ADAuthenticationError * __autoreleasing *)error;
 {
-    NSMutableArray<NSString *> *items = [self extractItems:headerContents];
+    ADChallengeHeaderScanner scanner;
+    ADChallengeHeaderScannerInit(&scanner, headerContents);
+    ADChallengeHeaderElement element;
+    ADChallengeHeaderScanResult result;
+    const char *bearer = OAuth2_Bearer.UTF8String;
     
-    // Find start index of bearer and verify that there is only 1 bearer challendge in the string.
-    NSInteger bearerStartIndex = NSNotFound;
-    for (int i = 0; i < items.count; i++)
-    {
-        NSString *item = items[i];
-        NSRange range = [item rangeOfString:@"\\s*Bearer\\s+([^,\\s=\"]+?)\\s*=\\s*\"([^\"]*?)\"" options:NSRegularExpressionSearch];
-        if (range.location != NSNotFound)
-        {
-            if (bearerStartIndex != NSNotFound)
-            {
-                // Bearer was alredy found, this one is 2nd bearere in the string.
-                // That's not allowed. Reset index and break cycle.
-                bearerStartIndex = NSNotFound;
-                break;
-            }
-            
-            // Remove 'Bearer'.
-            NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:@"\\s*Bearer\\s+" options:NSRegularExpressionCaseInsensitive error:nil];
-            NSString *param = [regex stringByReplacingMatchesInString:item options:0 range:NSMakeRange(0, [item length]) withTemplate:@""];
-            
-            // Save cleared param.
-            items[i] = param;
-            
-            // Save bearer's start index.
-            bearerStartIndex = i;
-        }
-    }
+    NSMutableDictionary *parameters = nil;
+    BOOL inBearerChallenge = NO;
     
-    // Bearer was not found.
-    if (bearerStartIndex == NSNotFound)
+    while ((result = ADChallengeHeaderScanElement(&scanner, &element)) == AD_CHALLENGE_HEADER_ELEMENT)
     {
-        *error = [self invalidHeader:headerContents];
-        return nil;
-    }
-
-    NSMutableDictionary *parameters = [self extractParameters:items[bearerStartIndex]];
-    
-    for (NSInteger i = bearerStartIndex; i < items.count; i++)
-    {
-        NSString *item = items[i];
-        
-        if (![self isParameter:item])
+        if (element.empty)
         {
+            // Comma not followed by a text -- invalid header.
+            result = AD_CHALLENGE_HEADER_MALFORMED;
             break;
         }
         
-        NSMutableDictionary *nextParameters = [self extractParameters:items[i]];
-        [parameters addEntriesFromDictionary:nextParameters];
-    }
-    
-    return parameters;
-}
-
-#pragma mark - Private
-
-+ (NSMutableArray *)extractItems:(NSString *)string
-{
-    NSMutableArray *items = [NSMutableArray new];
-    
-    NSInteger rightIndex = 0;
-    NSInteger leftIndex = 0;
-    while (rightIndex < string.length)
-    {
-        unichar c = [string characterAtIndex:rightIndex];
-        
-        // Start of a quaoted string, lets get last index of it and continue iteration.
-        if (c == '"' || c == '\'')
+        if (element.scheme.location != NSNotFound)
         {
-            rightIndex = [self quotedStringLastIndex:string startIndex:rightIndex];
-            rightIndex++;
-            continue;
-        }
-        
-        if (c == ',')
-        {
-            NSUInteger len = rightIndex - leftIndex;
-            NSRange range = NSMakeRange(leftIndex, len);
-            NSString *item = [string substringWithRange:range];
+            // Start of a new challenge, only a Bearer one with a quoted parameter counts.
+            inBearerChallenge = element.quoted && ADChallengeHeaderRangeEquals(&scanner, element.scheme, bearer);
             
-            [items addObject:item];
+            if (inBearerChallenge && parameters)
+            {
+                // Bearer was already found, this one is 2nd bearer in the string.
+                // That's not allowed.
+                result = AD_CHALLENGE_HEADER_MALFORMED;
+                break;
+            }
             
-            leftIndex = rightIndex + 1;
+            if (inBearerChallenge)
+            {
+                parameters = [NSMutableDictionary new];
+            }
+        }
+        else if (!element.quoted)
+        {
+            // Bearer parameters have to be quoted strings, anything else ends them.
+            inBearerChallenge = NO;
         }
         
-        rightIndex++;
-    }
-    
-    if (leftIndex < rightIndex)
-    {
-        NSUInteger len = rightIndex - leftIndex;
-        NSRange range = NSMakeRange(leftIndex, len);
-        NSString *item = [string substringWithRange:range];
-        
-        [items addObject:item];
-    }
-    
-    // Check for invalid parameters/state.
-    if (leftIndex == rightIndex)
-    {
-        // Comma was not followed by a text -- invalid header.
-        return nil;
-    }
-    
-    for (NSString *item in items) {
-        if ([NSString msidIsStringNilOrBlank:item]) {
-            // Blank item found -- invalid header.
-            return nil;
+        if (inBearerChallenge && element.name.length && element.value.length)
+        {
+            [parameters setObject:ADChallengeHeaderString(&scanner, element.value)
+                           forKey:ADChallengeHeaderString(&scanner, element.name)];
         }
     }
     
-    return items;
-}
-
-+ (NSUInteger)quotedStringLastIndex:(NSString *)headerContents startIndex:(NSUInteger)startIndex
-{
-    NSUInteger lastIndex = startIndex;
-    
-    unichar quotedChar = [headerContents characterAtIndex:startIndex];
-    if (quotedChar == '"' || quotedChar == '\'')
+    // Bearer was not found or the header couldn't be parsed.
+    if (result == AD_CHALLENGE_HEADER_MALFORMED || !parameters)
     {
-        NSUInteger nextIndex = startIndex + 1;
-        while (nextIndex < headerContents.length) {
-            unichar c = [headerContents characterAtIndex:nextIndex];
-            
-            if (c == quotedChar) {
-                lastIndex = nextIndex;
-                break;
-            }
-            
-            nextIndex++;
+        if (error)
+        {
+            *error = [self invalidHeader:headerContents];
         }
-    }
-    
-    return lastIndex;
-}
-
-+ (BOOL)isParameter:(NSString *)string
-{
-    NSRange range = [string rangeOfString:ExtractionExpression options:NSRegularExpressionSearch];
-    return range.location == 0;
-}
-
-+ (NSMutableDictionary *)extractParameters:(NSString *)string
-{
-    NSMutableDictionary* parameters = [NSMutableDictionary new];
-    
-    NSRegularExpression* extractionRegEx = [NSRegularExpression regularExpressionWithPattern:ExtractionExpression
-                                                                                     options:0
-                                                                                       error:nil];
-    if (extractionRegEx)
-    {
-        
-        [extractionRegEx enumerateMatchesInString:string
-                                          options:0
-                                            range:NSMakeRange(0, string.length)
-                                       usingBlock:^(NSTextCheckingResult *result, NSMatchingFlags flags, BOOL *stop)
-         {
-             (void)flags;
-             (void)stop;
-             
-             assert(result.numberOfRanges == 3);
-             
-             NSRange key = [result rangeAtIndex:1];
-             NSRange value = [result rangeAtIndex:2];
-             if (key.length && value.length)
-             {
-                 [parameters setObject:[string substringWithRange:value]
-                                forKey:[string substringWithRange:key]];
-             }
-         }];
+        return nil;
     }
     
     return parameters;
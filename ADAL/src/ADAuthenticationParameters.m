@@ -26,6 +26,16 @@
 #import "ADAuthenticationSettings.h"
 #import "ADWebRequest.h"
 #import "ADWebResponse.h"
+#import "NSURL+MSIDExtensions.h"
+
+static NSString *const s_kParametersKey = @"parameters";
+static NSString *const s_kHeaderKey     = @"header";
+static NSString *const s_kExpiresOnKey  = @"expires_on";
+
+// Parsed challenges keyed by resource scheme, host and port, see resourceChallengeCacheLifetime
+static NSMutableDictionary *s_challengeCache = nil;
+// Completion blocks waiting on the challenge request in flight for a host
+static NSMutableDictionary *s_pendingChallenges = nil;
 
 @implementation ADAuthenticationParameters
 
@@ -76,6 +86,46 @@
         return;
     }
 
+    NSString *cacheKey = [self challengeCacheKeyForURL:resourceUrl];
+    NSTimeInterval lifetime = [[ADAuthenticationSettings sharedInstance] resourceChallengeCacheLifetime];
+    ADAuthenticationParameters *cachedParameters = nil;
+    
+    if (cacheKey)
+    {
+        @synchronized([ADAuthenticationParameters class])
+        {
+            NSDictionary *entry = s_challengeCache[cacheKey];
+            if (lifetime > 0 && [entry[s_kExpiresOnKey] timeIntervalSinceNow] > 0)
+            {
+                cachedParameters = entry[s_kParametersKey];
+            }
+            else
+            {
+                // Callers asking while a challenge request for the host is out share its result
+                NSMutableArray *waiting = s_pendingChallenges[cacheKey];
+                if (waiting)
+                {
+                    MSID_LOG_VERBOSE(nil, @"Joining authorization challenge request in flight.");
+                    [waiting addObject:[completion copy]];
+                    return;
+                }
+                
+                if (!s_pendingChallenges)
+                {
+                    s_pendingChallenges = [NSMutableDictionary new];
+                }
+                s_pendingChallenges[cacheKey] = [NSMutableArray arrayWithObject:[completion copy]];
+            }
+        }
+    }
+    
+    if (cachedParameters)
+    {
+        MSID_LOG_VERBOSE(nil, @"Using cached authorization challenge.");
+        completion(cachedParameters, nil);
+        return;
+    }
+    
     ADWebRequest* request = [[ADWebRequest alloc] initWithURL:resourceUrl context:nil];
     [request setIsGetRequest:YES];
     MSID_LOG_VERBOSE(nil, @"Starting authorization challenge request.");
@@ -103,11 +153,101 @@
             //Request coming, attempt to process it:
             parameters = [self parametersFromResponseHeaders:response.headers error:&adError];
         }
-        completion(parameters, adError);
+        
+        NSArray *completions = @[completion];
+        if (cacheKey)
+        {
+            @synchronized([ADAuthenticationParameters class])
+            {
+                completions = s_pendingChallenges[cacheKey];
+                [s_pendingChallenges removeObjectForKey:cacheKey];
+                
+                [self setCachedParameters:parameters
+                          challengeHeader:[response.headers valueForKey:OAuth2_Authenticate_Header]
+                                   forKey:cacheKey
+                                 lifetime:lifetime];
+            }
+        }
+        
+        for (ADParametersCompletion waitingCompletion in completions)
+        {
+            waitingCompletion(parameters, adError);
+        }
         [request invalidate];
     }];
 }
 
+#pragma mark - Challenge cache
+
++ (NSString *)challengeCacheKeyForURL:(NSURL *)url
+{
+    if (!url.scheme || !url.host)
+    {
+        return nil;
+    }
+    
+    return [[NSString stringWithFormat:@"%@://%@", url.scheme, url.msidHostWithPortIfNecessary] lowercaseString];
+}
+
+// Has to be called while holding the class lock
++ (void)setCachedParameters:(ADAuthenticationParameters *)parameters
+            challengeHeader:(NSString *)challengeHeader
+                     forKey:(NSString *)cacheKey
+                   lifetime:(NSTimeInterval)lifetime
+{
+    if (!parameters || !challengeHeader || lifetime <= 0)
+    {
+        [s_challengeCache removeObjectForKey:cacheKey];
+        return;
+    }
+    
+    if (!s_challengeCache)
+    {
+        s_challengeCache = [NSMutableDictionary new];
+    }
+    
+    s_challengeCache[cacheKey] = @{ s_kParametersKey : parameters,
+                                    s_kHeaderKey : challengeHeader,
+                                    s_kExpiresOnKey : [NSDate dateWithTimeIntervalSinceNow:lifetime] };
+}
+
+// A challenge from the resource that doesn't match the cached one means the resource has moved
+// on, so the cached parameters are replaced before anyone else is handed stale ones.
++ (void)updateChallengeCacheForResponse:(NSHTTPURLResponse *)response
+                             parameters:(ADAuthenticationParameters *)parameters
+{
+    NSString *cacheKey = [self challengeCacheKeyForURL:response.URL];
+    if (!cacheKey)
+    {
+        return;
+    }
+    
+    NSString *challengeHeader = [response.allHeaderFields valueForKey:OAuth2_Authenticate_Header];
+    
+    @synchronized([ADAuthenticationParameters class])
+    {
+        NSDictionary *entry = s_challengeCache[cacheKey];
+        if (!entry || [entry[s_kHeaderKey] isEqualToString:challengeHeader])
+        {
+            return;
+        }
+        
+        MSID_LOG_INFO(nil, @"Authorization challenge changed, updating cached parameters.");
+        [self setCachedParameters:parameters
+                  challengeHeader:challengeHeader
+                           forKey:cacheKey
+                         lifetime:[[ADAuthenticationSettings sharedInstance] resourceChallengeCacheLifetime]];
+    }
+}
+
++ (void)clearChallengeCache
+{
+    @synchronized([ADAuthenticationParameters class])
+    {
+        [s_challengeCache removeAllObjects];
+    }
+}
+
 + (ADAuthenticationParameters*)parametersFromResponseHeaders:(NSDictionary *)headers
                                                        error:(ADAuthenticationError *__autoreleasing *)error
 {
@@ -132,7 +272,10 @@
     API_ENTRY;
     RETURN_NIL_ON_NIL_ARGUMENT(response);
     
-    return [self parametersFromResponseHeaders:response.allHeaderFields error:error];
+    ADAuthenticationParameters *parameters = [self parametersFromResponseHeaders:response.allHeaderFields error:error];
+    [self updateChallengeCacheForResponse:response parameters:parameters];
+    
+    return parameters;
 }
 
 + (ADAuthenticationParameters *)parametersFromResponseAuthenticateHeader:(NSString *)authenticateHeader
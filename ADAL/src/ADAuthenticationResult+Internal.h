@@ -33,6 +33,9 @@
 + (ADAuthenticationResult*)resultFromCancellation;
 + (ADAuthenticationResult*)resultFromCancellation:(NSUUID*)correlationId;
 
+/*! Creates a result for a request the application cancelled through its ADCancellationHandle. */
++ (ADAuthenticationResult*)resultFromRequestCancellation:(NSUUID*)correlationId;
+
 /*! Creates an authentication result from an error condition, with/without correlation id. */
 + (ADAuthenticationResult*)resultFromError:(ADAuthenticationError*)error;
 + (ADAuthenticationResult*)resultFromError:(ADAuthenticationError*)error
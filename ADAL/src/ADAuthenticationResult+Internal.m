@@ -151,6 +151,12 @@ multiResourceRefreshToken: (BOOL) multiResourceRefreshToken
     return result;
 }
 
++ (ADAuthenticationResult*)resultFromRequestCancellation:(NSUUID *)correlationId
+{
+    ADAuthenticationError* error = [ADAuthenticationError errorFromRequestCancellation:correlationId];
+    return [[ADAuthenticationResult alloc] initWithError:error status:AD_USER_CANCELLED correlationId:correlationId];
+}
+
 + (ADAuthenticationResult*)resultForNoBrokerResponse
 {
     NSError* nsError = [NSError errorWithDomain:ADBrokerResponseErrorDomain
@@ -34,6 +34,10 @@
 
 @synthesize requestTimeOut = _requestTimeOut;
 @synthesize expirationBuffer = _expirationBuffer;
+@synthesize maxResponseSize = _maxResponseSize;
+@synthesize requestHedgingDelay = _requestHedgingDelay;
+@synthesize instanceDiscoveryCacheLifetime = _instanceDiscoveryCacheLifetime;
+@synthesize resourceChallengeCacheLifetime = _resourceChallengeCacheLifetime;
 
 /*!
  An internal initializer used from the static creation function.
@@ -46,6 +50,7 @@
         //Initialize the defaults here:
         self.requestTimeOut = 300;//in seconds.
         self.expirationBuffer = 300;//in seconds, ensures catching of clock differences between the server and the device
+        self.maxResponseSize = 1024 * 1024;//in bytes, token and metadata responses are a few KB at most
 #if TARGET_OS_IPHONE
         self.enableFullScreen = YES;
 #endif
@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "ADCancellationHandle.h"
+#import "ADCancellationHandle+Internal.h"
+#import "ADWebRequest.h"
+
+@implementation ADCancellationHandle
+{
+    BOOL _cancelled;
+    NSHashTable<ADWebRequest *> *_webRequests;
+    NSMutableArray<dispatch_block_t> *_cancellationBlocks;
+}
+
+- (id)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _webRequests = [NSHashTable weakObjectsHashTable];
+    _cancellationBlocks = [NSMutableArray new];
+    
+    return self;
+}
+
+- (BOOL)isCancelled
+{
+    @synchronized(self)
+    {
+        return _cancelled;
+    }
+}
+
+- (void)cancel
+{
+    NSArray<ADWebRequest *> *webRequests = nil;
+    NSArray<dispatch_block_t> *cancellationBlocks = nil;
+    
+    @synchronized(self)
+    {
+        if (_cancelled)
+        {
+            return;
+        }
+        
+        _cancelled = YES;
+        webRequests = [_webRequests allObjects];
+        cancellationBlocks = [_cancellationBlocks copy];
+        [_webRequests removeAllObjects];
+        [_cancellationBlocks removeAllObjects];
+    }
+    
+    MSID_LOG_INFO(nil, @"Cancelling request, %lu network requests in flight", (unsigned long)webRequests.count);
+    
+    // Called outside of the lock, cancelling may complete requests synchronously
+    for (ADWebRequest *request in webRequests)
+    {
+        [request cancel];
+    }
+    
+    for (dispatch_block_t block in cancellationBlocks)
+    {
+        block();
+    }
+}
+
+@end
+
+@implementation ADCancellationHandle (Internal)
+
+- (void)addWebRequest:(ADWebRequest *)request
+{
+    @synchronized(self)
+    {
+        if (!_cancelled)
+        {
+            [_webRequests addObject:request];
+            return;
+        }
+    }
+    
+    [request cancel];
+}
+
+- (void)addCancellationBlock:(dispatch_block_t)block
+{
+    @synchronized(self)
+    {
+        if (!_cancelled)
+        {
+            [_cancellationBlocks addObject:[block copy]];
+            return;
+        }
+    }
+    
+    block();
+}
+
+@end
@@ -33,15 +33,19 @@ static NSMutableDictionary* s_adalId = nil;
 
 #pragma mark - Log callback
 
-+ (void)load
++ (void)initialize
 {
-    [self setupLogCallback];
+    // Set up on the first use of ADLogger instead of at image load time, every way of
+    // setting an ADAL log callback goes through this class.
+    if (self == [ADLogger class])
+    {
+        [self setupLogCallback];
+    }
 }
 
 + (void)setupLogCallback
 {
     // Because ADAL theoretically allows changing log callbacks, ADLogger will register its own callback and forward logs
-    // We want the shared callback to be set as early as possible
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
         [[MSIDLogger sharedLogger] setCallback:^(MSIDLogLevel level, NSString *message, BOOL containsPII) {
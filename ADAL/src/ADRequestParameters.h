@@ -26,6 +26,8 @@
 
 @class MSIDConfiguration;
 @class MSIDAccountIdentifier;
+@class ADRequestDeadline;
+@class ADCancellationHandle;
 
 @interface ADRequestParameters : NSObject <MSIDRequestContext>
 {
@@ -48,12 +50,18 @@
 @property (retain, nonatomic) NSString* scopesString;
 @property (retain, nonatomic) ADUserIdentifier* identifier;
 @property BOOL extendedLifetime;
+@property BOOL staleWhileRevalidate;
 @property (retain, nonatomic) NSUUID* correlationId;
 @property (retain, nonatomic) NSString* telemetryRequestId;
 @property (retain, nonatomic) NSString* logComponent;
 @property (retain, nonatomic, readonly) NSString* openidScopesString;
 @property (retain, nonatomic) MSIDAccountIdentifier *account;
 @property (retain, nonatomic, readonly) MSIDConfiguration *msidConfig;
+// Shared by copies, so every request made for the same call draws from the same budget
+@property (retain, nonatomic) ADRequestDeadline *deadline;
+@property (retain, nonatomic) ADCancellationHandle *cancellationHandle;
+// QoS class the call's network work, retries and completions run at, QOS_CLASS_UNSPECIFIED leaves the defaults
+@property qos_class_t qosClass;
 
 - (id)initWithAuthority:(NSString *)authority
                resource:(NSString *)resource
@@ -77,9 +77,15 @@
     parameters->_identifier = [_identifier copyWithZone:zone];
     parameters->_correlationId = [_correlationId copyWithZone:zone];
     parameters->_extendedLifetime = _extendedLifetime;
+    parameters->_staleWhileRevalidate = _staleWhileRevalidate;
     parameters->_telemetryRequestId = [_telemetryRequestId copyWithZone:zone];
     parameters->_logComponent = [_logComponent copyWithZone:zone];
     parameters->_account = [_account copyWithZone:zone];
+    parameters->_cloudAuthority = [_cloudAuthority copyWithZone:zone];
+    parameters->_scopesString = [_scopesString copyWithZone:zone];
+    parameters->_deadline = _deadline;
+    parameters->_cancellationHandle = _cancellationHandle;
+    parameters->_qosClass = _qosClass;
     
     return parameters;
 }
@@ -28,6 +28,12 @@
 + (BOOL)canUseBroker;
 
 #if TARGET_OS_IPHONE
+/*!
+    Hooks the application delegate's openURL methods so broker responses get handled by ADAL.
+    Called once the application has finished launching, safe to call more than once.
+ */
++ (void)setupAppDelegateInterception;
+
 + (void)invokeBroker:(NSURL *)brokerURL
    completionHandler:(ADAuthenticationCallback)completion;
 + (void)promptBrokerInstall:(NSURL *)redirectURL
@@ -104,12 +104,15 @@ BOOL __swizzle_ApplicationOpenURLiOS9(id self, SEL _cmd, UIApplication* applicat
 #if !AD_BROKER
 + (void)load
 {
+    // The only thing ADAL still does at load time. An app killed while the user was in the broker
+    // gets relaunched with the response in application:openURL:, possibly before it touches ADAL
+    // at all, so the hook has to be in place by the time the app has finished launching.
     if ([ADAppExtensionUtil isExecutingInAppExtension])
     {
         // Avoid any setup in application extension hosts
         return;
     }
-
+    
     __block __weak id observer = nil;
     
     observer =
@@ -119,70 +122,124 @@ BOOL __swizzle_ApplicationOpenURLiOS9(id self, SEL _cmd, UIApplication* applicat
                                                   usingBlock:^(NSNotification* notification)
      {
          (void)notification;
-         // We don't want to swizzle multiple times so remove the observer
          [[NSNotificationCenter defaultCenter] removeObserver:observer name:UIApplicationDidFinishLaunchingNotification object:nil];
          
-         SEL sel = @selector(application:openURL:sourceApplication:annotation:);
-         SEL seliOS9 = @selector(application:openURL:options:);
-         SEL handleOpenURLSel = @selector(application:handleOpenURL:);
-         
-         // Dig out the app delegate (if there is one)
-         __strong id appDelegate = [[ADAppExtensionUtil sharedApplication] delegate];
-         
-         // There's not much we can do if there's no app delegate and there might be scenarios where
-         // that is valid...
-         if (appDelegate == nil)
-             return;
-         
-         // Support applications which implement handleOpenURL to handle URL requests.
-         // An openURL method will be added to the application's delegate, but the request will be
-         // forwarded to the application's handleOpenURL: method once handled by ADAL.
-         if ([appDelegate respondsToSelector:handleOpenURLSel])
-         {
-             Method m = class_getInstanceMethod([appDelegate class], handleOpenURLSel);
-             __original_ApplicationHandleOpenURL = method_getImplementation(m);
-         }
-         
-         BOOL iOS9OrGreater = [[[UIDevice currentDevice] systemVersion] intValue] >= 9;
-         
-         if ([appDelegate respondsToSelector:seliOS9] && iOS9OrGreater)
-         {
-             Method m = class_getInstanceMethod([appDelegate class], seliOS9);
-             __original_ApplicationOpenURLiOS9 = method_getImplementation(m);
-             method_setImplementation(m, (IMP)__swizzle_ApplicationOpenURLiOS9);
-         }
-         else if ([appDelegate respondsToSelector:sel])
-         {
-             Method m = class_getInstanceMethod([appDelegate class], sel);
-             __original_ApplicationOpenURL = method_getImplementation(m);
-             method_setImplementation(m, (IMP)__swizzle_ApplicationOpenURL);
-         }
-         else if (iOS9OrGreater)
-         {
-             NSString* typeEncoding = [NSString stringWithFormat:@"%s%s%s%s%s%s", @encode(BOOL), @encode(id), @encode(SEL), @encode(UIApplication*), @encode(NSURL*), @encode(NSDictionary<NSString*, id>*)];
-             class_addMethod([appDelegate class], seliOS9, (IMP)__swizzle_ApplicationOpenURLiOS9, [typeEncoding UTF8String]);
-             
-             // UIApplication caches whether or not the delegate responds to certain selectors. Clearing out the delegate and resetting it gaurantees that gets updated
-             [[ADAppExtensionUtil sharedApplication] setDelegate:nil];
-             // UIApplication employs dark magic to assume ownership of the app delegate when it gets the app delegate at launch, it won't do that for setDelegate calls so we
-             // have to add a retain here to make sure it doesn't turn into a zombie
-             [[ADAppExtensionUtil sharedApplication] setDelegate:(__bridge id)CFRetain((__bridge CFTypeRef)appDelegate)];
-         }
-         else
-         {
-             NSString* typeEncoding = [NSString stringWithFormat:@"%s%s%s%s%s%s%s", @encode(BOOL), @encode(id), @encode(SEL), @encode(UIApplication*), @encode(NSURL*), @encode(NSString*), @encode(id)];
-             class_addMethod([appDelegate class], sel, (IMP)__swizzle_ApplicationOpenURL, [typeEncoding UTF8String]);
-             
-             // UIApplication caches whether or not the delegate responds to certain selectors. Clearing out the delegate and resetting it gaurantees that gets updated
-             [[ADAppExtensionUtil sharedApplication] setDelegate:nil];
-             // UIApplication employs dark magic to assume ownership of the app delegate when it gets the app delegate at launch, it won't do that for setDelegate calls so we
-             // have to add a retain here to make sure it doesn't turn into a zombie
-             [[ADAppExtensionUtil sharedApplication] setDelegate:(__bridge id)CFRetain((__bridge CFTypeRef)appDelegate)];
-         }
+         [ADBrokerHelper setupAppDelegateInterception];
      }];
 }
 #endif
 
++ (void)setupAppDelegateInterception
+{
+    // If we are in the broker, do not intercept openURL calls
+#if !AD_BROKER
+    if ([ADAppExtensionUtil isExecutingInAppExtension])
+    {
+        // Avoid any setup in application extension hosts
+        return;
+    }
+    
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        void (^setupBlock)(void) = ^{
+            // If the application already has its delegate there is no need to wait for it
+            if ([[ADAppExtensionUtil sharedApplication] delegate])
+            {
+                [ADBrokerHelper swizzleAppDelegate];
+                return;
+            }
+            
+            __block __weak id observer = nil;
+            
+            observer =
+            [[NSNotificationCenter defaultCenter] addObserverForName:UIApplicationDidFinishLaunchingNotification
+                                                              object:nil
+                                                               queue:nil
+                                                          usingBlock:^(NSNotification* notification)
+             {
+                 (void)notification;
+                 // We don't want to swizzle multiple times so remove the observer
+                 [[NSNotificationCenter defaultCenter] removeObserver:observer name:UIApplicationDidFinishLaunchingNotification object:nil];
+                 
+                 [ADBrokerHelper swizzleAppDelegate];
+             }];
+        };
+        
+        if ([NSThread isMainThread])
+        {
+            setupBlock();
+        }
+        else
+        {
+            dispatch_async(dispatch_get_main_queue(), setupBlock);
+        }
+    });
+#endif
+}
+
+#if !AD_BROKER
++ (void)swizzleAppDelegate
+{
+    SEL sel = @selector(application:openURL:sourceApplication:annotation:);
+    SEL seliOS9 = @selector(application:openURL:options:);
+    SEL handleOpenURLSel = @selector(application:handleOpenURL:);
+    
+    // Dig out the app delegate (if there is one)
+    __strong id appDelegate = [[ADAppExtensionUtil sharedApplication] delegate];
+    
+    // There's not much we can do if there's no app delegate and there might be scenarios where
+    // that is valid...
+    if (appDelegate == nil)
+        return;
+    
+    // Support applications which implement handleOpenURL to handle URL requests.
+    // An openURL method will be added to the application's delegate, but the request will be
+    // forwarded to the application's handleOpenURL: method once handled by ADAL.
+    if ([appDelegate respondsToSelector:handleOpenURLSel])
+    {
+        Method m = class_getInstanceMethod([appDelegate class], handleOpenURLSel);
+        __original_ApplicationHandleOpenURL = method_getImplementation(m);
+    }
+    
+    BOOL iOS9OrGreater = [[[UIDevice currentDevice] systemVersion] intValue] >= 9;
+    
+    if ([appDelegate respondsToSelector:seliOS9] && iOS9OrGreater)
+    {
+        Method m = class_getInstanceMethod([appDelegate class], seliOS9);
+        __original_ApplicationOpenURLiOS9 = method_getImplementation(m);
+        method_setImplementation(m, (IMP)__swizzle_ApplicationOpenURLiOS9);
+    }
+    else if ([appDelegate respondsToSelector:sel])
+    {
+        Method m = class_getInstanceMethod([appDelegate class], sel);
+        __original_ApplicationOpenURL = method_getImplementation(m);
+        method_setImplementation(m, (IMP)__swizzle_ApplicationOpenURL);
+    }
+    else if (iOS9OrGreater)
+    {
+        NSString* typeEncoding = [NSString stringWithFormat:@"%s%s%s%s%s%s", @encode(BOOL), @encode(id), @encode(SEL), @encode(UIApplication*), @encode(NSURL*), @encode(NSDictionary<NSString*, id>*)];
+        class_addMethod([appDelegate class], seliOS9, (IMP)__swizzle_ApplicationOpenURLiOS9, [typeEncoding UTF8String]);
+        
+        // UIApplication caches whether or not the delegate responds to certain selectors. Clearing out the delegate and resetting it gaurantees that gets updated
+        [[ADAppExtensionUtil sharedApplication] setDelegate:nil];
+        // UIApplication employs dark magic to assume ownership of the app delegate when it gets the app delegate at launch, it won't do that for setDelegate calls so we
+        // have to add a retain here to make sure it doesn't turn into a zombie
+        [[ADAppExtensionUtil sharedApplication] setDelegate:(__bridge id)CFRetain((__bridge CFTypeRef)appDelegate)];
+    }
+    else
+    {
+        NSString* typeEncoding = [NSString stringWithFormat:@"%s%s%s%s%s%s%s", @encode(BOOL), @encode(id), @encode(SEL), @encode(UIApplication*), @encode(NSURL*), @encode(NSString*), @encode(id)];
+        class_addMethod([appDelegate class], sel, (IMP)__swizzle_ApplicationOpenURL, [typeEncoding UTF8String]);
+        
+        // UIApplication caches whether or not the delegate responds to certain selectors. Clearing out the delegate and resetting it gaurantees that gets updated
+        [[ADAppExtensionUtil sharedApplication] setDelegate:nil];
+        // UIApplication employs dark magic to assume ownership of the app delegate when it gets the app delegate at launch, it won't do that for setDelegate calls so we
+        // have to add a retain here to make sure it doesn't turn into a zombie
+        [[ADAppExtensionUtil sharedApplication] setDelegate:(__bridge id)CFRetain((__bridge CFTypeRef)appDelegate)];
+    }
+}
+#endif
+
 + (BOOL)canUseBroker
 {
     if (![NSThread isMainThread])
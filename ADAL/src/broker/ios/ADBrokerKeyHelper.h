@@ -46,6 +46,17 @@
                             size:(size_t)size
                            error:(ADAuthenticationError *__autoreleasing *)error;
 
+/*!
+    Decrypts the broker response and checks it against the hex encoded SHA-256 hash the
+    broker sent along with it. The hash is computed over the decrypted bytes as they get
+    decrypted and compared as raw digests. Fails with AD_ERROR_TOKENBROKER_RESPONSE_HASH_MISMATCH
+    if the hash doesn't match.
+ */
+- (NSData*)decryptBrokerResponse:(NSData*)response
+                         version:(NSInteger)version
+                            hash:(NSString*)hash
+                           error:(ADAuthenticationError* __autoreleasing*)error;
+
 // NOTE: Used for testing purposes only. Does not change keychain entries.
 + (void)setSymmetricKey:(NSString *)base64Key;
 + (NSData *)symmetricKey;
@@ -27,9 +27,18 @@
 #import "ADErrorCodes.h"
 #import "ADBrokerKeyHelper.h"
 #import <CommonCrypto/CommonCryptor.h>
+#import <CommonCrypto/CommonDigest.h>
 #import <Security/Security.h>
 
 static NSData* s_symmetricKeyOverride = nil;
+// The broker key as last read from or written to the keychain, so that it only gets looked
+// up once per process. It is never persisted anywhere else and is dropped when the key is
+// deleted.
+static NSData* s_cachedSymmetricKey = nil;
+
+// Size of the chunks the broker response gets decrypted and hashed in, small enough for
+// the decrypted bytes to still be in cache when they get hashed.
+#define AD_BROKER_DECRYPT_CHUNK_SIZE 4096
 
 @implementation ADBrokerKeyHelper
 
@@ -41,6 +50,49 @@ enum {
 
 static const uint8_t symmetricKeyIdentifier[]   = kSymmetricKeyTag;
 
+static inline int ADHexValue(unichar c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Decodes the hex encoded SHA-256 hash sent by the broker, returns NO if it isn't one.
+static BOOL ADDigestFromHexString(NSString *hex, uint8_t digest[CC_SHA256_DIGEST_LENGTH])
+{
+    if (hex.length != CC_SHA256_DIGEST_LENGTH * 2)
+    {
+        return NO;
+    }
+    
+    unichar chars[CC_SHA256_DIGEST_LENGTH * 2];
+    [hex getCharacters:chars range:NSMakeRange(0, CC_SHA256_DIGEST_LENGTH * 2)];
+    for (NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++)
+    {
+        int high = ADHexValue(chars[i * 2]);
+        int low = ADHexValue(chars[i * 2 + 1]);
+        if (high < 0 || low < 0)
+        {
+            return NO;
+        }
+        digest[i] = (uint8_t)((high << 4) | low);
+    }
+    
+    return YES;
+}
+
+// Compares the digests in constant time
+static BOOL ADDigestsEqual(const uint8_t *a, const uint8_t *b)
+{
+    uint8_t difference = 0;
+    for (NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++)
+    {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
+
 #define UNEXPECTED_KEY_ERROR { \
     if (error) { \
         *error = [ADAuthenticationError errorFromNSError:[NSError errorWithDomain:@"ADAL" code:AD_ERROR_TOKENBROKER_FAILED_TO_CREATE_KEY userInfo:nil] errorDetails:@"Could not create broker key." correlationId:nil]; \
@@ -146,6 +198,10 @@ static const uint8_t symmetricKeyIdentifier[]   = kSymmetricKeyTag;
     }
     
     _symmetricKey = nil;
+    @synchronized ([ADBrokerKeyHelper class])
+    {
+        s_cachedSymmetricKey = nil;
+    }
     return YES;
 }
 
@@ -170,6 +226,15 @@ static const uint8_t symmetricKeyIdentifier[]   = kSymmetricKeyTag;
         return s_symmetricKeyOverride;
     }
     
+    @synchronized ([ADBrokerKeyHelper class])
+    {
+        if (s_cachedSymmetricKey)
+        {
+            _symmetricKey = s_cachedSymmetricKey;
+            return _symmetricKey;
+        }
+    }
+    
     NSDictionary* symmetricKeyQuery =
     @{
       (id)kSecClass : (id)kSecClassKey,
@@ -200,6 +265,14 @@ static const uint8_t symmetricKeyIdentifier[]   = kSymmetricKeyTag;
 - (NSData*)decryptBrokerResponse:(NSData*)response
                          version:(NSInteger)version
                           error:(ADAuthenticationError* __autoreleasing*)error
+{
+    return [self decryptBrokerResponse:response version:version hash:nil error:error];
+}
+
+- (NSData*)decryptBrokerResponse:(NSData*)response
+                         version:(NSInteger)version
+                            hash:(NSString*)hash
+                           error:(ADAuthenticationError* __autoreleasing*)error
 {
     NSData* keyData = [self getBrokerKey:error];
     const void* keyBytes = nil;
@@ -223,7 +296,10 @@ static const uint8_t symmetricKeyIdentifier[]   = kSymmetricKeyTag;
         keySize = kCCKeySizeAES256;
     }
     
-    return [self decryptBrokerResponse:response key:keyBytes size:keySize error:error];
+    NSData* decrypted = [self decryptBrokerResponse:response key:keyBytes size:keySize hash:hash error:error];
+    // keyPtr isn't read again, memset_s keeps the compiler from dropping the wipe
+    memset_s(keyPtr, sizeof(keyPtr), 0, sizeof(keyPtr));
+    return decrypted;
 }
 
 - (NSData*)decryptBrokerResponse:(NSData *)response
@@ -231,27 +307,97 @@ static const uint8_t symmetricKeyIdentifier[]   = kSymmetricKeyTag;
                             size:(size_t)size
                            error:(ADAuthenticationError *__autoreleasing *)error
 {
+    return [self decryptBrokerResponse:response key:key size:size hash:nil error:error];
+}
+
+- (NSData*)decryptBrokerResponse:(NSData *)response
+                             key:(const void*)key
+                            size:(size_t)size
+                            hash:(NSString *)hash
+                           error:(ADAuthenticationError *__autoreleasing *)error
+{
+    uint8_t expectedDigest[CC_SHA256_DIGEST_LENGTH];
+    if (hash && !ADDigestFromHexString(hash, expectedDigest))
+    {
+        ADAuthenticationError* adError = [ADAuthenticationError errorFromAuthenticationError:AD_ERROR_TOKENBROKER_RESPONSE_HASH_MISMATCH
+                                                                                protocolCode:nil
+                                                                                errorDetails:@"Decrypted response does not match the hash"
+                                                                               correlationId:nil];
+        if (error)
+        {
+            *error = adError;
+        }
+        return nil;
+    }
+    
     NSUInteger dataLength = [response length];
     
     //See the doc: For block ciphers, the output size will always be less than or
     //equal to the input size plus the size of one block.
     //That's why we need to add the size of one block here
     size_t bufferSize = dataLength + kCCBlockSizeAES128;
-    void *buffer = malloc(bufferSize);
+    uint8_t *buffer = malloc(bufferSize);
     
     if(!buffer)
     {
         return nil;
     }
-
     
+    CCCryptorRef cryptor = NULL;
+    CCCryptorStatus cryptStatus = CCCryptorCreate(kCCDecrypt, kCCAlgorithmAES128, kCCOptionPKCS7Padding,
+                                                  key, size,
+                                                  NULL /* initialization vector (optional) */,
+                                                  &cryptor);
+    
+    // Decrypt in chunks and hash each chunk right after it gets decrypted, so the
+    // response only has to be walked once.
+    CC_SHA256_CTX sha;
+    CC_SHA256_Init(&sha);
+    
+    const uint8_t *input = [response bytes];
     size_t numBytesDecrypted = 0;
-    CCCryptorStatus cryptStatus = CCCrypt(kCCDecrypt, kCCAlgorithmAES128, kCCOptionPKCS7Padding,
-                                          key, size,
-                                          NULL /* initialization vector (optional) */,
-                                          [response bytes], dataLength, /* input */
-                                          buffer, bufferSize, /* output */
-                                          &numBytesDecrypted);
+    for (NSUInteger offset = 0; cryptStatus == kCCSuccess && offset < dataLength; offset += AD_BROKER_DECRYPT_CHUNK_SIZE)
+    {
+        size_t chunkLength = MIN((size_t)AD_BROKER_DECRYPT_CHUNK_SIZE, (size_t)(dataLength - offset));
+        size_t moved = 0;
+        cryptStatus = CCCryptorUpdate(cryptor, input + offset, chunkLength,
+                                      buffer + numBytesDecrypted, bufferSize - numBytesDecrypted,
+                                      &moved);
+        CC_SHA256_Update(&sha, buffer + numBytesDecrypted, (CC_LONG)moved);
+        numBytesDecrypted += moved;
+    }
+    
+    if (cryptStatus == kCCSuccess)
+    {
+        size_t moved = 0;
+        cryptStatus = CCCryptorFinal(cryptor, buffer + numBytesDecrypted, bufferSize - numBytesDecrypted, &moved);
+        CC_SHA256_Update(&sha, buffer + numBytesDecrypted, (CC_LONG)moved);
+        numBytesDecrypted += moved;
+    }
+    
+    if (cryptor)
+    {
+        CCCryptorRelease(cryptor);
+    }
+    
+    uint8_t actualDigest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(actualDigest, &sha);
+    
+    if (cryptStatus == kCCSuccess && hash && !ADDigestsEqual(expectedDigest, actualDigest))
+    {
+        memset_s(buffer, bufferSize, 0, bufferSize);
+        free(buffer);
+        
+        ADAuthenticationError* adError = [ADAuthenticationError errorFromAuthenticationError:AD_ERROR_TOKENBROKER_RESPONSE_HASH_MISMATCH
+                                                                                protocolCode:nil
+                                                                                errorDetails:@"Decrypted response does not match the hash"
+                                                                               correlationId:nil];
+        if (error)
+        {
+            *error = adError;
+        }
+        return nil;
+    }
     
     if (cryptStatus == kCCSuccess) {
         //the returned NSData takes ownership of the buffer and will free it on deallocation
@@ -274,6 +420,10 @@ static const uint8_t symmetricKeyIdentifier[]   = kSymmetricKeyTag;
 - (void)setSymmetricKey:(NSData *)symmetricKey
 {
     _symmetricKey = symmetricKey;
+    @synchronized ([ADBrokerKeyHelper class])
+    {
+        s_cachedSymmetricKey = symmetricKey;
+    }
 }
 
 + (NSData *)symmetricKey
@@ -27,6 +27,8 @@
 #import "ADAuthenticationErrorConverter.h"
 #import "MSIDLegacyTokenCacheKey.h"
 #import "ADTokenCacheItem+MSIDTokens.h"
+#import "ADTokenCacheItem+Internal.h"
+#import "ADTokenCacheItemArray.h"
 #import "ADTokenCacheKey.h"
 #import "ADTokenCacheDataSource.h"
 #import "ADMSIDContext.h"
@@ -58,6 +60,9 @@
     
     if (self)
     {
+        // Items archived by ADAL 1.x can only be read back once the class name mappings are set
+        [ADTokenCacheItem setupArchiverClassNames];
+        
         self.dataSource = dataSource;
         self.seriazer = serializer;
 
@@ -94,8 +99,8 @@
 }
 
 /*! Return a copy of all items. The array will contain ADTokenCacheItem objects,
- containing all of the cached information. Returns an empty array, if no items are found.
- Returns nil in case of error. */
+ containing all of the cached information. Items are materialized lazily on access.
+ Returns an empty array, if no items are found. Returns nil in case of error. */
 - (NSArray<ADTokenCacheItem *> *)allItems:(ADAuthenticationError * __autoreleasing *)error
 {
     MSIDLegacyTokenCacheQuery *query = [MSIDLegacyTokenCacheQuery new];
@@ -118,19 +123,7 @@
         return nil;
     }
     
-    NSMutableArray<ADTokenCacheItem *> *results = [NSMutableArray array];
-    
-    for (MSIDLegacyTokenCacheItem *cacheItem in allItems)
-    {
-        ADTokenCacheItem *item = [[ADTokenCacheItem alloc] initWithMSIDLegacyTokenCacheItem:cacheItem];
-        
-        if (item)
-        {
-            [results addObject:item];
-        }
-    }
-    
-    return results;
+    return [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:allItems];
 }
 
 - (BOOL)addOrUpdateItem:(ADTokenCacheItem *)item
@@ -220,19 +213,7 @@
         return nil;
     }
     
-    NSMutableArray<ADTokenCacheItem *> *results = [NSMutableArray array];
-    
-    for (MSIDLegacyTokenCacheItem *cacheItem in cacheItems)
-    {
-        ADTokenCacheItem *item = [[ADTokenCacheItem alloc] initWithMSIDLegacyTokenCacheItem:cacheItem];
-        
-        if (item)
-        {
-            [results addObject:item];
-        }
-    }
-    
-    return results;
+    return [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:cacheItems];
 }
 
 - (BOOL)removeAllForClientId:(NSString *)clientId
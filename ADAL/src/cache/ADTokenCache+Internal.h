@@ -25,9 +25,12 @@
 #import "MSIDMacTokenCache.h"
 #import "ADTokenCacheDataSource.h"
 
+@class ADMSIDDataSourceWrapper;
+
 @interface ADTokenCache (Internal) <MSIDMacTokenCacheDelegate, ADTokenCacheDataSource>
 
 @property (nonatomic, nullable, readonly) MSIDMacTokenCache *macTokenCache;
+@property (nonatomic, nullable, readonly) ADMSIDDataSourceWrapper *msidDataSourceWrapper;
 
 - (nullable id<ADTokenCacheDelegate>)delegate;
 
@@ -48,6 +48,12 @@
  */
 @property (readonly) NSString *speInfo;
 
+/*!
+    Sets up the NSKeyedArchiver class name mappings for items archived by ADAL 1.x. This is
+    done lazily on first use of the class, call it before unarchiving cache data directly.
+ */
++ (void)setupArchiverClassNames;
+
 - (void)logMessage:(NSString *)message
              level:(MSIDLogLevel)level
      correlationId:(NSUUID*)correlationId;
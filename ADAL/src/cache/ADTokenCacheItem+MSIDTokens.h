@@ -29,6 +29,7 @@
 @class MSIDLegacySingleResourceToken;
 @class MSIDLegacyTokenCacheKey;
 @class MSIDLegacyTokenCacheItem;
+@class MSIDBaseToken;
 
 @interface ADTokenCacheItem (MSIDTokens)
 
@@ -37,6 +38,7 @@
 - (instancetype)initWithLegacyRefreshToken:(MSIDLegacyRefreshToken *)refreshToken;
 - (instancetype)initWithLegacySingleResourceToken:(MSIDLegacySingleResourceToken *)legacySingleResourceToken;
 - (instancetype)initWithMSIDLegacyTokenCacheItem:(MSIDLegacyTokenCacheItem *)cacheItem;
+- (instancetype)initWithMSIDBaseToken:(MSIDBaseToken *)token;
 
 - (MSIDLegacyTokenCacheKey *)tokenCacheKey;
 - (MSIDLegacyTokenCacheItem *)tokenCacheItem;
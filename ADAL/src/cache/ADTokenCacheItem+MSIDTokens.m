@@ -91,8 +91,11 @@
 
 - (instancetype)initWithMSIDLegacyTokenCacheItem:(MSIDLegacyTokenCacheItem *)cacheItem
 {
-    MSIDBaseToken *token = [cacheItem tokenWithType:cacheItem.credentialType];
-    
+    return [self initWithMSIDBaseToken:[cacheItem tokenWithType:cacheItem.credentialType]];
+}
+
+- (instancetype)initWithMSIDBaseToken:(MSIDBaseToken *)token
+{
     switch (token.credentialType) {
         case MSIDAccessTokenType:
             return [self initWithLegacyAccessToken:(MSIDLegacyAccessToken *)token];
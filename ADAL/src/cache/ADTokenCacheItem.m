@@ -38,12 +38,23 @@
 @synthesize familyId = _familyId;
 @synthesize storageAuthority = _storageAuthority;
 
-+ (void)load
++ (void)initialize
+{
+    if (self == [ADTokenCacheItem class])
+    {
+        [self setupArchiverClassNames];
+    }
+}
+
++ (void)setupArchiverClassNames
 {
     // This class was named "ADTokenCacheStoreItem" in ADAL 1.x, to maintain backwards compatibility
     // we set class name mappings for this class.
-    [NSKeyedArchiver setClassName:@"ADTokenCacheStoreItem" forClass:self];
-    [NSKeyedUnarchiver setClass:self forClassName:@"ADTokenCacheStoreItem"];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        [NSKeyedArchiver setClassName:@"ADTokenCacheStoreItem" forClass:[ADTokenCacheItem class]];
+        [NSKeyedUnarchiver setClass:[ADTokenCacheItem class] forClassName:@"ADTokenCacheStoreItem"];
+    });
 }
 
 - (NSUInteger)hash
@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "ADTokenCacheItemArray.h"
+#import "ADTokenCacheItem+MSIDTokens.h"
+#import "MSIDLegacyTokenCacheItem.h"
+#import "MSIDBaseToken.h"
+
+@interface ADTokenCacheItemArray ()
+{
+    NSArray<MSIDBaseToken *> *_tokens;
+    NSPointerArray *_materializedItems;
+}
+
+- (instancetype)initWithTokens:(NSArray<MSIDBaseToken *> *)tokens;
+
+@end
+
+@implementation ADTokenCacheItemArray
+
+#pragma mark - Init
+
+- (instancetype)init
+{
+    return [self initWithTokens:@[]];
+}
+
+- (instancetype)initWithMSIDLegacyTokenCacheItems:(NSArray *)cacheItems
+{
+    NSMutableArray<MSIDBaseToken *> *tokens = [NSMutableArray arrayWithCapacity:cacheItems.count];
+    
+    for (MSIDLegacyTokenCacheItem *cacheItem in cacheItems)
+    {
+        // Only keep tokens ADTokenCacheItem knows how to represent, so that count is exact
+        // without having to materialize anything.
+        MSIDBaseToken *token = [cacheItem tokenWithType:cacheItem.credentialType];
+        
+        switch (token.credentialType)
+        {
+            case MSIDAccessTokenType:
+            case MSIDRefreshTokenType:
+            case MSIDLegacySingleResourceTokenType:
+                [tokens addObject:token];
+                break;
+                
+            default:
+                break;
+        }
+    }
+    
+    return [self initWithTokens:tokens];
+}
+
+- (instancetype)initWithTokens:(NSArray<MSIDBaseToken *> *)tokens
+{
+    self = [super init];
+    
+    if (self)
+    {
+        _tokens = tokens;
+        _materializedItems = [NSPointerArray strongObjectsPointerArray];
+        _materializedItems.count = tokens.count;
+    }
+    
+    return self;
+}
+
+#pragma mark - NSArray
+
+- (NSUInteger)count
+{
+    return _tokens.count;
+}
+
+- (ADTokenCacheItem *)objectAtIndex:(NSUInteger)index
+{
+    if (index >= _tokens.count)
+    {
+        @throw [NSException exceptionWithName:NSRangeException
+                                       reason:[NSString stringWithFormat:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)_tokens.count]
+                                     userInfo:nil];
+    }
+    
+    @synchronized (self)
+    {
+        ADTokenCacheItem *item = (__bridge ADTokenCacheItem *)[_materializedItems pointerAtIndex:index];
+        
+        if (!item)
+        {
+            item = [[ADTokenCacheItem alloc] initWithMSIDBaseToken:_tokens[index]];
+            [_materializedItems replacePointerAtIndex:index withPointer:(__bridge void *)item];
+        }
+        
+        return item;
+    }
+}
+
+- (id)copyWithZone:(__unused NSZone *)zone
+{
+    // Immutable, and materialized items are shared
+    return self;
+}
+
+@end
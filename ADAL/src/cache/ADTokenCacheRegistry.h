@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+@protocol MSIDTokenCacheDataSource;
+@class MSIDLegacyTokenCacheAccessor;
+@class ADMSIDDataSourceWrapper;
+@class MSIDKeychainTokenCache;
+
+/*!
+    Hands out one token cache data source per keychain group, and one accessor and wrapper
+    per data source, so that every context and cache object using the same token cache
+    shares them instead of building its own. Accessors and wrappers are only kept for data
+    sources that live until the process exits; caches owned by a single object get their
+    own accessor through +createAccessorForDataSource:.
+    The class is thread-safe.
+ */
+@interface ADTokenCacheRegistry : NSObject
+{
+    NSMutableDictionary *_keychainCaches;
+    NSMapTable *_accessors;
+    NSMapTable *_wrappers;
+}
+
++ (ADTokenCacheRegistry *)sharedRegistry;
+
+#if TARGET_OS_IPHONE
+/*! Returns the keychain token cache for the group, nil meaning the default keychain group. */
+- (MSIDKeychainTokenCache *)keychainCacheForGroup:(NSString *)group;
+#endif
+
+/*! Returns the accessor for a data source, created on first use and shared from then on. */
+- (MSIDLegacyTokenCacheAccessor *)accessorForDataSource:(id<MSIDTokenCacheDataSource>)dataSource;
+
+/*! Returns the ADTokenCacheDataSource wrapper for a data source, created on first use and shared from then on. */
+- (ADMSIDDataSourceWrapper *)wrapperForDataSource:(id<MSIDTokenCacheDataSource>)dataSource;
+
+/*! Creates an accessor for a data source without keeping it. */
++ (MSIDLegacyTokenCacheAccessor *)createAccessorForDataSource:(id<MSIDTokenCacheDataSource>)dataSource;
+
+@end
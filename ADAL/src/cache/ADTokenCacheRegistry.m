@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "ADTokenCacheRegistry.h"
+#import "ADMSIDDataSourceWrapper.h"
+#import "MSIDKeyedArchiverSerializer.h"
+#import "MSIDLegacyTokenCacheAccessor.h"
+#import "MSIDDefaultTokenCacheAccessor.h"
+#import "MSIDAADV1Oauth2Factory.h"
+#import "MSIDKeychainTokenCache.h"
+
+@implementation ADTokenCacheRegistry
+
++ (ADTokenCacheRegistry *)sharedRegistry
+{
+    static ADTokenCacheRegistry *s_sharedRegistry = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        s_sharedRegistry = [ADTokenCacheRegistry new];
+    });
+    
+    return s_sharedRegistry;
+}
+
+- (id)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _keychainCaches = [NSMutableDictionary new];
+    
+    // Data sources don't have to implement isEqual:/hash, so go by identity
+    NSPointerFunctionsOptions keyOptions = NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality;
+    _accessors = [[NSMapTable alloc] initWithKeyOptions:keyOptions valueOptions:NSPointerFunctionsStrongMemory capacity:0];
+    _wrappers = [[NSMapTable alloc] initWithKeyOptions:keyOptions valueOptions:NSPointerFunctionsStrongMemory capacity:0];
+    
+    return self;
+}
+
+#if TARGET_OS_IPHONE
+- (MSIDKeychainTokenCache *)keychainCacheForGroup:(NSString *)group
+{
+    NSString *defaultGroup = MSIDKeychainTokenCache.defaultKeychainGroup;
+    
+    // The default group can be changed by the app, so look it up every time
+    if (!group || [group isEqualToString:defaultGroup])
+    {
+        return MSIDKeychainTokenCache.defaultKeychainCache;
+    }
+    
+    @synchronized(self)
+    {
+        MSIDKeychainTokenCache *keychainCache = _keychainCaches[group];
+        
+        if (!keychainCache)
+        {
+            keychainCache = [[MSIDKeychainTokenCache alloc] initWithGroup:group];
+            _keychainCaches[group] = keychainCache;
+        }
+        
+        return keychainCache;
+    }
+}
+#endif
+
+- (MSIDLegacyTokenCacheAccessor *)accessorForDataSource:(id<MSIDTokenCacheDataSource>)dataSource
+{
+    if (!dataSource)
+    {
+        return nil;
+    }
+    
+    @synchronized(self)
+    {
+        MSIDLegacyTokenCacheAccessor *accessor = [_accessors objectForKey:dataSource];
+        
+        if (!accessor)
+        {
+            accessor = [ADTokenCacheRegistry createAccessorForDataSource:dataSource];
+            [_accessors setObject:accessor forKey:dataSource];
+        }
+        
+        return accessor;
+    }
+}
+
+- (ADMSIDDataSourceWrapper *)wrapperForDataSource:(id<MSIDTokenCacheDataSource>)dataSource
+{
+    if (!dataSource)
+    {
+        return nil;
+    }
+    
+    @synchronized(self)
+    {
+        ADMSIDDataSourceWrapper *wrapper = [_wrappers objectForKey:dataSource];
+        
+        if (!wrapper)
+        {
+            wrapper = [[ADMSIDDataSourceWrapper alloc] initWithMSIDDataSource:dataSource
+                                                                   serializer:[MSIDKeyedArchiverSerializer new]];
+            [_wrappers setObject:wrapper forKey:dataSource];
+        }
+        
+        return wrapper;
+    }
+}
+
++ (MSIDLegacyTokenCacheAccessor *)createAccessorForDataSource:(id<MSIDTokenCacheDataSource>)dataSource
+{
+    MSIDOauth2Factory *factory = [MSIDAADV1Oauth2Factory new];
+    
+#if TARGET_OS_IPHONE
+    MSIDDefaultTokenCacheAccessor *defaultAccessor = [[MSIDDefaultTokenCacheAccessor alloc] initWithDataSource:dataSource otherCacheAccessors:nil factory:factory];
+    return [[MSIDLegacyTokenCacheAccessor alloc] initWithDataSource:dataSource otherCacheAccessors:@[defaultAccessor] factory:factory];
+#else
+    return [[MSIDLegacyTokenCacheAccessor alloc] initWithDataSource:dataSource otherCacheAccessors:nil factory:factory];
+#endif
+}
+
+@end
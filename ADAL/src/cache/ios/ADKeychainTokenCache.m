@@ -27,7 +27,7 @@
 #import "ADAuthenticationErrorConverter.h"
 #import "ADMSIDDataSourceWrapper.h"
 #import "MSIDKeychainTokenCache.h"
-#import "MSIDKeyedArchiverSerializer.h"
+#import "ADTokenCacheRegistry.h"
 #import "ADTokenCacheItem.h"
 #import "ADUserInformation.h"
 #import "MSIDLegacyTokenCacheKey.h"
@@ -70,12 +70,31 @@ static ADKeychainTokenCache* s_defaultCache = nil;
 
 + (ADKeychainTokenCache *)keychainCacheForGroup:(NSString *)group
 {
-    if ([group isEqualToString:self.defaultKeychainGroup])
+    if (!group || [group isEqualToString:self.defaultKeychainGroup])
     {
         return [self defaultKeychainCache];
     }
-    ADKeychainTokenCache *cache = [[ADKeychainTokenCache alloc] initWithGroup:group];
-    return cache;
+    
+    // Handed out again for the same group, so the keychain cache and wrapper are set up once
+    static NSMutableDictionary *s_cachesByGroup = nil;
+    
+    @synchronized(self)
+    {
+        if (!s_cachesByGroup)
+        {
+            s_cachesByGroup = [NSMutableDictionary new];
+        }
+        
+        ADKeychainTokenCache *cache = s_cachesByGroup[group];
+        
+        if (!cache)
+        {
+            cache = [[ADKeychainTokenCache alloc] initWithGroup:group];
+            s_cachesByGroup[group] = cache;
+        }
+        
+        return cache;
+    }
 }
 
 // Shouldn't be called.
@@ -91,9 +110,10 @@ static ADKeychainTokenCache* s_defaultCache = nil;
         return nil;
     }
     
-    _keychainTokenCache = [[MSIDKeychainTokenCache alloc] initWithGroup:sharedGroup];
-    _msidDataSourceWrapper = [[ADMSIDDataSourceWrapper alloc] initWithMSIDDataSource:_keychainTokenCache
-                                                                          serializer:[MSIDKeyedArchiverSerializer new]];
+    // Shared with the contexts and the other cache objects using the same keychain group
+    ADTokenCacheRegistry *registry = [ADTokenCacheRegistry sharedRegistry];
+    _keychainTokenCache = [registry keychainCacheForGroup:sharedGroup];
+    _msidDataSourceWrapper = [registry wrapperForDataSource:_keychainTokenCache];
     
     return self;
 }
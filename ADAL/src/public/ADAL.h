@@ -48,6 +48,7 @@ typedef WebView   WebViewType;
 typedef void(^ADAuthenticationCallback)(ADAuthenticationResult* result);
 
 #import <ADAL/ADAuthenticationContext.h>
+#import <ADAL/ADCancellationHandle.h>
 #import <ADAL/ADAuthenticationError.h>
 #import <ADAL/ADAuthenticationParameters.h>
 #import <ADAL/ADAuthenticationResult.h>
@@ -28,6 +28,7 @@
 @class ADTokenCacheItem;
 @class ADUserInformation;
 @class ADUserIdentifier;
+@class ADCancellationHandle;
 @class UIViewController;
 @class ADTokenCache;
 
@@ -121,6 +122,8 @@ typedef enum
     BOOL _validateAuthority;
     ADCredentialsType _credentialsType;
     BOOL _extendedLifetimeEnabled;
+    NSTimeInterval _acquireTokenTimeout;
+    NSQualityOfService _requestQualityOfService;
     NSString* _logComponent;
     NSUUID* _correlationId;
 #if __has_feature(objc_arc)
@@ -273,6 +276,20 @@ typedef enum
 /*! Enable to return access token with extended lifetime during server outage. */
 @property BOOL extendedLifetimeEnabled;
 
+/*! Overall time in seconds an acquireToken call may spend on network requests, retries
+    included. Every request only gets what is left of it, and the call fails with
+    NSURLErrorTimedOut once it runs out. Time spent in the web view or the broker is not
+    counted. Default is 0 (no limit). */
+@property NSTimeInterval acquireTokenTimeout;
+
+/*! Quality of service acquireToken calls are made at. It sets the priority of the network
+    requests, and the class retries, authority validation and completion dispatches run at,
+    so that calls a user is waiting on get ahead of ones made in the background. Set it to
+    NSQualityOfServiceUtility or NSQualityOfServiceBackground on a context used for
+    background refreshes. Default is NSQualityOfServiceDefault, which leaves the system
+    defaults alone. */
+@property NSQualityOfService requestQualityOfService;
+
 /*! Follows the OAuth2 protocol (RFC 6749). The function will first look at the cache and automatically check for token
  expiration. Additionally, if no suitable access token is found in the cache, but refresh token is available,
  the function will use the refresh token automatically. If neither of these attempts succeeds, the method will use the provided assertion to get an 
@@ -284,13 +301,14 @@ typedef enum
  @param clientId The client identifier
  @param userId The required user id of the authenticated user.
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenForAssertion:(NSString*)assertion
-                   assertionType:(ADAssertionType)assertionType
-                        resource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                          userId:(NSString*)userId
-                 completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenForAssertion:(NSString*)assertion
+                                     assertionType:(ADAssertionType)assertionType
+                                          resource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                            userId:(NSString*)userId
+                                   completionBlock:(ADAuthenticationCallback)completionBlock;
 
 
 /*! Follows the OAuth2 protocol (RFC 6749). The function will first look at the cache and automatically check for token
@@ -303,11 +321,12 @@ typedef enum
  @param clientId The client identifier
  @param redirectUri The redirect URI according to OAuth2 protocol.
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                 completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                   completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The function will first look at the cache and automatically check for token
  expiration. Additionally, if no suitable access token is found in the cache, but refresh token is available,
@@ -321,12 +340,13 @@ typedef enum
  @param userId The user to be prepopulated in the credentials form. Additionally, if token is found in the cache,
  it may not be used if it belongs to different token. This parameter can be nil.
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                          userId:(NSString*)userId
-                 completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                            userId:(NSString*)userId
+                                   completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The function will first look at the cache and automatically check for token
  expiration. Additionally, if no suitable access token is found in the cache, but refresh token is available,
@@ -341,13 +361,14 @@ typedef enum
  it may not be used if it belongs to different token. This parameter can be nil.
  @param queryParams The extra query parameters will be appended to the HTTP request to the authorization endpoint. This parameter can be nil.
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                          userId:(NSString*)userId
-            extraQueryParameters:(NSString*)queryParams
-                 completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                            userId:(NSString*)userId
+                              extraQueryParameters:(NSString*)queryParams
+                                   completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The behavior is controlled by the promptBehavior parameter on whether to re-authorize the
  resource usage (through webview credentials UI) or attempt to use the cached tokens first.
@@ -359,14 +380,15 @@ typedef enum
  it may not be used if it belongs to different token. This parameter can be nil.
  @param queryParams The extra query parameters will be appended to the HTTP request to the authorization endpoint. This parameter can be nil.
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                  promptBehavior:(ADPromptBehavior)promptBehavior
-                          userId:(NSString*)userId
-            extraQueryParameters:(NSString*)queryParams
-                 completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                    promptBehavior:(ADPromptBehavior)promptBehavior
+                                            userId:(NSString*)userId
+                              extraQueryParameters:(NSString*)queryParams
+                                   completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The behavior is controlled by the promptBehavior parameter on whether to re-authorize the
  resource usage (through webview credentials UI) or attempt to use the cached tokens first.
@@ -377,14 +399,15 @@ typedef enum
  @param userId An ADUserIdentifier object describing the user being authenticated
  @param queryParams The extra query parameters will be appended to the HTTP request to the authorization endpoint. This parameter can be nil.
  @param completionBlock the block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenWithResource:(NSString*)resource
-                        clientId:(NSString*)clientId
-                     redirectUri:(NSURL*)redirectUri
-                  promptBehavior:(ADPromptBehavior)promptBehavior
-                  userIdentifier:(ADUserIdentifier*)userId
-            extraQueryParameters:(NSString*)queryParams
-                 completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString*)resource
+                                          clientId:(NSString*)clientId
+                                       redirectUri:(NSURL*)redirectUri
+                                    promptBehavior:(ADPromptBehavior)promptBehavior
+                                    userIdentifier:(ADUserIdentifier*)userId
+                              extraQueryParameters:(NSString*)queryParams
+                                   completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The function accepts claims challenge returned from middle tier service, which will be sent to authorization endpoint. If claims parameter is not nil/empty, tokens in cache will be skipped and webview credentials UI will be shown.
  @param resource The resource for whom token is needed.
@@ -395,15 +418,16 @@ typedef enum
  @param queryParams The extra query parameters will be appended to the HTTP request to the authorization endpoint. This parameter can be nil.
  @param claims The claims parameter that needs to be sent to authorization endpoint. It should be URL-encoded.
  @param completionBlock the block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenWithResource:(NSString *)resource
-                        clientId:(NSString *)clientId
-                     redirectUri:(NSURL *)redirectUri
-                  promptBehavior:(ADPromptBehavior)promptBehavior
-                  userIdentifier:(ADUserIdentifier *)userId
-            extraQueryParameters:(NSString *)queryParams
-                          claims:(NSString *)claims
-                 completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenWithResource:(NSString *)resource
+                                          clientId:(NSString *)clientId
+                                       redirectUri:(NSURL *)redirectUri
+                                    promptBehavior:(ADPromptBehavior)promptBehavior
+                                    userIdentifier:(ADUserIdentifier *)userId
+                              extraQueryParameters:(NSString *)queryParams
+                                            claims:(NSString *)claims
+                                   completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The function will first look at the cache and automatically check for token
  expiration. Additionally, if no suitable access token is found in the cache, but refresh token is available,
@@ -413,11 +437,12 @@ typedef enum
  @param clientId the client identifier
  @param redirectUri The redirect URI according to OAuth2 protocol.
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenSilentWithResource:(NSString*)resource
-                              clientId:(NSString*)clientId
-                           redirectUri:(NSURL*)redirectUri
-                       completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenSilentWithResource:(NSString*)resource
+                                                clientId:(NSString*)clientId
+                                             redirectUri:(NSURL*)redirectUri
+                                         completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The function will first look at the cache and automatically check for token
  expiration. Additionally, if no suitable access token is found in the cache, but refresh token is available,
@@ -429,12 +454,33 @@ typedef enum
  @param userId The user to be prepopulated in the credentials form. Additionally, if token is found in the cache,
  it may not be used if it belongs to different token. This parameter can be nil.
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenSilentWithResource:(NSString*)resource
-                              clientId:(NSString*)clientId
-                           redirectUri:(NSURL*)redirectUri
-                                userId:(NSString*)userId
-                       completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenSilentWithResource:(NSString*)resource
+                                                clientId:(NSString*)clientId
+                                             redirectUri:(NSURL*)redirectUri
+                                                  userId:(NSString*)userId
+                                         completionBlock:(ADAuthenticationCallback)completionBlock;
+
+/*! Same as acquireTokenSilentWithResource:clientId:redirectUri:userId:completionBlock: with the option
+ to trade freshness for latency.
+ @param resource The resource whose token is needed.
+ @param clientId The client identifier
+ @param redirectUri The redirect URI according to OAuth2 protocol
+ @param userId The user to be prepopulated in the credentials form. Additionally, if token is found in the cache,
+ it may not be used if it belongs to different token. This parameter can be nil.
+ @param staleWhileRevalidate If YES and the cached access token has expired but is still within its extended
+ lifetime, that token is returned right away (with extendedLifeTimeToken set on the result) and refreshed in the
+ background, so that later calls get a fresh token. Only one background refresh runs per user, resource and client.
+ @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
+ */
+- (ADCancellationHandle *)acquireTokenSilentWithResource:(NSString*)resource
+                                                clientId:(NSString*)clientId
+                                             redirectUri:(NSURL*)redirectUri
+                                                  userId:(NSString*)userId
+                                    staleWhileRevalidate:(BOOL)staleWhileRevalidate
+                                         completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The function will use the refresh token provided to get access token.
  This method will not show UI for the user to reauthorize resource usage.
@@ -444,12 +490,13 @@ typedef enum
  @param clientId The client identifier
  @param redirectUri The redirect URI according to OAuth2 protocol
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
  */
-- (void)acquireTokenWithRefreshToken:(NSString *)refreshToken
-                            resource:(NSString *)resource
-                            clientId:(NSString *)clientId
-                         redirectUri:(NSURL *)redirectUri
-                     completionBlock:(ADAuthenticationCallback)completionBlock;
+- (ADCancellationHandle *)acquireTokenWithRefreshToken:(NSString *)refreshToken
+                                              resource:(NSString *)resource
+                                              clientId:(NSString *)clientId
+                                           redirectUri:(NSURL *)redirectUri
+                                       completionBlock:(ADAuthenticationCallback)completionBlock;
 
 /*! Follows the OAuth2 protocol (RFC 6749). The function will use the refresh token provided to get access token.
  This method will not show UI for the user to reauthorize resource usage.
@@ -460,13 +507,25 @@ typedef enum
  @param redirectUri The redirect URI according to OAuth2 protocol
  @param userId The user matching the refresh token provided. If there is a mismatch, error will be returned
  @param completionBlock The block to execute upon completion. You can use embedded block, e.g. "^(ADAuthenticationResult res){ <your logic here> }"
+ @return A handle the request can be cancelled with, nil if it couldn't be started.
+ */
+- (ADCancellationHandle *)acquireTokenWithRefreshToken:(NSString *)refreshToken
+                                              resource:(NSString *)resource
+                                              clientId:(NSString *)clientId
+                                           redirectUri:(NSURL *)redirectUri
+                                                userId:(NSString *)userId
+                                       completionBlock:(ADAuthenticationCallback)completionBlock;
+
+/*!
+ Does the one-time work the first acquireToken call would otherwise pay for, in the background:
+ validates the authority and looks up the keychain team ID (iOS only). It doesn't connect to the
+ token endpoint or read the token cache.
+ Call it at app start, before the first call that a user is going to wait on. Failures are only
+ logged, a validation that didn't go through is done by the first call as it would be otherwise.
+ 
+ @param completionBlock Called on a background queue once done. Optional.
  */
-- (void)acquireTokenWithRefreshToken:(NSString *)refreshToken
-                            resource:(NSString *)resource
-                            clientId:(NSString *)clientId
-                         redirectUri:(NSURL *)redirectUri
-                              userId:(NSString *)userId
-                     completionBlock:(ADAuthenticationCallback)completionBlock;
+- (void)prewarmWithCompletionBlock:(void (^)(void))completionBlock;
 
 @end
 
@@ -33,6 +33,10 @@
 {
     int _requestTimeOut;
     uint _expirationBuffer;
+    uint _maxResponseSize;
+    NSTimeInterval _requestHedgingDelay;
+    NSTimeInterval _instanceDiscoveryCacheLifetime;
+    NSTimeInterval _resourceChallengeCacheLifetime;
 #if !TARGET_OS_IPHONE
     id<ADTokenCacheDelegate> _defaultStorageDelegate;
 #endif
@@ -50,6 +54,30 @@
  about to expire. */
 @property uint expirationBuffer;
 
+/*! The maximum size, in bytes, of a response body ADAL will buffer for any of
+ the web requests. Responses that announce or deliver more than this are aborted
+ with NSURLErrorDataLengthExceedsMaximum. Set to 0 to disable the limit. */
+@property uint maxResponseSize;
+
+/*! If set, discovery requests (authority validation, DRS and WebFinger) that haven't received
+ a response after this many seconds are sent a second time, and the first response to arrive
+ is used. A good value is around the 95th percentile latency of those requests. Specified in
+ seconds, default is 0 which disables hedging. */
+@property NSTimeInterval requestHedgingDelay;
+
+/*! If set, the results of AAD instance discovery are also kept in a file in the application's
+ caches directory for this many seconds, so that later launches can skip the discovery request
+ for authorities that were validated before. Most useful for short lived processes such as
+ extensions. Specified in seconds, default is 0 which keeps the results in memory only. */
+@property NSTimeInterval instanceDiscoveryCacheLifetime;
+
+/*! If set, the parameters +[ADAuthenticationParameters parametersFromResourceUrl:completionBlock:]
+ reads from a resource's challenge are reused for this many seconds for any resource on the same
+ host, instead of sending the resource a new request each time. A challenge passed to
+ +[ADAuthenticationParameters parametersFromResponse:error:] that differs from the cached one
+ replaces it. Specified in seconds, default is 0 which disables the cache. */
+@property NSTimeInterval resourceChallengeCacheLifetime;
+
 #if TARGET_OS_IPHONE
 /*! Used for the webView. Default is YES.*/
 @property BOOL enableFullScreen;
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/*!
+    Returned by the acquireToken family of calls on ADAuthenticationContext to let the
+    application give up on a request that is in progress.
+ 
+    Cancelling stops any network requests in flight, keeps the request from moving on to
+    other refresh tokens and dismisses the web view if it is showing. The completion block
+    is then called with a result of status AD_USER_CANCELLED and an error with code
+    AD_ERROR_REQUEST_CANCELLED, unless the request already completed or succeeds anyway.
+    Once the broker has been launched the request can't be cancelled anymore.
+ */
+@interface ADCancellationHandle : NSObject
+
+@property (readonly, getter=isCancelled) BOOL cancelled;
+
+/*! Cancels the request. Can be called from any thread, and more than once. */
+- (void)cancel;
+
+@end
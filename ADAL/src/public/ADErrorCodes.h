@@ -31,6 +31,10 @@ typedef NS_ENUM(NSInteger, ADErrorCode)
     /*! An unexpected internal error occurred. */
     AD_ERROR_UNEXPECTED = -1,
     
+    /*! The application cancelled the request through the ADCancellationHandle returned when
+     starting it. */
+    AD_ERROR_REQUEST_CANCELLED = -2,
+    
     //
     // Developer Errors
     // These errors occur from bad parameters given by the developer
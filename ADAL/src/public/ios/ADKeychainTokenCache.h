@@ -60,7 +60,8 @@
 
 /*!
     @return An instance of ADKeychainTokenCache for the given group, or the defaultKeychainCache
-            singleton if the default keychain group is passed in.
+            singleton if the default keychain group is passed in. The same instance is returned
+            for every call with the same group.
  */
 + (nonnull ADKeychainTokenCache*)keychainCacheForGroup:(nullable NSString*)group;
 
@@ -43,6 +43,9 @@
 #import "MSIDAADV1Oauth2Factory.h"
 #import "MSIDAccountIdentifier.h"
 #import "ADAuthenticationSettings.h"
+#import "ADCircuitBreaker.h"
+#import "ADRequestDeadline.h"
+#import "ADCancellationHandle.h"
 
 @interface ADAcquireTokenSilentHandler()
 
@@ -76,25 +79,32 @@
          if ([_requestParams extendedLifetime] && [self isServerUnavailable:result] && _extendedLifetimeAccessTokenItem)
          {
              // give the stale token as result
-             [[MSIDLogger sharedLogger] logToken:_extendedLifetimeAccessTokenItem.accessToken
-                                       tokenType:@"AT (extended lifetime)"
-                                   expiresOnDate:_extendedLifetimeAccessTokenItem.expiresOn
-                                    additionaLog:@"Returning"
-                                         context:_requestParams];
-             
-             ADTokenCacheItem *cacheItem = [[ADTokenCacheItem alloc] initWithLegacySingleResourceToken:_extendedLifetimeAccessTokenItem];
-             cacheItem.expiresOn = _extendedLifetimeAccessTokenItem.extendedExpireTime;
-             
-             result = [ADAuthenticationResult resultFromTokenCacheItem:cacheItem
-                                             multiResourceRefreshToken:NO
-                                                         correlationId:[_requestParams correlationId]];
-             [result setExtendedLifeTimeToken:YES];
+             result = [self extendedLifetimeResult];
          }
          
          completionBlock(result);
      }];
 }
 
+- (ADAuthenticationResult *)extendedLifetimeResult
+{
+    [[MSIDLogger sharedLogger] logToken:_extendedLifetimeAccessTokenItem.accessToken
+                              tokenType:@"AT (extended lifetime)"
+                          expiresOnDate:_extendedLifetimeAccessTokenItem.expiresOn
+                           additionaLog:@"Returning"
+                                context:_requestParams];
+    
+    ADTokenCacheItem *cacheItem = [[ADTokenCacheItem alloc] initWithLegacySingleResourceToken:_extendedLifetimeAccessTokenItem];
+    cacheItem.expiresOn = _extendedLifetimeAccessTokenItem.extendedExpireTime;
+    
+    ADAuthenticationResult *result = [ADAuthenticationResult resultFromTokenCacheItem:cacheItem
+                                                            multiResourceRefreshToken:NO
+                                                                        correlationId:[_requestParams correlationId]];
+    [result setExtendedLifeTimeToken:YES];
+    
+    return result;
+}
+
 #pragma mark -
 #pragma mark Refresh Token Helper Methods
 
@@ -135,10 +145,8 @@
         request_data[MSID_OAUTH2_SCOPE] = _requestParams.scopesString;
     }
 
-    NSString *authority = _requestParams.cloudAuthority ? _requestParams.cloudAuthority : _requestParams.authority;
-
     ADWebAuthRequest* webReq =
-    [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:[authority stringByAppendingString:MSID_OAUTH2_TOKEN_SUFFIX]]
+    [[ADWebAuthRequest alloc] initWithURL:[self tokenEndpoint]
                                   context:_requestParams];
     [webReq setRequestDictionary:request_data];
     
@@ -214,6 +222,45 @@
              completionBlock:(ADAuthenticationCallback)completionBlock
                     fallback:(ADAuthenticationCallback)fallback
 {
+    NSString *tokenEndpointHost = [self tokenEndpointHost];
+    
+    // Each refresh token tried is another round trip the caller no longer wants
+    if ([[_requestParams cancellationHandle] isCancelled])
+    {
+        MSID_LOG_INFO(_requestParams, @"Request has been cancelled, skipping refresh");
+        completionBlock([ADAuthenticationResult resultFromRequestCancellation:[_requestParams correlationId]]);
+        return;
+    }
+    
+    ADRequestDeadline *deadline = [_requestParams deadline];
+    if ([deadline isExpired])
+    {
+        MSID_LOG_WARN(_requestParams, @"Deadline has passed, skipping refresh");
+        
+        if ([_requestParams extendedLifetime] && _extendedLifetimeAccessTokenItem)
+        {
+            completionBlock([self extendedLifetimeResult]);
+            return;
+        }
+        
+        NSError *expiredError = [deadline expiredError];
+        ADAuthenticationError *error = [ADAuthenticationError errorFromNSError:expiredError
+                                                                  errorDetails:expiredError.localizedDescription
+                                                                 correlationId:[_requestParams correlationId]];
+        completionBlock([ADAuthenticationResult resultFromError:error correlationId:[_requestParams correlationId]]);
+        return;
+    }
+    
+    // If the token endpoint is known to be down and we have a stale token to give back
+    // there's no point in waiting for yet another request to time out.
+    if ([_requestParams extendedLifetime] && _extendedLifetimeAccessTokenItem &&
+        ![[ADCircuitBreaker sharedInstance] shouldAllowRequestToHost:tokenEndpointHost context:_requestParams])
+    {
+        MSID_LOG_INFO(_requestParams, @"Token endpoint is unavailable, skipping refresh and returning extended lifetime token");
+        completionBlock([self extendedLifetimeResult]);
+        return;
+    }
+    
     [[MSIDTelemetry sharedInstance] startEvent:[_requestParams telemetryRequestId] eventName:MSID_TELEMETRY_EVENT_TOKEN_GRANT];
     [self acquireTokenByRefreshToken:refreshToken.refreshToken
                            cacheItem:refreshToken
@@ -225,6 +272,17 @@
          [event setGrantType:MSID_TELEMETRY_VALUE_BY_REFRESH_TOKEN];
          [event setResultStatus:[result status]];
          [[MSIDTelemetry sharedInstance] stopEvent:[_requestParams telemetryRequestId] event:event];
+         
+         if ([self didReceiveServerResponse:result])
+         {
+             [[ADCircuitBreaker sharedInstance] recordResultForHost:tokenEndpointHost
+                                                  serverUnavailable:[self isServerUnavailable:result]
+                                                            context:_requestParams];
+         }
+         else
+         {
+             [[ADCircuitBreaker sharedInstance] recordNoResponseForHost:tokenEndpointHost];
+         }
 
          NSString* resultStatus = @"Succeded";
          
@@ -338,6 +396,14 @@
     if (item.accessToken && item.isExtendedLifetimeValid)
     {
         _extendedLifetimeAccessTokenItem = item;
+        
+        // The caller would rather have the stale token now than wait for the refresh
+        if (_requestParams.staleWhileRevalidate)
+        {
+            completionBlock([self extendedLifetimeResult]);
+            [self refreshInBackground:item];
+            return;
+        }
     }
 
     [self tryRT:item completionBlock:completionBlock];
@@ -513,6 +579,81 @@
      }];
 }
 
+#pragma mark -
+#pragma mark Background Refresh
+
++ (NSMutableSet<NSString *> *)backgroundRefreshes
+{
+    static NSMutableSet<NSString *> *s_backgroundRefreshes = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s_backgroundRefreshes = [NSMutableSet new];
+    });
+    
+    return s_backgroundRefreshes;
+}
+
+- (void)refreshInBackground:(MSIDLegacySingleResourceToken *)item
+{
+    NSString *key = [NSString stringWithFormat:@"%@|%@|%@|%@", _requestParams.authority, _requestParams.clientId, _requestParams.resource, _requestParams.identifier.userId];
+    NSMutableSet *backgroundRefreshes = [ADAcquireTokenSilentHandler backgroundRefreshes];
+    
+    @synchronized(backgroundRefreshes)
+    {
+        if ([backgroundRefreshes containsObject:key])
+        {
+            MSID_LOG_INFO(_requestParams, @"Background refresh already in progress, not starting another one");
+            return;
+        }
+        
+        [backgroundRefreshes addObject:key];
+    }
+    
+    // The original request is done as far as the caller and telemetry are concerned,
+    // so the refresh gets a request ID of its own.
+    ADRequestParameters *params = [_requestParams copy];
+    params.telemetryRequestId = [[MSIDTelemetry sharedInstance] generateRequestId];
+    params.staleWhileRevalidate = NO;
+    params.deadline = nil;
+    params.cancellationHandle = nil;
+    // Nobody is waiting on the refresh, so it gives way to requests someone is waiting on
+    params.qosClass = QOS_CLASS_UTILITY;
+    
+    ADAcquireTokenSilentHandler *handler = [ADAcquireTokenSilentHandler requestWithParams:params tokenCache:self.tokenCache];
+    
+    MSID_LOG_INFO(params, @"Refreshing extended lifetime token in the background");
+    
+    [handler tryRT:item completionBlock:^(ADAuthenticationResult *result)
+     {
+         @synchronized(backgroundRefreshes)
+         {
+             [backgroundRefreshes removeObject:key];
+         }
+         
+         MSID_LOG_INFO(params, @"Background refresh finished with status %d", (int)result.status);
+         [[MSIDTelemetry sharedInstance] flush:params.telemetryRequestId];
+     }];
+}
+
+- (NSURL *)tokenEndpoint
+{
+    NSString *authority = _requestParams.cloudAuthority ? _requestParams.cloudAuthority : _requestParams.authority;
+    
+    return [NSURL URLWithString:[authority stringByAppendingString:MSID_OAUTH2_TOKEN_SUFFIX]];
+}
+
+- (NSString *)tokenEndpointHost
+{
+    return [[self tokenEndpoint] host];
+}
+
+// Cancellation, running out of time and connection errors all come back in NSURLErrorDomain,
+// anything else means the token endpoint got to answer the request.
+- (BOOL)didReceiveServerResponse:(ADAuthenticationResult *)result
+{
+    return ![[result.error domain] isEqualToString:NSURLErrorDomain];
+}
+
 - (BOOL)isServerUnavailable:(ADAuthenticationResult *)result
 {
     if (![[result.error domain] isEqualToString:ADHTTPErrorCodeDomain])
@@ -38,6 +38,8 @@
 #import "MSIDLegacyTokenCacheAccessor.h"
 #import "ADTokenCacheItem+MSIDTokens.h"
 #import "MSIDAccessToken.h"
+#import "ADCancellationHandle+Internal.h"
+#import "ADWebAuthController.h"
 #import "ADUserInformation.h"
 #import "ADResponseCacheHandler.h"
 #import "MSIDLegacyRefreshToken.h"
@@ -71,6 +73,12 @@
     
     ADAuthenticationCallback wrappedCallback = ^void(ADAuthenticationResult* result)
     {
+        // Whatever failure the cancellation surfaced as, report it as such
+        if (result.status != AD_SUCCEEDED && [[_requestParams cancellationHandle] isCancelled])
+        {
+            result = [ADAuthenticationResult resultFromRequestCancellation:_requestParams.correlationId];
+        }
+        
         if (result.status == AD_SUCCEEDED)
         {
             MSID_LOG_INFO(_requestParams, @"##### END succeeded. %@ #####", logMessage);
@@ -241,6 +249,11 @@
 {
     [self ensureRequest];
     
+    if (![self checkCancelled:completionBlock] || ![self checkDeadline:completionBlock])
+    {
+        return;
+    }
+    
     if (_refreshToken)
     {
         [self tryRefreshToken:completionBlock];
@@ -284,6 +297,12 @@
 {
     [self ensureRequest];
     NSUUID* correlationId = [_requestParams correlationId];
+    
+    // Don't fall through to the next step once the caller gave up or its budget is gone
+    if (![self checkCancelled:completionBlock] || ![self checkDeadline:completionBlock])
+    {
+        return;
+    }
 
     if (_samlAssertion)
     {
@@ -340,6 +359,9 @@
 
 - (void)requestTokenImpl:(ADAuthenticationCallback)completionBlock
 {
+    // The time the user takes to sign in isn't something the deadline can account for
+    [_requestParams setDeadline:nil];
+    
 #if TARGET_OS_IPHONE
     //call the broker.
     if ([self canUseBroker])
@@ -416,6 +438,21 @@
             originalCompletionBlock(result);
         }
     };
+    
+    // Dismissing the web view completes the request, which releases the lock
+    __weak ADAuthenticationRequest *weakSelf = self;
+    [[_requestParams cancellationHandle] addCancellationBlock:^{
+        dispatch_async(dispatch_get_main_queue(), ^{
+            ADAuthenticationRequest *strongSelf = weakSelf;
+            if (!strongSelf || [ADAuthenticationRequest currentModalRequest] != strongSelf)
+            {
+                return;
+            }
+            
+            ADAuthenticationError *error = [ADAuthenticationError errorFromRequestCancellation:[strongSelf correlationId]];
+            [[ADWebAuthController sharedInstance] cancelCurrentWebAuthSessionWithError:error];
+        });
+    }];
 
     __block BOOL silentRequest = _allowSilent;
     
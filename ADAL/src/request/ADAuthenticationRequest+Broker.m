@@ -26,7 +26,6 @@
 #import "ADAuthenticationSettings.h"
 #import "ADBrokerHelper.h"
 #import "ADHelpers.h"
-#import "ADPkeyAuthHelper.h"
 #import "ADTokenCacheItem+Internal.h"
 #import "ADUserIdentifier.h"
 #import "ADUserInformation.h"
@@ -50,6 +49,7 @@
 #import "ADBrokerKeyHelper.h"
 #import "ADBrokerNotificationManager.h"
 #import "ADKeychainUtil.h"
+#import "ADRegistrationInformationCache.h"
 #import "MSIDBrokerResponse+ADAL.h"
 #endif // TARGET_OS_IPHONE
 
@@ -112,6 +112,9 @@ NSString* kAdalResumeDictionaryKey = @"adal-broker-resume-dictionary";
 #if TARGET_OS_IPHONE
     __block ADAuthenticationCallback completionBlock = [ADBrokerHelper copyAndClearCompletionBlock];
     
+    // The broker might just have registered the device
+    [[ADRegistrationInformationCache sharedCache] clear];
+    
     ADAuthenticationError* error = nil;
     ADAuthenticationResult* result = [self processBrokerResponse:response
                                                            error:&error];
@@ -221,29 +224,28 @@ NSString* kAdalResumeDictionaryKey = @"adal-broker-resume-dictionary";
     }
     s_brokerProtocolVersion = msgVer;
     
-    //decrypt response first
+    //decrypt response first, checking the hash on the unencrypted data as it gets decrypted
     ADBrokerKeyHelper* brokerHelper = [[ADBrokerKeyHelper alloc] init];
     ADAuthenticationError* decryptionError = nil;
     NSData *encryptedResponse = [NSString msidBase64UrlDecodeData:encryptedBase64Response ];
     NSData* decrypted = [brokerHelper decryptBrokerResponse:encryptedResponse
                                                     version:protocolVersion
+                                                       hash:hash
                                                       error:&decryptionError];
-    if (!decrypted)
+    if (!decrypted && decryptionError.code == AD_ERROR_TOKENBROKER_RESPONSE_HASH_MISMATCH)
     {
-        AUTH_ERROR_UNDERLYING(AD_ERROR_TOKENBROKER_DECRYPTION_FAILED, @"Failed to decrypt broker message", decryptionError, correlationId)
+        AUTH_ERROR(AD_ERROR_TOKENBROKER_RESPONSE_HASH_MISMATCH, @"Decrypted response does not match the hash", correlationId);
         return nil;
     }
     
-    
-    NSString* decryptedString = [[NSString alloc] initWithData:decrypted encoding:NSUTF8StringEncoding];
-    //now compute the hash on the unencrypted data
-    NSString* actualHash = [ADPkeyAuthHelper computeThumbprint:decrypted isSha2:YES];
-    if(![hash isEqualToString:actualHash])
+    if (!decrypted)
     {
-        AUTH_ERROR(AD_ERROR_TOKENBROKER_RESPONSE_HASH_MISMATCH, @"Decrypted response does not match the hash", correlationId);
+        AUTH_ERROR_UNDERLYING(AD_ERROR_TOKENBROKER_DECRYPTION_FAILED, @"Failed to decrypt broker message", decryptionError, correlationId)
         return nil;
     }
     
+    NSString* decryptedString = [[NSString alloc] initWithData:decrypted encoding:NSUTF8StringEncoding];
+    
     // create response from the decrypted payload
     queryParamsMap = [NSDictionary msidURLFormDecode:decryptedString];
     [ADHelpers removeNullStringFrom:queryParamsMap];
@@ -21,6 +21,8 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+@class ADRequestTemplate;
+
 @interface ADAuthenticationRequest (WebRequest)
 
 - (void)executeRequest:(NSDictionary *)request_data
@@ -31,4 +33,7 @@
 
 - (NSString*)generateQueryStringForRequestType:(NSString*)requestType;
 
+// The context's request template for this request's client ID and redirect URI
+- (ADRequestTemplate *)requestTemplate;
+
 @end
@@ -36,9 +36,9 @@
 #import "ADTokenCacheItem+Internal.h"
 #import "ADWebAuthRequest.h"
 #import "NSString+ADURLExtensions.h"
-#import "MSIDDeviceId.h"
 #import "MSIDAADV1Oauth2Factory.h"
 #import "ADAuthenticationErrorConverter.h"
+#import "ADRequestTemplate.h"
 
 @implementation ADAuthenticationRequest (WebRequest)
 
@@ -50,6 +50,7 @@
     ADWebAuthRequest* req = [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:urlString]
                                                           context:_requestParams];
     [req setRequestDictionary:request_data];
+    [req setRequestTemplate:[self requestTemplate]];
     [req sendRequest:^(ADAuthenticationError *error, NSDictionary *response)
      {
          if (error)
@@ -106,34 +107,31 @@
              msidURLFormEncode] msidBase64UrlEncode];
 }
 
+- (ADRequestTemplate *)requestTemplate
+{
+    return [_context requestTemplateWithClientId:_requestParams.clientId
+                                     redirectUri:_requestParams.redirectUri];
+}
+
 //Generates the query string, encoding the state:
 - (NSString*)generateQueryStringForRequestType:(NSString*)requestType
 {
     NSString* state = [self encodeProtocolState];
     NSString* queryParams = nil;
-    // Start the web navigation process for the Implicit grant profile.
-    NSMutableString* startUrl = [NSMutableString stringWithFormat:@"%@?%@=%@&%@=%@&%@=%@&%@=%@&%@=%@",
-                                 [_context.authority stringByAppendingString:MSID_OAUTH2_AUTHORIZE_SUFFIX],
-                                 MSID_OAUTH2_RESPONSE_TYPE, requestType,
-                                 MSID_OAUTH2_CLIENT_ID, [[_requestParams clientId] msidUrlFormEncode],
-                                 MSID_OAUTH2_RESOURCE, [[_requestParams resource] msidUrlFormEncode],
-                                 MSID_OAUTH2_REDIRECT_URI, [[_requestParams redirectUri] msidUrlFormEncode],
-                                 MSID_OAUTH2_STATE, state];
-    
-    [startUrl appendFormat:@"&%@", [[MSIDDeviceId deviceId] msidURLFormEncode]];
+    NSString* loginHint = nil;
     
     if ([_requestParams identifier] && [[_requestParams identifier] isDisplayable] && ![NSString msidIsStringNilOrBlank:[_requestParams identifier].userId])
     {
-        [startUrl appendFormat:@"&%@=%@", MSID_OAUTH2_LOGIN_HINT, [[_requestParams identifier].userId msidUrlFormEncode]];
-    }
-    NSString* promptParam = [ADAuthenticationContext getPromptParameter:_promptBehavior];
-    if (promptParam)
-    {
-        //Force the server to ignore cookies, by specifying explicitly the prompt behavior:
-        [startUrl appendString:[NSString stringWithFormat:@"&prompt=%@", promptParam]];
+        loginHint = [_requestParams identifier].userId;
     }
     
-    [startUrl appendString:@"&haschrome=1"]; //to hide back button in UI
+    // Start the web navigation process for the Implicit grant profile. The client ID, redirect URI
+    // and device ID segments come pre-encoded from the context's request template.
+    NSMutableString* startUrl = [[self requestTemplate] authorizeURLWithResponseType:requestType
+                                                                            resource:[_requestParams resource]
+                                                                               state:state
+                                                                           loginHint:loginHint
+                                                                              prompt:[ADAuthenticationContext getPromptParameter:_promptBehavior]];
     
     if (![NSString msidIsStringNilOrBlank:_queryParams])
     {//Append the additional query parameters if specified:
@@ -289,6 +287,7 @@
                                                               context:_requestParams];
         [req setIsGetRequest:YES];
         [req setRequestDictionary:requestData];
+        [req setRequestTemplate:[self requestTemplate]];
         [req sendRequest:^(ADAuthenticationError *error, NSDictionary * parameters)
          {
              if (error && ![parameters objectForKey:@"url"]) // auth code and OAuth2 error could be in endURL
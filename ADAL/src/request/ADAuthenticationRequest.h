@@ -28,6 +28,8 @@
 
 @class ADUserIdentifier;
 @class MSIDLegacyTokenCacheAccessor;
+@class ADRequestDeadline;
+@class ADCancellationHandle;
 
 #define AD_REQUEST_CHECK_ARGUMENT(_arg) { \
     if (!_arg || ([_arg isKindOfClass:[NSString class]] && [(NSString*)_arg isEqualToString:@""])) { \
@@ -103,10 +105,13 @@
 - (void)setPromptBehavior:(ADPromptBehavior)promptBehavior;
 - (void)setSilent:(BOOL)silent;
 - (void)setSkipCache:(BOOL)skipCache;
+- (void)setStaleWhileRevalidate:(BOOL)staleWhileRevalidate;
+- (void)setDeadline:(ADRequestDeadline *)deadline;
 - (void)setCorrelationId:(NSUUID*)correlationId;
 - (NSUUID*)correlationId;
 - (NSString*)telemetryRequestId;
 - (ADRequestParameters*)requestParams;
+- (ADCancellationHandle*)cancellationHandle;
 #if AD_BROKER
 - (NSString*)redirectUri;
 - (void)setRedirectUri:(NSString*)redirectUri;
@@ -136,6 +141,22 @@
  */
 + (void)releaseExclusionLock;
 
+/*!
+    Checks whether the deadline of the request, if any, has passed and if so sends a
+    timeout error to completionBlock.
+ 
+    @return NO if the deadline has passed
+ */
+- (BOOL)checkDeadline:(ADAuthenticationCallback)completionBlock;
+
+/*!
+    Checks whether the request has been cancelled through its cancellation handle and if
+    so sends the cancelled result to completionBlock.
+ 
+    @return NO if the request has been cancelled
+ */
+- (BOOL)checkCancelled:(ADAuthenticationCallback)completionBlock;
+
 /*!
     The current interactive request ADAL is displaying UI for (if any)
  */
@@ -37,6 +37,8 @@
 
 #import "ADAuthenticationRequest+WebRequest.h"
 #import "ADUserIdentifier.h"
+#import "ADRequestDeadline.h"
+#import "ADCancellationHandle.h"
 
 #include <libkern/OSAtomic.h>
 
@@ -173,6 +175,18 @@ static dispatch_semaphore_t s_interactionLock = nil;
     _skipCache = skipCache;
 }
 
+- (void)setStaleWhileRevalidate:(BOOL)staleWhileRevalidate
+{
+    CHECK_REQUEST_STARTED;
+    [_requestParams setStaleWhileRevalidate:staleWhileRevalidate];
+}
+
+- (void)setDeadline:(ADRequestDeadline *)deadline
+{
+    CHECK_REQUEST_STARTED;
+    [_requestParams setDeadline:deadline];
+}
+
 - (void)setCorrelationId:(NSUUID*)correlationId
 {
     CHECK_REQUEST_STARTED;
@@ -296,6 +310,11 @@ static dispatch_semaphore_t s_interactionLock = nil;
     return _requestParams;
 }
 
+- (ADCancellationHandle*)cancellationHandle
+{
+    return [_requestParams cancellationHandle];
+}
+
 /*!
     Takes the UI interaction lock for the current request, will send an error
     to completionBlock if it fails.
@@ -332,6 +351,36 @@ static dispatch_semaphore_t s_interactionLock = nil;
     s_modalRequest = nil;
 }
 
+- (BOOL)checkDeadline:(ADAuthenticationCallback)completionBlock
+{
+    ADRequestDeadline *deadline = [_requestParams deadline];
+    if (![deadline isExpired])
+    {
+        return YES;
+    }
+    
+    MSID_LOG_WARN(_requestParams, @"Deadline for the acquireToken call has passed");
+    
+    NSError *expiredError = [deadline expiredError];
+    ADAuthenticationError *error = [ADAuthenticationError errorFromNSError:expiredError
+                                                              errorDetails:expiredError.localizedDescription
+                                                             correlationId:_requestParams.correlationId];
+    completionBlock([ADAuthenticationResult resultFromError:error correlationId:_requestParams.correlationId]);
+    return NO;
+}
+
+- (BOOL)checkCancelled:(ADAuthenticationCallback)completionBlock
+{
+    if (![[_requestParams cancellationHandle] isCancelled])
+    {
+        return YES;
+    }
+    
+    MSID_LOG_INFO(_requestParams, @"acquireToken call has been cancelled");
+    completionBlock([ADAuthenticationResult resultFromRequestCancellation:_requestParams.correlationId]);
+    return NO;
+}
+
 + (ADAuthenticationRequest*)currentModalRequest
 {
     return s_modalRequest;
@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "MSIDRequestContext.h"
+
+typedef NS_ENUM(NSInteger, ADCircuitBreakerState)
+{
+    /*! Requests go through as usual */
+    ADCircuitBreakerStateClosed,
+    /*! The endpoint is considered down, requests that have something else to fall back on shouldn't be sent */
+    ADCircuitBreakerStateOpen,
+    /*! The open interval has passed, a single probe request is let through to see if the endpoint is back */
+    ADCircuitBreakerStateHalfOpen,
+};
+
+/*!
+    Tracks the health of token endpoints, keyed by host. After failureThreshold consecutive
+    server-unavailable responses from a host the breaker opens, and callers that can serve
+    something else (an extended lifetime token) skip the network instead of waiting on a
+    request that is likely to fail. Once openInterval has passed a single probe is let through;
+    its result either closes the breaker again or keeps it open for another interval.
+ */
+@interface ADCircuitBreaker : NSObject
+
+/*! Consecutive server-unavailable results after which the breaker opens. Default is 3. */
+@property NSUInteger failureThreshold;
+
+/*! How long the breaker stays open before letting a probe through. Default is 30 seconds. */
+@property NSTimeInterval openInterval;
+
++ (ADCircuitBreaker *)sharedInstance;
+
+/*!
+    Returns NO if a request to the host should be skipped. In the half-open state this returns
+    YES exactly once, and the caller is expected to report the outcome of that request through
+    -recordResultForHost:serverUnavailable:context:
+ */
+- (BOOL)shouldAllowRequestToHost:(NSString *)host
+                         context:(id<MSIDRequestContext>)context;
+
+/*! Reports the outcome of a request that got an HTTP response back from the host. */
+- (void)recordResultForHost:(NSString *)host
+          serverUnavailable:(BOOL)serverUnavailable
+                    context:(id<MSIDRequestContext>)context;
+
+/*!
+    Reports a request to the host that ended without a response (cancelled, out of time or
+    never reached the server). It says nothing about the health of the endpoint, so no failure
+    is counted, and if it was the half-open probe the breaker stays half-open and lets the
+    next request through as the probe.
+ */
+- (void)recordNoResponseForHost:(NSString *)host;
+
+- (ADCircuitBreakerState)stateForHost:(NSString *)host;
+
+/*! Closes every breaker and forgets all failures. */
+- (void)reset;
+
+@end
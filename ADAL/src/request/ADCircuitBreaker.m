@@ -0,0 +1,249 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "ADCircuitBreaker.h"
+#import "ADTelemetry.h"
+#import "MSIDTelemetry+Internal.h"
+#import "ADTelemetryAPIEvent.h"
+
+@interface ADCircuitBreakerEntry : NSObject
+
+@property ADCircuitBreakerState state;
+@property NSUInteger consecutiveFailures;
+@property NSDate *openedAt;
+@property BOOL probeInFlight;
+
+@end
+
+@implementation ADCircuitBreakerEntry
+
+@end
+
+@implementation ADCircuitBreaker
+{
+    NSMutableDictionary<NSString *, ADCircuitBreakerEntry *> *_entries;
+}
+
++ (ADCircuitBreaker *)sharedInstance
+{
+    static ADCircuitBreaker *s_circuitBreaker = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s_circuitBreaker = [ADCircuitBreaker new];
+    });
+    
+    return s_circuitBreaker;
+}
+
+- (id)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _failureThreshold = 3;
+    _openInterval = 30;
+    _entries = [NSMutableDictionary new];
+    
+    return self;
+}
+
+- (BOOL)shouldAllowRequestToHost:(NSString *)host
+                         context:(id<MSIDRequestContext>)context
+{
+    if (!host)
+    {
+        return YES;
+    }
+    
+    BOOL allow = YES;
+    BOOL halfOpened = NO;
+    
+    @synchronized(self)
+    {
+        ADCircuitBreakerEntry *entry = _entries[host];
+        
+        switch (entry.state)
+        {
+            case ADCircuitBreakerStateClosed:
+                break;
+                
+            case ADCircuitBreakerStateOpen:
+                if ([[NSDate date] timeIntervalSinceDate:entry.openedAt] < self.openInterval)
+                {
+                    allow = NO;
+                    break;
+                }
+                
+                entry.state = ADCircuitBreakerStateHalfOpen;
+                entry.probeInFlight = YES;
+                halfOpened = YES;
+                break;
+                
+            case ADCircuitBreakerStateHalfOpen:
+                // Only one probe at a time, everyone else keeps using their fallback
+                allow = !entry.probeInFlight;
+                entry.probeInFlight = YES;
+                break;
+        }
+    }
+    
+    if (halfOpened)
+    {
+        [self logState:ADCircuitBreakerStateHalfOpen host:host context:context];
+    }
+    
+    return allow;
+}
+
+- (void)recordResultForHost:(NSString *)host
+          serverUnavailable:(BOOL)serverUnavailable
+                    context:(id<MSIDRequestContext>)context
+{
+    if (!host)
+    {
+        return;
+    }
+    
+    ADCircuitBreakerState previousState;
+    ADCircuitBreakerState newState;
+    
+    @synchronized(self)
+    {
+        ADCircuitBreakerEntry *entry = _entries[host];
+        if (!entry)
+        {
+            if (!serverUnavailable)
+            {
+                // Nothing to track for a healthy host
+                return;
+            }
+            
+            entry = [ADCircuitBreakerEntry new];
+            _entries[host] = entry;
+        }
+        
+        previousState = entry.state;
+        
+        if (serverUnavailable)
+        {
+            entry.consecutiveFailures++;
+            
+            if (previousState == ADCircuitBreakerStateHalfOpen ||
+                (previousState == ADCircuitBreakerStateClosed && entry.consecutiveFailures >= self.failureThreshold))
+            {
+                entry.state = ADCircuitBreakerStateOpen;
+                entry.openedAt = [NSDate date];
+            }
+        }
+        else
+        {
+            entry.consecutiveFailures = 0;
+            entry.state = ADCircuitBreakerStateClosed;
+        }
+        
+        entry.probeInFlight = NO;
+        newState = entry.state;
+    }
+    
+    if (newState != previousState)
+    {
+        [self logState:newState host:host context:context];
+    }
+}
+
+- (void)recordNoResponseForHost:(NSString *)host
+{
+    if (!host)
+    {
+        return;
+    }
+    
+    @synchronized(self)
+    {
+        _entries[host].probeInFlight = NO;
+    }
+}
+
+- (ADCircuitBreakerState)stateForHost:(NSString *)host
+{
+    if (!host)
+    {
+        return ADCircuitBreakerStateClosed;
+    }
+    
+    @synchronized(self)
+    {
+        return _entries[host].state;
+    }
+}
+
+- (void)reset
+{
+    @synchronized(self)
+    {
+        [_entries removeAllObjects];
+    }
+}
+
+#pragma mark - Telemetry
+
++ (NSString *)stringForState:(ADCircuitBreakerState)state
+{
+    switch (state)
+    {
+        case ADCircuitBreakerStateClosed: return @"closed";
+        case ADCircuitBreakerStateOpen: return @"open";
+        case ADCircuitBreakerStateHalfOpen: return @"half_open";
+    }
+    
+    return nil;
+}
+
+- (void)logState:(ADCircuitBreakerState)state
+            host:(NSString *)host
+         context:(id<MSIDRequestContext>)context
+{
+    NSString *stateString = [ADCircuitBreaker stringForState:state];
+    
+    MSID_LOG_WARN(context, @"Circuit breaker for token endpoint is now %@", stateString);
+    MSID_LOG_WARN_PII(context, @"Circuit breaker for token endpoint %@ is now %@", host, stateString);
+    
+    NSString *telemetryRequestId = context.telemetryRequestId;
+    if (!telemetryRequestId)
+    {
+        return;
+    }
+    
+    [[MSIDTelemetry sharedInstance] startEvent:telemetryRequestId eventName:ADAL_TELEMETRY_EVENT_CIRCUIT_BREAKER];
+    
+    ADTelemetryAPIEvent *event = [[ADTelemetryAPIEvent alloc] initWithName:ADAL_TELEMETRY_EVENT_CIRCUIT_BREAKER
+                                                                   context:context];
+    [event setProperty:ADAL_TELEMETRY_KEY_CIRCUIT_BREAKER_HOST value:host];
+    [event setProperty:ADAL_TELEMETRY_KEY_CIRCUIT_BREAKER_STATE value:stateString];
+    
+    [[MSIDTelemetry sharedInstance] stopEvent:telemetryRequestId event:event];
+}
+
+@end
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "ADRetryPolicy.h"
+
+/*!
+    Point in time by which an acquireToken call has to be done. Shared by every network
+    request made on behalf of the call, each of which only gets what is left of the budget.
+ */
+@interface ADRequestDeadline : NSObject
+{
+    NSDate *_expiresOn;
+    id<ADRetryClock> _clock;
+}
+
+@property (readonly) NSDate *expiresOn;
+@property (readonly) id<ADRetryClock> clock;
+
+/*! Deadline timeout seconds from now according to the system clock. */
++ (ADRequestDeadline *)deadlineWithTimeout:(NSTimeInterval)timeout;
+
+- (id)initWithTimeout:(NSTimeInterval)timeout
+                clock:(id<ADRetryClock>)clock;
+
+/*! Seconds left until the deadline, 0 once it has passed. */
+- (NSTimeInterval)remainingTime;
+
+- (BOOL)isExpired;
+
+/*! NSURLErrorTimedOut error to fail requests with once the deadline has passed. */
+- (NSError *)expiredError;
+
+@end
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "ADRequestDeadline.h"
+
+@implementation ADRequestDeadline
+
+@synthesize expiresOn = _expiresOn;
+@synthesize clock = _clock;
+
++ (ADRequestDeadline *)deadlineWithTimeout:(NSTimeInterval)timeout
+{
+    return [[ADRequestDeadline alloc] initWithTimeout:timeout clock:[ADRetryPolicy systemClock]];
+}
+
+- (id)initWithTimeout:(NSTimeInterval)timeout
+                clock:(id<ADRetryClock>)clock
+{
+    if (!clock)
+    {
+        return nil;
+    }
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _clock = clock;
+    _expiresOn = [[clock now] dateByAddingTimeInterval:timeout];
+    
+    return self;
+}
+
+- (NSTimeInterval)remainingTime
+{
+    NSTimeInterval remaining = [_expiresOn timeIntervalSinceDate:[_clock now]];
+    return remaining > 0 ? remaining : 0;
+}
+
+- (BOOL)isExpired
+{
+    return [self remainingTime] <= 0;
+}
+
+- (NSError *)expiredError
+{
+    return [NSError errorWithDomain:NSURLErrorDomain
+                               code:NSURLErrorTimedOut
+                           userInfo:@{ NSLocalizedDescriptionKey : @"The deadline for the request has passed." }];
+}
+
+@end
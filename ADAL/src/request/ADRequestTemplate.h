@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/*!
+    Holds the URL-encoded parts of protocol messages that don't change between requests
+    made by the same ADAuthenticationContext for a given client ID and redirect URI
+    (client_id, redirect_uri, device ID and version parameters, haschrome).
+ 
+    Per request values are encoded once and spliced into a preallocated buffer around
+    the static segments.
+ */
+@interface ADRequestTemplate : NSObject
+
+@property (readonly) NSString *authority;
+@property (readonly) NSString *clientId;
+@property (readonly) NSString *redirectUri;
+
+- (instancetype)initWithAuthority:(NSString *)authority
+                         clientId:(NSString *)clientId
+                      redirectUri:(NSString *)redirectUri;
+
+/*!
+    Returns the start of the authorize URL, up to and including the haschrome parameter.
+    Callers append any additional query parameters to the returned string.
+ 
+    @param responseType The OAuth2 response type, e.g. "code"
+    @param resource     The resource the code is being requested for
+    @param state        The already encoded protocol state
+    @param loginHint    (Optional) The login hint to send to the server
+    @param prompt       (Optional) The prompt parameter to send to the server
+ */
+- (NSMutableString *)authorizeURLWithResponseType:(NSString *)responseType
+                                         resource:(NSString *)resource
+                                            state:(NSString *)state
+                                        loginHint:(NSString *)loginHint
+                                           prompt:(NSString *)prompt;
+
+/*!
+    URL form encodes the dictionary, the same way msidURLFormEncode does, reusing the
+    encoded client ID and redirect URI when the values match this template.
+ */
+- (NSString *)formEncodedStringFromDictionary:(NSDictionary<NSString *, NSString *> *)dictionary;
+
+/*!
+    Returns the UTF-8 form encoded body for the dictionary. See formEncodedStringFromDictionary:
+ */
+- (NSData *)formEncodedBodyFromDictionary:(NSDictionary<NSString *, NSString *> *)dictionary;
+
+@end
@@ -0,0 +1,184 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "ADRequestTemplate.h"
+#import "MSIDDeviceId.h"
+
+@implementation ADRequestTemplate
+{
+    // Encoded segments of the authorize URL
+    NSString *_authorizePrefix;
+    NSString *_clientIdSegment;
+    NSString *_redirectUriSegment;
+    
+    // Form encoded values reused in request bodies
+    NSString *_formEncodedClientId;
+    NSString *_formEncodedRedirectUri;
+}
+
+#pragma mark - Static segments
+
++ (NSString *)encodedDeviceIdSegment
+{
+    static NSString *s_encodedDeviceIdSegment = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s_encodedDeviceIdSegment = [NSString stringWithFormat:@"&%@", [[MSIDDeviceId deviceId] msidURLFormEncode]];
+    });
+    
+    return s_encodedDeviceIdSegment;
+}
+
++ (NSString *)formEncodeValue:(id)value
+{
+    NSString *stringValue = [value isKindOfClass:[NSUUID class]] ? [(NSUUID *)value UUIDString] : [value description];
+    return [[stringValue msidTrimmedString] msidUrlFormEncode];
+}
+
+#pragma mark - Init
+
+- (instancetype)initWithAuthority:(NSString *)authority
+                         clientId:(NSString *)clientId
+                      redirectUri:(NSString *)redirectUri
+{
+    self = [super init];
+    
+    if (self)
+    {
+        _authority = authority;
+        _clientId = clientId;
+        _redirectUri = redirectUri;
+        
+        _authorizePrefix = [NSString stringWithFormat:@"%@%@?%@=", authority, MSID_OAUTH2_AUTHORIZE_SUFFIX, MSID_OAUTH2_RESPONSE_TYPE];
+        _clientIdSegment = [NSString stringWithFormat:@"&%@=%@", MSID_OAUTH2_CLIENT_ID, [clientId msidUrlFormEncode]];
+        _redirectUriSegment = [NSString stringWithFormat:@"&%@=%@", MSID_OAUTH2_REDIRECT_URI, [redirectUri msidUrlFormEncode]];
+        
+        _formEncodedClientId = [ADRequestTemplate formEncodeValue:clientId];
+        _formEncodedRedirectUri = [ADRequestTemplate formEncodeValue:redirectUri];
+    }
+    
+    return self;
+}
+
+#pragma mark - Authorize URL
+
+- (NSMutableString *)authorizeURLWithResponseType:(NSString *)responseType
+                                         resource:(NSString *)resource
+                                            state:(NSString *)state
+                                        loginHint:(NSString *)loginHint
+                                           prompt:(NSString *)prompt
+{
+    NSString *encodedResource = [resource msidUrlFormEncode];
+    NSString *encodedLoginHint = [loginHint msidUrlFormEncode];
+    NSString *deviceIdSegment = [ADRequestTemplate encodedDeviceIdSegment];
+    
+    // Static segments, per request values and room for the parameter names
+    NSUInteger capacity = _authorizePrefix.length + _clientIdSegment.length + _redirectUriSegment.length + deviceIdSegment.length
+                        + responseType.length + encodedResource.length + state.length + encodedLoginHint.length + prompt.length + 128;
+    
+    NSMutableString *startUrl = [[NSMutableString alloc] initWithCapacity:capacity];
+    
+    [startUrl appendString:_authorizePrefix];
+    [startUrl appendString:responseType];
+    [startUrl appendString:_clientIdSegment];
+    [startUrl appendFormat:@"&%@=%@", MSID_OAUTH2_RESOURCE, encodedResource];
+    [startUrl appendString:_redirectUriSegment];
+    [startUrl appendFormat:@"&%@=%@", MSID_OAUTH2_STATE, state];
+    [startUrl appendString:deviceIdSegment];
+    
+    if (encodedLoginHint)
+    {
+        [startUrl appendFormat:@"&%@=%@", MSID_OAUTH2_LOGIN_HINT, encodedLoginHint];
+    }
+    
+    if (prompt)
+    {
+        //Force the server to ignore cookies, by specifying explicitly the prompt behavior:
+        [startUrl appendString:@"&prompt="];
+        [startUrl appendString:prompt];
+    }
+    
+    [startUrl appendString:@"&haschrome=1"]; //to hide back button in UI
+    
+    return startUrl;
+}
+
+#pragma mark - Form encoding
+
+- (NSString *)formEncodedStringFromDictionary:(NSDictionary<NSString *, NSString *> *)dictionary
+{
+    if (dictionary.count == 0)
+    {
+        return nil;
+    }
+    
+    NSUInteger capacity = 0;
+    for (NSString *key in dictionary)
+    {
+        // Encoding can grow a value, but most of what we send is already URL safe
+        capacity += key.length + [dictionary[key] description].length + 2;
+    }
+    
+    NSMutableString *encoded = [[NSMutableString alloc] initWithCapacity:capacity];
+    
+    for (NSString *key in dictionary)
+    {
+        id value = dictionary[key];
+        
+        if (encoded.length)
+        {
+            [encoded appendString:@"&"];
+        }
+        
+        [encoded appendString:[ADRequestTemplate formEncodeValue:key]];
+        
+        NSString *encodedValue = nil;
+        if ([key isEqualToString:MSID_OAUTH2_CLIENT_ID] && [value isEqual:_clientId])
+        {
+            encodedValue = _formEncodedClientId;
+        }
+        else if ([key isEqualToString:MSID_OAUTH2_REDIRECT_URI] && [value isEqual:_redirectUri])
+        {
+            encodedValue = _formEncodedRedirectUri;
+        }
+        else
+        {
+            encodedValue = [ADRequestTemplate formEncodeValue:value];
+        }
+        
+        if (![NSString msidIsStringNilOrBlank:encodedValue])
+        {
+            [encoded appendString:@"="];
+            [encoded appendString:encodedValue];
+        }
+    }
+    
+    return encoded;
+}
+
+- (NSData *)formEncodedBodyFromDictionary:(NSDictionary<NSString *, NSString *> *)dictionary
+{
+    return [[self formEncodedStringFromDictionary:dictionary] dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+@end
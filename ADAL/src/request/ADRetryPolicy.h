@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/*!
+    Source of time for ADRetryPolicy. Abstracted out so retry timing can be driven
+    deterministically.
+ */
+@protocol ADRetryClock <NSObject>
+
+- (NSDate *)now;
+- (void)dispatchAfter:(NSTimeInterval)delay queue:(dispatch_queue_t)queue block:(dispatch_block_t)block;
+
+@end
+
+/*!
+    Decides whether, and after how long, a failed ADWebAuthRequest gets sent again.
+    
+    Retries back off exponentially with full jitter, honor Retry-After when the server
+    sends one, and draw from a budget kept per endpoint so that a struggling endpoint
+    doesn't get hammered by every request in the process at once.
+ */
+@interface ADRetryPolicy : NSObject
+
+/*! Total number of times a request is sent, including the first one. Default is 2. */
+@property NSUInteger maxAttempts;
+
+/*! Upper bound of the first backoff, doubled for every further retry. Default is 0.5 seconds. */
+@property NSTimeInterval baseDelay;
+
+/*! Upper bound of any backoff. Default is 8 seconds. */
+@property NSTimeInterval maxDelay;
+
+/*! Retry-After values above this aren't waited for, the response goes back to the
+    caller as is. Default is 10 seconds. */
+@property NSTimeInterval maxRetryAfter;
+
+/*! When NO, requests that can't safely be sent twice (POSTs) are only retried when the server
+    says it didn't act on them (429, 503) or the connection was never made. Default is YES,
+    token requests are retried the same as GETs. */
+@property BOOL retryNonIdempotentRequests;
+
+/*! Number of retries each endpoint gets per retryBudgetInterval. Default is 10. */
+@property NSUInteger retryBudget;
+
+/*! Period over which the retry budget refills. Default is 60 seconds. */
+@property NSTimeInterval retryBudgetInterval;
+
+@property (strong) id<ADRetryClock> clock;
+
+/*! Returns a value in [0, 1) used to jitter the backoff. */
+@property (copy) double (^randomSource)(void);
+
+/*! The policy used by ADWebAuthRequest unless one is set on the request. */
++ (ADRetryPolicy *)defaultPolicy;
+
+/*! Clock backed by the system time and dispatch_after. */
++ (id<ADRetryClock>)systemClock;
+
+/*! YES for 429 and 5xx responses. */
+- (BOOL)shouldRetryStatusCode:(NSInteger)statusCode;
+
+/*! YES for connection errors that are likely to go away on their own (timeouts,
+    dropped connections). */
+- (BOOL)shouldRetryError:(NSError *)error;
+
+/*! -shouldRetryStatusCode:, narrowed for non-idempotent requests when
+    retryNonIdempotentRequests is off. */
+- (BOOL)shouldRetryStatusCode:(NSInteger)statusCode idempotent:(BOOL)idempotent;
+
+/*! -shouldRetryError:, narrowed for non-idempotent requests when
+    retryNonIdempotentRequests is off. */
+- (BOOL)shouldRetryError:(NSError *)error idempotent:(BOOL)idempotent;
+
+/*!
+    Works out whether another attempt should be made, and if so when.
+    
+    @param delay        The time to wait before the next attempt
+    @param attempts     The number of attempts made so far
+    @param endpoint     Key of the endpoint the retry budget is charged to
+    @param retryAfter   Value of the Retry-After header, if any
+    
+    @return YES if the request should be retried, in which case one retry is taken
+            out of the endpoint's budget.
+ */
+- (BOOL)retryDelay:(NSTimeInterval *)delay
+       forAttempts:(NSUInteger)attempts
+          endpoint:(NSString *)endpoint
+        retryAfter:(NSString *)retryAfter;
+
+/*! Parses a Retry-After value, either delta-seconds or an HTTP-date. Returns a
+    negative value if the header is missing or can't be parsed. */
+- (NSTimeInterval)intervalFromRetryAfter:(NSString *)retryAfter;
+
+/*! Refills the budget of every endpoint. */
+- (void)resetRetryBudgets;
+
+@end
@@ -0,0 +1,282 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "ADRetryPolicy.h"
+
+@interface ADRetrySystemClock : NSObject <ADRetryClock>
+
+@end
+
+@implementation ADRetrySystemClock
+
+- (NSDate *)now
+{
+    return [NSDate date];
+}
+
+- (void)dispatchAfter:(NSTimeInterval)delay queue:(dispatch_queue_t)queue block:(dispatch_block_t)block
+{
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), queue, block);
+}
+
+@end
+
+// Token bucket holding the retries an endpoint has left
+@interface ADRetryBudget : NSObject
+{
+@public
+    double _tokens;
+    NSDate *_lastRefill;
+}
+
+@end
+
+@implementation ADRetryBudget
+
+@end
+
+@implementation ADRetryPolicy
+{
+    NSMutableDictionary<NSString *, ADRetryBudget *> *_budgets;
+}
+
++ (ADRetryPolicy *)defaultPolicy
+{
+    static ADRetryPolicy *s_defaultPolicy = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s_defaultPolicy = [ADRetryPolicy new];
+    });
+    
+    return s_defaultPolicy;
+}
+
++ (id<ADRetryClock>)systemClock
+{
+    static ADRetrySystemClock *s_systemClock = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s_systemClock = [ADRetrySystemClock new];
+    });
+    
+    return s_systemClock;
+}
+
+- (id)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _maxAttempts = 2;
+    _baseDelay = 0.5;
+    _maxDelay = 8;
+    _maxRetryAfter = 10;
+    _retryNonIdempotentRequests = YES;
+    _retryBudget = 10;
+    _retryBudgetInterval = 60;
+    _clock = [ADRetryPolicy systemClock];
+    _randomSource = ^double { return (double)arc4random() / ((double)UINT32_MAX + 1); };
+    _budgets = [NSMutableDictionary new];
+    
+    return self;
+}
+
+#pragma mark - Classification
+
+- (BOOL)shouldRetryStatusCode:(NSInteger)statusCode
+{
+    return statusCode == 429 || (statusCode >= 500 && statusCode <= 599);
+}
+
+- (BOOL)shouldRetryError:(NSError *)error
+{
+    if (![error.domain isEqualToString:NSURLErrorDomain])
+    {
+        return NO;
+    }
+    
+    switch (error.code)
+    {
+        case NSURLErrorTimedOut:
+        case NSURLErrorCannotConnectToHost:
+        case NSURLErrorNetworkConnectionLost:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+- (BOOL)shouldRetryStatusCode:(NSInteger)statusCode idempotent:(BOOL)idempotent
+{
+    if (idempotent || self.retryNonIdempotentRequests)
+    {
+        return [self shouldRetryStatusCode:statusCode];
+    }
+    
+    // The server didn't act on the request
+    return statusCode == 429 || statusCode == 503;
+}
+
+- (BOOL)shouldRetryError:(NSError *)error idempotent:(BOOL)idempotent
+{
+    if (idempotent || self.retryNonIdempotentRequests)
+    {
+        return [self shouldRetryError:error];
+    }
+    
+    // A timeout or a dropped connection might come after the server processed the request,
+    // only a connection that was never made is safe to retry
+    return [error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCannotConnectToHost;
+}
+
+#pragma mark - Scheduling
+
+- (BOOL)retryDelay:(NSTimeInterval *)delay
+       forAttempts:(NSUInteger)attempts
+          endpoint:(NSString *)endpoint
+        retryAfter:(NSString *)retryAfter
+{
+    if (attempts >= self.maxAttempts)
+    {
+        return NO;
+    }
+    
+    NSTimeInterval retryAfterInterval = [self intervalFromRetryAfter:retryAfter];
+    if (retryAfterInterval > self.maxRetryAfter)
+    {
+        return NO;
+    }
+    
+    // Full jitter: anywhere between 0 and the exponential cap, so clients that failed
+    // together don't come back together
+    double exponent = attempts > 0 ? (double)(attempts - 1) : 0;
+    NSTimeInterval cap = MIN(self.maxDelay, self.baseDelay * pow(2, exponent));
+    NSTimeInterval backoff = cap * self.randomSource();
+    
+    if (![self consumeBudgetForEndpoint:endpoint])
+    {
+        return NO;
+    }
+    
+    if (delay)
+    {
+        // Retry-After is a floor, the jitter still spreads out the clients that honor it
+        *delay = retryAfterInterval > 0 ? retryAfterInterval + backoff : backoff;
+    }
+    
+    return YES;
+}
+
+- (NSTimeInterval)intervalFromRetryAfter:(NSString *)retryAfter
+{
+    if (!retryAfter)
+    {
+        return -1;
+    }
+    
+    NSString *value = [retryAfter stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    
+    NSScanner *scanner = [NSScanner scannerWithString:value];
+    NSInteger seconds = 0;
+    if ([scanner scanInteger:&seconds] && scanner.isAtEnd)
+    {
+        return seconds >= 0 ? (NSTimeInterval)seconds : -1;
+    }
+    
+    NSDate *date = [[ADRetryPolicy httpDateFormatter] dateFromString:value];
+    if (!date)
+    {
+        return -1;
+    }
+    
+    return MAX(0, [date timeIntervalSinceDate:[self.clock now]]);
+}
+
++ (NSDateFormatter *)httpDateFormatter
+{
+    static NSDateFormatter *s_formatter = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // RFC 7231 IMF-fixdate, e.g. "Wed, 21 Oct 2015 07:28:00 GMT"
+        s_formatter = [NSDateFormatter new];
+        s_formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        s_formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        s_formatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz";
+    });
+    
+    return s_formatter;
+}
+
+#pragma mark - Retry budget
+
+- (BOOL)consumeBudgetForEndpoint:(NSString *)endpoint
+{
+    if (!endpoint)
+    {
+        endpoint = @"";
+    }
+    
+    NSDate *now = [self.clock now];
+    double capacity = (double)self.retryBudget;
+    
+    @synchronized(self)
+    {
+        ADRetryBudget *budget = _budgets[endpoint];
+        if (!budget)
+        {
+            budget = [ADRetryBudget new];
+            budget->_tokens = capacity;
+            budget->_lastRefill = now;
+            _budgets[endpoint] = budget;
+        }
+        else if (self.retryBudgetInterval > 0)
+        {
+            NSTimeInterval elapsed = [now timeIntervalSinceDate:budget->_lastRefill];
+            if (elapsed > 0)
+            {
+                budget->_tokens = MIN(capacity, budget->_tokens + elapsed * capacity / self.retryBudgetInterval);
+                budget->_lastRefill = now;
+            }
+        }
+        
+        if (budget->_tokens < 1)
+        {
+            return NO;
+        }
+        
+        budget->_tokens -= 1;
+        return YES;
+    }
+}
+
+- (void)resetRetryBudgets
+{
+    @synchronized(self)
+    {
+        [_budgets removeAllObjects];
+    }
+}
+
+@end
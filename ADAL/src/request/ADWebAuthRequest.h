@@ -23,12 +23,16 @@
 
 #import "ADWebRequest.h"
 
+@class ADRequestTemplate;
+@class ADRetryPolicy;
+
 @interface ADWebAuthRequest : ADWebRequest
 {
     NSDate* _startTime;
     BOOL _retryIfServerError;
     BOOL _returnRawResponse;
     BOOL _acceptOnlyOKResponse;
+    NSUInteger _attempts;
     
     NSMutableDictionary* _responseDictionary;
     
@@ -42,8 +46,35 @@
 @property BOOL acceptOnlyOKResponse;
 
 @property (readonly) NSDate* startTime;
+
+/*! Policy deciding on retries when retryIfServerError is set. Defaults to
+    +[ADRetryPolicy defaultPolicy] */
+@property (strong) ADRetryPolicy *retryPolicy;
+
+/*! Number of times the request has been sent, retries included */
+@property (readonly) NSUInteger attempts;
+
+/*!
+    (Optional) If set on a GET request and no response has arrived after this many seconds,
+    an identical request is sent alongside. The first successful response is used and the
+    other request is cancelled, a failure is only reported once both requests have failed.
+    Only meant for idempotent requests. Default is 0 (no hedging).
+ */
+@property NSTimeInterval hedgeDelay;
 @property (copy) NSDictionary<NSString *, NSString *> * requestDictionary;
 
+/*!
+    (Optional) Template used to encode the request dictionary. Lets requests made for the
+    same context reuse the already encoded client ID and redirect URI.
+ */
+@property (strong) ADRequestTemplate *requestTemplate;
+
 - (void)sendRequest:(ADWebResponseCallback)completionBlock;
 
+/*!
+    Asks the retry policy whether the request should be sent again and if so schedules
+    the resend. Returns NO if the caller should go ahead and fail the request instead.
+ */
+- (BOOL)retryWithRetryAfter:(NSString *)retryAfter;
+
 @end
@@ -27,6 +27,10 @@
 #import "ADClientMetrics.h"
 #import "ADWebResponse.h"
 #import "ADPkeyAuthHelper.h"
+#import "ADRequestTemplate.h"
+#import "ADRetryPolicy.h"
+#import "ADRequestDeadline.h"
+#import "ADHelpers.h"
 
 @implementation ADWebAuthRequest
 
@@ -34,6 +38,7 @@
 @synthesize retryIfServerError = _retryIfServerError;
 @synthesize startTime = _startTime;
 @synthesize acceptOnlyOKResponse = _acceptOnlyOKResponse;
+@synthesize attempts = _attempts;
 
 - (id)initWithURL:(NSURL *)url
           context:(id<MSIDRequestContext>)context
@@ -53,25 +58,43 @@
 #endif
     
     _retryIfServerError = YES;
+    _retryPolicy = [ADRetryPolicy defaultPolicy];
     
     return self;
 }
 
 - (void)sendRequest:(ADWebResponseCallback)completionBlock
 {
+    NSString *encodedDictionary = _requestTemplate ? [_requestTemplate formEncodedStringFromDictionary:_requestDictionary] : [_requestDictionary msidURLFormEncode];
+    
     if ([self isGetRequest] && [_requestDictionary allKeys].count > 0)
     {
-        NSString* newURL = [NSString stringWithFormat:@"%@?%@", [_requestURL absoluteString], [_requestDictionary msidURLFormEncode]];
+        NSString* newURL = [NSString stringWithFormat:@"%@?%@", [_requestURL absoluteString], encodedDictionary];
         _requestURL = [NSURL URLWithString:newURL];
     }
     else
     {
-        [self setBody:[[_requestDictionary msidURLFormEncode] dataUsingEncoding:NSUTF8StringEncoding]];
+        [self setBody:[encodedDictionary dataUsingEncoding:NSUTF8StringEncoding]];
     }
     
+    // Everything we talk to speaks JSON, so there's no point buffering an HTML error page
+    _expectsJSONResponse = !_returnRawResponse;
+    
     _startTime = [NSDate new];
+    _attempts = 1;
     [[ADClientMetrics getInstance] addClientMetrics:_requestHeaders endpoint:[_requestURL absoluteString]];
     
+    if (_hedgeDelay > 0 && [self isGetRequest])
+    {
+        [self sendHedgedRequest:completionBlock];
+        return;
+    }
+    
+    [self sendWithCallback:completionBlock];
+}
+
+- (void)sendWithCallback:(ADWebResponseCallback)completionBlock
+{
     [self send:^( NSError *error, ADWebResponse *webResponse )
     {
         if (error)
@@ -85,5 +108,142 @@
     }];
 }
 
+#pragma mark - Hedging
+
+- (ADWebAuthRequest *)hedgeRequest
+{
+    // _requestURL already carries the query at this point, so there's no dictionary to encode
+    ADWebAuthRequest *request = [[[self class] alloc] initWithURL:_requestURL context:self];
+    [request addToHeadersFromDictionary:_requestHeaders];
+    request.isGetRequest = YES;
+    request.returnRawResponse = _returnRawResponse;
+    request.acceptOnlyOKResponse = _acceptOnlyOKResponse;
+    request.retryIfServerError = _retryIfServerError;
+    request.retryPolicy = _retryPolicy;
+    request.maxResponseSize = _maxResponseSize;
+    
+    return request;
+}
+
+- (void)sendHedgedRequest:(ADWebResponseCallback)completionBlock
+{
+    NSObject *lock = [NSObject new];
+    __block BOOL completed = NO;
+    __block NSUInteger outstanding = 1;
+    __block ADWebAuthRequest *hedgeRequest = nil;
+    __block ADAuthenticationError *firstError = nil;
+    __block NSMutableDictionary *firstErrorResponse = nil;
+    
+    // Only a successful response wins the race. A failure is held back while the other request
+    // is still out, and the first one is reported if both requests fail.
+    void (^handleResult)(BOOL, ADAuthenticationError *, NSMutableDictionary *) = ^(BOOL fromHedge, ADAuthenticationError *error, NSMutableDictionary *response)
+    {
+        ADWebAuthRequest *loser = nil;
+        
+        @synchronized(lock)
+        {
+            if (completed)
+            {
+                return;
+            }
+            
+            --outstanding;
+            
+            if (error)
+            {
+                if (!firstError)
+                {
+                    firstError = error;
+                    firstErrorResponse = response;
+                }
+                
+                if (outstanding > 0)
+                {
+                    return;
+                }
+                
+                error = firstError;
+                response = firstErrorResponse;
+            }
+            else
+            {
+                loser = fromHedge ? self : hedgeRequest;
+            }
+            
+            completed = YES;
+        }
+        
+        [loser cancel];
+        completionBlock(error, response);
+    };
+    
+    [self sendWithCallback:^(ADAuthenticationError *error, NSMutableDictionary *response)
+     {
+         handleResult(NO, error, response);
+     }];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_hedgeDelay * NSEC_PER_SEC)), [ADHelpers globalQueueForQOSClass:_qosClass], ^{
+        ADWebAuthRequest *hedge = nil;
+        
+        @synchronized(lock)
+        {
+            if (completed)
+            {
+                return;
+            }
+            
+            hedge = [self hedgeRequest];
+            hedgeRequest = hedge;
+            ++outstanding;
+        }
+        
+        MSID_LOG_INFO(self, @"No response after %.3f seconds, sending hedged request", self.hedgeDelay);
+        
+        [hedge sendRequest:^(ADAuthenticationError *error, NSMutableDictionary *response)
+         {
+             handleResult(YES, error, response);
+             [hedge invalidate];
+         }];
+    });
+}
+
+#pragma mark - Retries
+
+- (BOOL)retryWithRetryAfter:(NSString *)retryAfter
+{
+    if (!_retryIfServerError || !_retryPolicy)
+    {
+        return NO;
+    }
+    
+    // The budget is shared by everything hitting the same endpoint, regardless of query
+    NSString *endpoint = [NSString stringWithFormat:@"%@://%@%@", _requestURL.scheme, _requestURL.host, _requestURL.path];
+    
+    NSTimeInterval delay = 0;
+    if (![_retryPolicy retryDelay:&delay forAttempts:_attempts endpoint:endpoint retryAfter:retryAfter])
+    {
+        return NO;
+    }
+    
+    // No point in waiting for a retry that can't make it before the deadline
+    if (_deadline && delay >= [_deadline remainingTime])
+    {
+        MSID_LOG_INFO(self, @"Not retrying request, %.2f seconds left until the deadline", [_deadline remainingTime]);
+        return NO;
+    }
+    
+    ++_attempts;
+    MSID_LOG_INFO(self, @"Retrying request in %.2f seconds (attempt %lu)", delay, (unsigned long)_attempts);
+    
+    // The retry goes on the global queue of the call's class, a block can't run below the
+    // class of the queue it is submitted to.
+    [_retryPolicy.clock dispatchAfter:delay
+                                queue:[ADHelpers globalQueueForQOSClass:_qosClass]
+                                block:^{
+                                    [self resend];
+                                }];
+    
+    return YES;
+}
 
 @end
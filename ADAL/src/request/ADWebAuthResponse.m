@@ -25,8 +25,10 @@
 #import "ADWebAuthResponse.h"
 #import "ADWebResponse.h"
 #import "ADWebAuthRequest.h"
+#import "ADRetryPolicy.h"
 #import "ADWorkplaceJoinConstants.h"
 #import "ADPKeyAuthHelper.h"
+#import "ADChallengeHeaderScanner.h"
 #import "ADClientMetrics.h"
 #import "NSString+MSIDTelemetryExtensions.h"
 #import "MSIDTelemetryEventStrings.h"
@@ -37,6 +39,11 @@
              request:(ADWebAuthRequest *)request
           completion:(ADWebResponseCallback)completionBlock
 {
+    if ([request.retryPolicy shouldRetryError:error idempotent:request.isGetRequest] && [request retryWithRetryAfter:nil])
+    {
+        return;
+    }
+    
     ADWebAuthResponse* response = [ADWebAuthResponse new];
     response->_request = request;
     
@@ -71,105 +78,38 @@
     }
     
     NSMutableDictionary* params = [NSMutableDictionary new];
-    NSUInteger strLength = [authHeader length];
-    NSRange currentRange = NSMakeRange(0, strLength);
-    NSCharacterSet* whiteChars = [NSCharacterSet whitespaceAndNewlineCharacterSet];
-    NSCharacterSet* alphaNum = [NSCharacterSet alphanumericCharacterSet];
+    ADChallengeHeaderScanner scanner;
+    ADChallengeHeaderScannerInit(&scanner, authHeader);
+    ADChallengeHeaderElement element;
+    ADChallengeHeaderScanResult result;
     
-    while (currentRange.location < strLength)
+    while ((result = ADChallengeHeaderScanElement(&scanner, &element)) == AD_CHALLENGE_HEADER_ELEMENT)
     {
-        // Eat up any whitepace at the beginning
-        while (currentRange.location < strLength && [whiteChars characterIsMember:[authHeader characterAtIndex:currentRange.location]])
-        {
-            ++currentRange.location;
-            --currentRange.length;
-        }
-        
-        if (currentRange.location == strLength)
-        {
-            return params;
-        }
-        
-        if (![alphaNum characterIsMember:[authHeader characterAtIndex:currentRange.location]])
-        {
-            // malformed string
-            return nil;
-        }
-        
-        // Find the key
-        NSUInteger found = [authHeader rangeOfString:@"=" options:0 range:currentRange].location;
-        // If there are no keys left then exit out
-        if (found == NSNotFound)
+        if (element.empty)
         {
-            // If there still is string left that means it's malformed
-            if (currentRange.length > 0)
+            // Only a trailing comma is allowed
+            if (!element.last)
             {
                 return nil;
             }
-            
-            // Otherwise we're at the end, return params
-            return params;
+            continue;
         }
-        NSUInteger length = found - currentRange.location;
-        NSString* key = [authHeader substringWithRange:NSMakeRange(currentRange.location, length)];
-        
-        // don't want the '='
-        ++length;
-        currentRange.location += length;
-        currentRange.length -= length;
-        
-        NSString* value = nil;
-        
         
-        if ([authHeader characterAtIndex:currentRange.location] == '"')
+        // malformed string
+        if (element.scheme.location != NSNotFound || element.name.location == NSNotFound)
         {
-            ++currentRange.location;
-            --currentRange.length;
-            
-            found = currentRange.location;
-            
-            do {
-                NSRange range = NSMakeRange(found, strLength - found);
-                found = [authHeader rangeOfString:@"\"" options:0 range:range].location;
-            } while (found != NSNotFound && [authHeader characterAtIndex:found-1] == '\\');
-            
-            // If we couldn't find a matching closing quote then we have a malformed string and return NULL
-            if (found == NSNotFound)
-            {
-                return nil;
-            }
-            
-            length = found - currentRange.location;
-            value = [authHeader substringWithRange:NSMakeRange(currentRange.location, length)];
-            
-            ++length;
-            currentRange.location += length;
-            currentRange.length -= length;
-            
-            // find the next comma
-            found = [authHeader rangeOfString:@"," options:0 range:currentRange].location;
-            if (found != NSNotFound)
-            {
-                length = found - currentRange.location;
-            }
-            
+            return nil;
         }
-        else
+        
+        unsigned char first = (unsigned char)scanner.bytes[element.name.location];
+        if (first < 0x80 && !isalnum(first))
         {
-            found = [authHeader rangeOfString:@"," options:0 range:currentRange].location;
-            // If we didn't find the comma that means we're at the end of the list
-            if (found == NSNotFound)
-            {
-                length = currentRange.length;
-            }
-            else
-            {
-                length = found - currentRange.location;
-            }
-            
-            value = [authHeader substringWithRange:NSMakeRange(currentRange.location, length)];
+            return nil;
         }
         
+        NSString* key = ADChallengeHeaderString(&scanner, element.name);
+        NSString* value = ADChallengeHeaderString(&scanner, element.value);
+        
         NSString* existingValue = [params valueForKey:key];
         if (existingValue)
         {
@@ -179,12 +119,12 @@
         {
             [params setValue:value forKey:key];
         }
-        
-        ++length;
-        currentRange.location += length;
-        currentRange.length -= length;
     }
     
+    if (result == AD_CHALLENGE_HEADER_MALFORMED)
+    {
+        return nil;
+    }
     
     return params;
 }
@@ -255,13 +195,9 @@
         }
     }
     
-    if (_request.retryIfServerError && statusCode >= 500 && statusCode <= 599)
+    if ([_request.retryPolicy shouldRetryStatusCode:statusCode idempotent:_request.isGetRequest] &&
+        [_request retryWithRetryAfter:[webResponse.headers objectForKey:@"Retry-After"]])
     {
-        _request.retryIfServerError = NO;
-        //retry once after half second
-        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-            [_request resend];
-        });
         return;
     }
     
@@ -285,7 +221,7 @@
            completionBlock:(ADWebResponseCallback)completionBlock
 {
     NSError   *jsonError  = nil;
-    id         jsonObject = [NSJSONSerialization JSONObjectWithData:webResponse.body options:0 error:&jsonError];
+    id         jsonObject = [webResponse JSONObject:&jsonError];
     
     if (!jsonObject)
     {
@@ -302,8 +238,18 @@
         return;
     }
     
-    // Load the response
-    [_responseDictionary addEntriesFromDictionary:(NSDictionary*)jsonObject];
+    // Load the response. The parsed dictionary is shared with the web response, so the
+    // entries are added to a copy of it.
+    NSMutableDictionary *jsonDictionary = [jsonObject mutableCopy];
+    for (NSString *key in _responseDictionary)
+    {
+        // Values from the server take precedence, same as when the JSON was merged in
+        if (!jsonDictionary[key])
+        {
+            jsonDictionary[key] = _responseDictionary[key];
+        }
+    }
+    _responseDictionary = jsonDictionary;
     
     NSString *clientTelemetry = [webResponse headers][ADAL_CLIENT_TELEMETRY];
     
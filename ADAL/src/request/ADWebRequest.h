@@ -25,6 +25,8 @@
 
 @class ADWebRequest;
 @class ADWebResponse;
+@class ADRequestDeadline;
+@class ADCancellationHandle;
 
 typedef void (^ADWebResponseCallback)(ADAuthenticationError *, NSMutableDictionary *);
 
@@ -35,7 +37,9 @@ typedef void (^ADWebResponseCallback)(ADAuthenticationError *, NSMutableDictiona
     NSURLSession *_session;
     
     NSURL * _requestURL;
+    NSURL * _versionedURL;
     NSMutableDictionary* _requestHeaders;
+    NSDictionary * _correlationHeaders;
     NSData * _requestData;
     
     NSHTTPURLResponse * _response;
@@ -44,8 +48,19 @@ typedef void (^ADWebResponseCallback)(ADAuthenticationError *, NSMutableDictiona
     NSUUID * _correlationId;
     
     NSUInteger _timeout;
+    NSUInteger _maxResponseSize;
+    ADRequestDeadline * _deadline;
+    dispatch_source_t _deadlineTimer;
+    NSError * _deadlineError;
+    ADCancellationHandle * _cancellationHandle;
+    qos_class_t _qosClass;
+    
+    BOOL _expectsJSONResponse;
+    BOOL _discardResponseBody;
+    NSError * _responseSizeError;
     
     BOOL _isGetRequest;
+    BOOL _cancelled;
     
     NSString* _telemetryRequestId;
     
@@ -55,6 +70,24 @@ typedef void (^ADWebResponseCallback)(ADAuthenticationError *, NSMutableDictiona
 @property (strong, readonly, nonatomic) NSURL               *URL;
 @property (strong)                      NSData              *body;
 @property (nonatomic)                   NSUInteger           timeout;
+/*! Largest response body that will be buffered, 0 means unbounded. Defaults to
+    ADAuthenticationSettings.maxResponseSize */
+@property (nonatomic)                   NSUInteger           maxResponseSize;
+/*! When set, a response whose Content-Type isn't JSON is cut off as soon as the
+    headers arrive and handed back with the status and headers but an empty body. */
+@property (nonatomic)                   BOOL                 expectsJSONResponse;
+/*! Deadline of the call this request is made for. The request timeout only bounds the
+    time between packets, so a timer cancels the request once the deadline passes and it
+    fails with NSURLErrorTimedOut. A request sent after the deadline fails without going
+    out. Picked up from the context when it has one. */
+@property (strong)                      ADRequestDeadline   *deadline;
+/*! Handle of the call this request is made for, cancelling it cancels the request.
+    Picked up from the context when it has one. */
+@property (strong)                      ADCancellationHandle *cancellationHandle;
+/*! QoS class of the call this request is made for. Sets the task priority and the class
+    the session delegate callbacks and retries run at. Picked up from the context when it
+    has one. */
+@property (readonly)                    qos_class_t          qosClass;
 @property BOOL isGetRequest;
 @property (readonly) NSUUID *correlationId;
 @property (readonly) NSString *telemetryRequestId;
@@ -70,6 +103,10 @@ typedef void (^ADWebResponseCallback)(ADAuthenticationError *, NSMutableDictiona
 - (void)addToHeadersFromDictionary:(NSDictionary *)headers;
 - (void)setAuthorizationHeader:(NSString *)header;
 
+/*! The timeout the next attempt gets sent with: the configured timeout, cut down to
+    what is left until the deadline if there is one. */
+- (NSTimeInterval)requestTimeout;
+
 /*!
     Resends a request. Note, this will cause the completionHandler previously set
     in -send: to be hit again. As such this method should only be called from
@@ -77,6 +114,12 @@ typedef void (^ADWebResponseCallback)(ADAuthenticationError *, NSMutableDictiona
  */
 - (void)resend;
 
+/*!
+    Cancels the request. The completionHandler set in -send: is still called, with
+    NSURLErrorCancelled, unless the request has been invalidated.
+ */
+- (void)cancel;
+
 /*!
     Invalidates session object and nils the completionHandler.
     Caller must invoke this method once it's done with the session.
@@ -35,6 +35,8 @@
 #import "ADWebResponse.h"
 #import "MSIDAadAuthorityCache.h"
 #import "MSIDDeviceId.h"
+#import "ADRequestDeadline.h"
+#import "ADCancellationHandle+Internal.h"
 
 
 @interface ADWebRequest ()
@@ -50,6 +52,11 @@
 
 @synthesize URL      = _requestURL;
 @synthesize timeout  = _timeout;
+@synthesize maxResponseSize = _maxResponseSize;
+@synthesize expectsJSONResponse = _expectsJSONResponse;
+@synthesize deadline = _deadline;
+@synthesize cancellationHandle = _cancellationHandle;
+@synthesize qosClass = _qosClass;
 @synthesize isGetRequest = _isGetRequest;
 @synthesize correlationId = _correlationId;
 @synthesize telemetryRequestId = _telemetryRequestId;
@@ -71,6 +78,9 @@
         }
         _requestData = [body copy];
         
+        // Content-Length only depends on the body, so format it here rather than on every send
+        [_requestHeaders setValue:[NSString stringWithFormat:@"%ld", (unsigned long)_requestData.length] forKey:@"Content-Length"];
+        
         // Add default HTTP Headers to the request: Expect
         // Note that we don't bother with Expect because iOS does not support it
         //[_requestHeaders setValue:@"100-continue" forKey:@"Expect"];
@@ -79,6 +89,21 @@
 
 #pragma mark - Initialization
 
+/*!
+    Device, SKU and version headers sent with every request. These don't change
+    for the lifetime of the process, so they're computed once and shared.
+ */
++ (NSDictionary *)defaultHeaders
+{
+    static NSDictionary *s_defaultHeaders = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s_defaultHeaders = [[MSIDDeviceId deviceId] copy];
+    });
+    
+    return s_defaultHeaders;
+}
+
 - (id)initWithURL:(NSURL *)requestURL
           context:(id<MSIDRequestContext>)context
 {
@@ -92,15 +117,49 @@
     
     // Default timeout for ADWebRequest is 30 seconds
     _timeout           = [[ADAuthenticationSettings sharedInstance] requestTimeOut];
+    _maxResponseSize   = [[ADAuthenticationSettings sharedInstance] maxResponseSize];
     
     _correlationId     = context.correlationId;
     
+    if (_correlationId)
+    {
+        _correlationHeaders = @{
+                                MSID_OAUTH2_CORRELATION_ID_REQUEST:@"true",
+                                MSID_OAUTH2_CORRELATION_ID_REQUEST_VALUE:[_correlationId UUIDString]
+                                };
+    }
+    
     _telemetryRequestId = context.telemetryRequestId;
     
     _logComponent       = context.logComponent;
     
+    if ([(id)context respondsToSelector:@selector(deadline)])
+    {
+        _deadline = [(id)context deadline];
+    }
+    
+    if ([(id)context respondsToSelector:@selector(cancellationHandle)])
+    {
+        _cancellationHandle = [(id)context cancellationHandle];
+    }
+    
+    if ([(id)context respondsToSelector:@selector(qosClass)])
+    {
+        _qosClass = [(id)context qosClass];
+    }
+    
+    // Delegate callbacks run at the class of the call rather than whatever the
+    // session's default queue gets
+    NSOperationQueue *delegateQueue = nil;
+    if (_qosClass != QOS_CLASS_UNSPECIFIED)
+    {
+        delegateQueue = [NSOperationQueue new];
+        delegateQueue.maxConcurrentOperationCount = 1;
+        delegateQueue.qualityOfService = (NSQualityOfService)_qosClass;
+    }
+    
     NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
-    _session = [NSURLSession sessionWithConfiguration:configuration delegate:self delegateQueue:nil];
+    _session = [NSURLSession sessionWithConfiguration:configuration delegate:self delegateQueue:delegateQueue];
     
     return self;
 }
@@ -111,68 +170,219 @@
     // Cleanup
     _response       = nil;
     _responseData   = nil;
-
-    _task           = nil;
+    _responseSizeError = nil;
+    _discardResponseBody = NO;
+    
+    // -cancel and the deadline timer can come in on any thread
+    @synchronized(self)
+    {
+        [self stopDeadlineTimer];
+        _task = nil;
+    }
     
     [self stopTelemetryEvent:error response:response];
-    _completionHandler(error, response);
+    
+    // The request might have been invalidated while a cancelled task was winding down
+    if (_completionHandler)
+    {
+        _completionHandler(error, response);
+    }
 }
 
 - (void)send:(void (^)(NSError *, ADWebResponse *))completionHandler
 {
     _completionHandler = [completionHandler copy];
-    _response          = nil;
-    _responseData      = [[NSMutableData alloc] init];
     
     [self send];
 }
 
 - (void)resend
 {
-    _response          = nil;
-    _responseData      = [[NSMutableData alloc] init];
-
     [self send];
 }
 
 - (void)send
 {
+    // The response buffer is sized once the response headers tell us how much is coming
+    _response          = nil;
+    _responseData      = nil;
+    _responseSizeError = nil;
+    _discardResponseBody = NO;
+    
     [[MSIDTelemetry sharedInstance] startEvent:_telemetryRequestId eventName:MSID_TELEMETRY_EVENT_HTTP_REQUEST];
-    [_requestHeaders addEntriesFromDictionary:[MSIDDeviceId deviceId]];
-    //Correlation id:
-    if (_correlationId)
+    
+    if ([self isCancelled])
+    {
+        [self completeAsyncWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+        return;
+    }
+    
+    if ([_deadline isExpired])
     {
-        [_requestHeaders addEntriesFromDictionary:
-         @{
-           MSID_OAUTH2_CORRELATION_ID_REQUEST:@"true",
-           MSID_OAUTH2_CORRELATION_ID_REQUEST_VALUE:[_correlationId UUIDString]
-           }];
+        MSID_LOG_WARN(self, @"Request deadline has passed, not sending request");
+        [self completeAsyncWithError:[_deadline expiredError]];
+        return;
     }
-    // If there is request data, then set the Content-Length header
-    if ( _requestData != nil )
+    
+    // Compose the headers from the shared immutable parts. Device and correlation headers
+    // take precedence over anything the caller added, same as before.
+    NSMutableDictionary *headers = [[NSMutableDictionary alloc] initWithCapacity:_requestHeaders.count + [ADWebRequest defaultHeaders].count + 2];
+    [headers addEntriesFromDictionary:_requestHeaders];
+    [headers addEntriesFromDictionary:[ADWebRequest defaultHeaders]];
+    if (_correlationHeaders)
     {
-        [_requestHeaders setValue:[NSString stringWithFormat:@"%ld", (unsigned long)_requestData.length] forKey:@"Content-Length"];
+        [headers addEntriesFromDictionary:_correlationHeaders];
     }
     
-    NSURL* requestURL = [ADHelpers addClientVersionToURL:_requestURL];
-    requestURL = [[MSIDAadAuthorityCache sharedInstance] networkUrlForAuthority:requestURL context:self];
+    if (!_versionedURL)
+    {
+        _versionedURL = [ADHelpers addClientVersionToURL:_requestURL];
+    }
+    
+    NSURL* requestURL = [[MSIDAadAuthorityCache sharedInstance] networkUrlForAuthority:_versionedURL context:self];
     
     NSMutableURLRequest *request = [[NSMutableURLRequest alloc] initWithURL:requestURL
                                                                 cachePolicy:NSURLRequestReloadIgnoringCacheData
-                                                            timeoutInterval:_timeout];
+                                                            timeoutInterval:[self requestTimeout]];
     
     request.HTTPMethod          = _isGetRequest ? @"GET" : @"POST";
-    request.allHTTPHeaderFields = _requestHeaders;
+    request.allHTTPHeaderFields = headers;
     request.HTTPBody            = _requestData;
     
     [ADURLProtocol addContext:self toRequest:request];
     
-    _task = [_session dataTaskWithRequest:request];
-    [_task resume];
+    NSURLSessionDataTask *task = [_session dataTaskWithRequest:request];
+    task.priority = [ADHelpers taskPriorityForQOSClass:_qosClass];
+    
+    @synchronized(self)
+    {
+        _task = task;
+        _deadlineError = nil;
+        [self startDeadlineTimerForTask:task];
+    }
+    
+    // Cancels the task right away if the handle got cancelled in the meantime
+    [_cancellationHandle addWebRequest:self];
+    
+    // A -cancel that came in before _task was set had nothing to cancel, the task would
+    // go out regardless
+    @synchronized(self)
+    {
+        if (_cancelled)
+        {
+            [task cancel];
+        }
+    }
+    
+    [task resume];
+}
+
+- (BOOL)isCancelled
+{
+    @synchronized(self)
+    {
+        if (_cancelled)
+        {
+            return YES;
+        }
+    }
+    
+    return [_cancellationHandle isCancelled];
+}
+
+// Callers expect the completion handler to run after -send: returns, same as when the
+// request goes out
+- (void)completeAsyncWithError:(NSError *)error
+{
+    dispatch_async([ADHelpers globalQueueForQOSClass:_qosClass], ^{
+        [self completeWithError:error andResponse:nil];
+    });
+}
+
+#pragma mark - Deadline
+
+// The timer fires on a global queue while the delegate queue completes the request, so
+// _deadlineTimer and _deadlineError are only touched while holding the lock
+- (void)startDeadlineTimerForTask:(NSURLSessionDataTask *)task
+{
+    if (!_deadline)
+    {
+        return;
+    }
+    
+    __weak ADWebRequest *weakSelf = self;
+    
+    _deadlineTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, [ADHelpers globalQueueForQOSClass:_qosClass]);
+    dispatch_source_set_timer(_deadlineTimer,
+                              dispatch_time(DISPATCH_TIME_NOW, (int64_t)([_deadline remainingTime] * NSEC_PER_SEC)),
+                              DISPATCH_TIME_FOREVER,
+                              (uint64_t)(0.1 * NSEC_PER_SEC));
+    dispatch_source_set_event_handler(_deadlineTimer, ^{
+        [weakSelf deadlinePassedForTask:task];
+    });
+    dispatch_resume(_deadlineTimer);
+}
+
+// Has to be called while holding the lock
+- (void)stopDeadlineTimer
+{
+    if (_deadlineTimer)
+    {
+        dispatch_source_cancel(_deadlineTimer);
+        _deadlineTimer = nil;
+    }
+}
+
+- (void)deadlinePassedForTask:(NSURLSessionDataTask *)task
+{
+    @synchronized(self)
+    {
+        // The timer might be left over from an attempt that has completed
+        if (task != _task)
+        {
+            return;
+        }
+        
+        _deadlineError = [_deadline expiredError];
+    }
+    
+    MSID_LOG_WARN(self, @"Request deadline has passed, cancelling request");
+    [task cancel];
+}
+
+- (NSTimeInterval)requestTimeout
+{
+    NSTimeInterval timeout = (NSTimeInterval)_timeout;
+    
+    if (_deadline)
+    {
+        timeout = MIN(timeout, [_deadline remainingTime]);
+    }
+    
+    return timeout;
+}
+
+- (void)cancel
+{
+    NSURLSessionDataTask *task = nil;
+    
+    // The task is swapped out on the delegate queue, hold on to it while cancelling
+    @synchronized(self)
+    {
+        _cancelled = YES;
+        task = _task;
+    }
+    
+    [task cancel];
 }
 
 - (void)invalidate
 {
+    @synchronized(self)
+    {
+        [self stopDeadlineTimer];
+    }
+    
     [_session finishTasksAndInvalidate];
     _completionHandler = nil;
 }
@@ -191,7 +401,28 @@
     (void)session;
     (void)task;
     
-    if (error == nil)
+    // Taken once, a deadline passing from here on doesn't change how the request ends
+    NSError *deadlineError = nil;
+    @synchronized(self)
+    {
+        deadlineError = _deadlineError;
+    }
+    
+    if (_responseSizeError)
+    {
+        // We cancelled the task ourselves, report why rather than the cancellation
+        [self completeWithError:_responseSizeError andResponse:nil];
+    }
+    else if (deadlineError && [error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled)
+    {
+        [self completeWithError:deadlineError andResponse:nil];
+    }
+    else if (_discardResponseBody)
+    {
+        ADWebResponse* response = [[ADWebResponse alloc] initWithResponse:_response data:[NSData data]];
+        [self completeWithError:nil andResponse:response];
+    }
+    else if (error == nil)
     {
         //
         // NOTE: There is a race condition between this method and the challenge handling methods
@@ -215,13 +446,54 @@
     (void)dataTask;
   
     _response = (NSHTTPURLResponse *)response;
+    
+    // expectedContentLength is NSURLResponseUnknownLength (-1) when the server doesn't send Content-Length
+    long long expectedLength = response.expectedContentLength;
+    if (_maxResponseSize && expectedLength > (long long)_maxResponseSize)
+    {
+        MSID_LOG_WARN(self, @"Response of %lld bytes exceeds the %lu byte limit, aborting.", expectedLength, (unsigned long)_maxResponseSize);
+        _responseSizeError = [self responseSizeError];
+        completionHandler(NSURLSessionResponseCancel);
+        return;
+    }
+    
+    if (_expectsJSONResponse && response.MIMEType && ![ADWebRequest isJSONMIMEType:response.MIMEType])
+    {
+        // Nobody is going to look at an HTML error page, don't bother downloading it. The status
+        // code and headers are still handed back so the caller can act on those.
+        MSID_LOG_WARN(self, @"Expected a JSON response but received %@, discarding the body.", response.MIMEType);
+        _discardResponseBody = YES;
+        completionHandler(NSURLSessionResponseCancel);
+        return;
+    }
+    
+    _responseData = [[NSMutableData alloc] initWithCapacity:expectedLength > 0 ? (NSUInteger)expectedLength : 0];
     completionHandler(NSURLSessionResponseAllow);
 }
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data
 {
     (void)session;
-    (void)dataTask;
+    
+    if (_discardResponseBody || _responseSizeError)
+    {
+        return;
+    }
+    
+    // Content-Length can be missing or wrong (chunked encoding), so keep checking as the data arrives
+    if (_maxResponseSize && _responseData.length + data.length > _maxResponseSize)
+    {
+        MSID_LOG_WARN(self, @"Response exceeded the %lu byte limit, aborting.", (unsigned long)_maxResponseSize);
+        _responseSizeError = [self responseSizeError];
+        _responseData = nil;
+        [dataTask cancel];
+        return;
+    }
+    
+    if (!_responseData)
+    {
+        _responseData = [[NSMutableData alloc] initWithCapacity:data.length];
+    }
     
     [_responseData appendData:data];
 }
@@ -235,7 +507,7 @@
     NSURL* requestURL = [request URL];
     NSURL* modifiedURL = [ADHelpers addClientVersionToURL:requestURL];
     
-    if (modifiedURL == requestURL)
+    if ([modifiedURL isEqual:requestURL])
     {
         completionHandler(request);
         return;
@@ -266,7 +538,16 @@
         [event setHttpResponseCode:[NSString stringWithFormat: @"%ld", (long)[response statusCode]]];
     }
     
-    [event setOAuthErrorCodeFromResponseData:response.body];
+    // Reuse the parsed body, ADWebAuthResponse will look at the same object afterwards
+    NSDictionary *jsonObject = [response JSONObject:nil];
+    if ([jsonObject isKindOfClass:[NSDictionary class]])
+    {
+        NSString *oauthErrorCode = jsonObject[MSID_OAUTH2_ERROR];
+        if ([oauthErrorCode isKindOfClass:[NSString class]])
+        {
+            [event setProperty:MSID_TELEMETRY_KEY_OAUTH_ERROR_CODE value:oauthErrorCode];
+        }
+    }
     [event setClientTelemetry:[response headers][ADAL_CLIENT_TELEMETRY]];
     
     [event setHttpRequestQueryParams:_requestURL.query];
@@ -283,4 +564,21 @@
 {
     [_requestHeaders setObject:header forKey:@"Authorization"];
 }
+
+#pragma mark - Response validation
+
++ (BOOL)isJSONMIMEType:(NSString *)mimeType
+{
+    // Covers application/json as well as structured suffixes like application/jrd+json (WebFinger)
+    return [mimeType rangeOfString:@"json" options:NSCaseInsensitiveSearch].location != NSNotFound;
+}
+
+- (NSError *)responseSizeError
+{
+    NSString *description = [NSString stringWithFormat:@"Response exceeded the maximum allowed size of %lu bytes.", (unsigned long)_maxResponseSize];
+    return [NSError errorWithDomain:NSURLErrorDomain
+                               code:NSURLErrorDataLengthExceedsMaximum
+                           userInfo:@{ NSLocalizedDescriptionKey : description }];
+}
+
 @end
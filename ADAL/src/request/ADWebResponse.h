@@ -25,10 +25,20 @@
 {
     NSHTTPURLResponse *_response;
     NSData            *_body;
+    
+    BOOL               _jsonParsed;
+    id                 _jsonObject;
+    NSError           *_jsonError;
 }
 
 @property (strong, readonly) NSData * body;
 
+/*!
+    The body deserialized as JSON. The body is only parsed the first time this is called,
+    telemetry, error handling and token parsing all share the result, so it is immutable.
+ */
+- (id)JSONObject:(NSError * __autoreleasing *)error;
+
 - (id)initWithResponse:(NSHTTPURLResponse *)response data:(NSData *)data;
 
 - (NSURL*)URL;
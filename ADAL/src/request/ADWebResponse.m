@@ -64,4 +64,25 @@
     return [_response URL];
 }
 
+- (id)JSONObject:(NSError * __autoreleasing *)error
+{
+    @synchronized (self)
+    {
+        if (!_jsonParsed)
+        {
+            NSError *jsonError = nil;
+            _jsonObject = _body ? [NSJSONSerialization JSONObjectWithData:_body options:0 error:&jsonError] : nil;
+            _jsonError = jsonError;
+            _jsonParsed = YES;
+        }
+        
+        if (!_jsonObject && error)
+        {
+            *error = _jsonError;
+        }
+        
+        return _jsonObject;
+    }
+}
+
 @end
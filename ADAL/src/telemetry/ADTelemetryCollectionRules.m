@@ -78,6 +78,7 @@ static NSDictionary *_telemetryEventRules;
                              MSID_TELEMETRY_KEY_SPE_INFO: @(CollectOnly),
                              MSID_TELEMETRY_KEY_WIPE_APP: @(CollectOnly),
                              MSID_TELEMETRY_KEY_WIPE_TIME: @(CollectOnly),
+                             ADAL_TELEMETRY_KEY_CIRCUIT_BREAKER_HOST: @(CollectOnly),
                              
                              // Collect and count
                              MSID_TELEMETRY_KEY_UI_EVENT_COUNT: @(CollectAndCount),
@@ -98,7 +99,9 @@ static NSDictionary *_telemetryEventRules;
                              MSID_TELEMETRY_KEY_RT_AGE: @(CollectAndUpdate),
                              // UIEvent
                              MSID_TELEMETRY_KEY_USER_CANCEL: @(CollectAndUpdate),
-                             MSID_TELEMETRY_KEY_NTLM_HANDLED: @(CollectAndUpdate)
+                             MSID_TELEMETRY_KEY_NTLM_HANDLED: @(CollectAndUpdate),
+                             // CircuitBreakerEvent
+                             ADAL_TELEMETRY_KEY_CIRCUIT_BREAKER_STATE: @(CollectAndUpdate)
                              };
 }
 
@@ -35,12 +35,6 @@ static BOOL _challengeCancelled = NO;
 static NSMutableURLRequest *_challengeUrl = nil;
 static NSURLSession *_session = nil;
 
-+ (void)load
-{
-    [ADURLProtocol registerHandler:self
-                        authMethod:NSURLAuthenticationMethodNTLM];
-}
-
 + (void)setCancellationUrl:(NSString*) url
 {
     if (_cancellationUrl == url)
@@ -25,11 +25,6 @@
 
 @implementation ADNegotiateHandler
 
-+ (void)load
-{
-    [ADURLProtocol registerHandler:self authMethod:NSURLAuthenticationMethodNegotiate];
-}
-
 + (void)resetHandler {}
 
 + (BOOL)handleChallenge:(NSURLAuthenticationChallenge *)challenge
@@ -42,13 +42,20 @@ typedef void (^ChallengeCompletionHandler)(NSURLSessionAuthChallengeDisposition
 @end
 
 //Intercepts HTTPS protocol for the application in order to allow
-//NTLM with client-authentication. The class is not thread-safe.
+//NTLM with client-authentication. Handlers can be registered from any thread,
+//each protocol instance keeps the end URL and telemetry event that were
+//registered when it got created.
 @interface ADURLProtocol : NSURLProtocol <NSURLSessionTaskDelegate, NSURLSessionDataDelegate>
 {
     NSURLSessionDataTask *_dataTask;
     id<MSIDRequestContext> _context;
+    NSString *_endURL;
+    MSIDTelemetryUIEvent *_telemetryEvent;
 }
 
+/*! Registers the handlers ADAL ships with, safe to call more than once. */
++ (void)registerDefaultHandlers;
+
 + (void)registerHandler:(Class<ADAuthMethodHandler>)handler
              authMethod:(NSString *)authMethod;
 
@@ -25,18 +25,31 @@
 #import "ADURLProtocol.h"
 #import "ADLogger.h"
 #import "ADNTLMHandler.h"
+#import "ADNegotiateHandler.h"
+#if !TARGET_OS_IPHONE
+#import "ADClientCertAuthHandler.h"
+#endif
 #import "ADCustomHeaderHandler.h"
 #import "MSIDTelemetryUIEvent.h"
 #import "MSIDTelemetryEventStrings.h"
 #import "ADURLSessionDemux.h"
 #import "ADAuthorityUtils.h"
 
-static NSMutableDictionary *s_handlers      = nil;
+// Immutable snapshot of the registered handlers, keyed by lowercased auth method. Registering
+// a handler swaps in a new snapshot, so looking one up doesn't take a lock. Replaced snapshots
+// are never released as a reader could still be using them, there is only ever a handful of
+// registrations.
+static void * volatile s_handlers           = NULL;
 static NSString *s_endURL                   = nil;
 static MSIDTelemetryUIEvent *s_telemetryEvent = nil;
 
 static NSString *s_kADURLProtocolPropertyKey  = @"ADURLProtocol";
 
+static NSDictionary *_handlers(void)
+{
+    return (__bridge NSDictionary *)__atomic_load_n(&s_handlers, __ATOMIC_ACQUIRE);
+}
+
 static id<MSIDRequestContext> _reqContext(NSURLRequest* request)
 {
     return [NSURLProtocol propertyForKey:@"context" inRequest:request];
@@ -51,6 +64,20 @@ static id<MSIDRequestContext> _reqContext(NSURLRequest* request)
 
 @synthesize context = _context;
 
++ (void)registerDefaultHandlers
+{
+    // The built-in handlers get registered on first use of the protocol instead of each
+    // handler doing it from +load at image load time.
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        [self addHandler:[ADNTLMHandler class] authMethod:NSURLAuthenticationMethodNTLM];
+        [self addHandler:[ADNegotiateHandler class] authMethod:NSURLAuthenticationMethodNegotiate];
+#if !TARGET_OS_IPHONE
+        [self addHandler:[ADClientCertAuthHandler class] authMethod:NSURLAuthenticationMethodClientCertificate];
+#endif
+    });
+}
+
 + (void)registerHandler:(id)handler
              authMethod:(NSString *)authMethod
 {
@@ -59,43 +86,54 @@ static id<MSIDRequestContext> _reqContext(NSURLRequest* request)
         return;
     }
     
+    // Make sure a handler registered here isn't replaced by a default one later on
+    [self registerDefaultHandlers];
+    [self addHandler:handler authMethod:authMethod];
+}
+
++ (void)addHandler:(id)handler
+        authMethod:(NSString *)authMethod
+{
     authMethod = [authMethod lowercaseString];
     
+    // Writers still have to be serialized so that no registration gets lost
     @synchronized(self)
     {
-        static dispatch_once_t once;
-        dispatch_once(&once, ^{
-            s_handlers = [NSMutableDictionary new];
-        });
+        NSMutableDictionary *handlers = [NSMutableDictionary dictionaryWithDictionary:_handlers()];
+        [handlers setValue:handler forKey:authMethod];
         
-        [s_handlers setValue:handler forKey:authMethod];
+        __atomic_store_n(&s_handlers, (void *)CFBridgingRetain([handlers copy]), __ATOMIC_RELEASE);
     }
 }
 
 + (BOOL)registerProtocol:(NSString *)endURL
           telemetryEvent:(MSIDTelemetryUIEvent *)telemetryEvent
 {
-    if (s_endURL!=endURL)
+    [self registerDefaultHandlers];
+    
+    @synchronized(self)
     {
         s_endURL = endURL.lowercaseString;
+        s_telemetryEvent = telemetryEvent;
     }
-    s_telemetryEvent = telemetryEvent;
     return [NSURLProtocol registerClass:self];
 }
 
 + (void)unregisterProtocol
 {
     [NSURLProtocol unregisterClass:self];
-    s_endURL = nil;
-    s_telemetryEvent = nil;
     
     @synchronized(self)
     {
-        for (NSString *key in s_handlers)
-        {
-            Class<ADAuthMethodHandler> handler = [s_handlers objectForKey:key];
-            [handler resetHandler];
-        }
+        s_endURL = nil;
+        s_telemetryEvent = nil;
+    }
+    
+    NSDictionary *handlers = _handlers();
+    for (NSString *key in handlers)
+    {
+        Class<ADAuthMethodHandler> handler = [handlers objectForKey:key];
+        [handler resetHandler];
     }
 }
 
@@ -126,6 +164,27 @@ static id<MSIDRequestContext> _reqContext(NSURLRequest* request)
 }
 
 #pragma mark - Overrides
+
+- (instancetype)initWithRequest:(NSURLRequest *)request
+                 cachedResponse:(NSCachedURLResponse *)cachedResponse
+                         client:(id<NSURLProtocolClient>)client
+{
+    if (!(self = [super initWithRequest:request cachedResponse:cachedResponse client:client]))
+    {
+        return nil;
+    }
+    
+    // Hold on to the state of the session that was registered when the request got picked up,
+    // so a later registration doesn't change it under this request.
+    @synchronized([ADURLProtocol class])
+    {
+        _endURL = s_endURL;
+        _telemetryEvent = s_telemetryEvent;
+    }
+    
+    return self;
+}
+
 + (BOOL)canInitWithRequest:(NSURLRequest *)request
 {
     // If we've already handled this request, don't pick it up again
@@ -212,7 +271,7 @@ willPerformHTTPRedirection:(NSHTTPURLResponse *)response
     
     if ([request.URL.scheme.lowercaseString isEqualToString:@"http"])
     {
-        if ([request.URL.absoluteString.lowercaseString hasPrefix:s_endURL])
+        if (_endURL && [request.URL.absoluteString.lowercaseString hasPrefix:_endURL])
         {
             // In this case we want to create an NSURLError so we can intercept the URL in the webview
             // delegate, while still forcing the connection to cancel. This error is the same one the
@@ -269,11 +328,7 @@ didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge
                    authMethod, (long)challenge.previousFailureCount);
     
     BOOL handled = NO;
-    Class<ADAuthMethodHandler> handler = nil;
-    @synchronized ([self class])
-    {
-        handler = [s_handlers objectForKey:authMethod];
-    }
+    Class<ADAuthMethodHandler> handler = [_handlers() objectForKey:authMethod];
     
     handled = [handler handleChallenge:challenge
                                session:session
@@ -290,7 +345,7 @@ didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge
     
     if ([authMethod caseInsensitiveCompare:NSURLAuthenticationMethodNTLM] == NSOrderedSame)
     {
-        [s_telemetryEvent setNtlm:MSID_TELEMETRY_VALUE_YES];
+        [_telemetryEvent setNtlm:MSID_TELEMETRY_VALUE_YES];
     }
 }
 
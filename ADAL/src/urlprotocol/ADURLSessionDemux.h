@@ -27,8 +27,16 @@
 
 - (instancetype)initWithConfiguration:(NSURLSessionConfiguration *)configuration delegateQueue:(NSOperationQueue *)delegateQueue;
 
+/*! Creates a task whose delegate callbacks get delivered on the thread calling this method,
+ that thread has to run its run loop. */
 - (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request delegate:(id<NSURLSessionDataDelegate>)delegate;
 
+/*! Creates a task whose delegate callbacks get delivered on the given serial queue instead
+ of a thread, for clients that don't have a run loop to hop to. */
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                                     delegate:(id<NSURLSessionDataDelegate>)delegate
+                                        queue:(dispatch_queue_t)queue;
+
 @property (atomic, copy,   readonly) NSURLSessionConfiguration* configuration;
 @property (atomic, strong, readonly) NSURLSession *session;
 
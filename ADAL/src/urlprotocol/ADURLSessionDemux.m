@@ -22,38 +22,65 @@
 // THE SOFTWARE.
 
 #import "ADURLSessionDemux.h"
-#import <objc/runtime.h>
 
 @interface ADURLSessionDemuxTaskInfo : NSObject
+{
+    NSData *_pendingData;
+    BOOL _pendingDataCoalesced;
+    BOOL _pendingDataScheduled;
+}
 
-- (instancetype)initWithTask:(NSURLSessionDataTask *)task delegate:(id<NSURLSessionDataDelegate>)delegate;
+- (instancetype)initWithTask:(NSURLSessionDataTask *)task
+                     session:(NSURLSession *)session
+                    delegate:(id<NSURLSessionDataDelegate>)delegate
+                       queue:(dispatch_queue_t)queue;
 
 @property (atomic, strong) NSURLSessionDataTask *task;
+@property (atomic, weak) NSURLSession *session;
 @property (atomic, strong) id<NSURLSessionDataDelegate> delegate;
 @property (atomic, strong) NSThread *thread;
+@property (atomic, strong) dispatch_queue_t queue;
 
 - (void)performBlock:(dispatch_block_t)block;
 
+/*! Queues the data up for the delegate. Chunks that arrive while an earlier one is still
+ waiting to be delivered get appended to it, so the client gets one callback for them. */
+- (void)enqueueData:(NSData *)data;
+
 - (void)invalidate;
 
 @end
 
+static void ADDeliverPendingData(void *context);
+
 @implementation ADURLSessionDemuxTaskInfo
 
-- (instancetype)initWithTask:(NSURLSessionDataTask *)task delegate:(id<NSURLSessionDataDelegate>)delegate
+- (instancetype)initWithTask:(NSURLSessionDataTask *)task
+                     session:(NSURLSession *)session
+                    delegate:(id<NSURLSessionDataDelegate>)delegate
+                       queue:(dispatch_queue_t)queue
 {
     self = [super init];
     if (self != nil)
     {
         self->_task = task;
+        self->_session = session;
         self->_delegate = delegate;
-        self->_thread = [NSThread currentThread];
+        self->_queue = queue;
+        self->_thread = queue ? nil : [NSThread currentThread];
     }
     return self;
 }
 
 - (void)performBlock:(dispatch_block_t)block
 {
+    dispatch_queue_t queue = self.queue;
+    if (queue)
+    {
+        dispatch_async(queue, block);
+        return;
+    }
+    
     [self performSelector:@selector(performBlockOnClientThread:)
                  onThread:self.thread
                withObject:[block copy]
@@ -65,24 +92,93 @@
     block();
 }
 
+- (void)enqueueData:(NSData *)data
+{
+    @synchronized (self)
+    {
+        if (!_pendingData)
+        {
+            _pendingData = data;
+        }
+        else
+        {
+            // Don't append to the chunk handed to us by the session, it isn't ours
+            if (!_pendingDataCoalesced)
+            {
+                _pendingData = [_pendingData mutableCopy];
+                _pendingDataCoalesced = YES;
+            }
+            
+            [(NSMutableData *)_pendingData appendData:data];
+        }
+        
+        if (_pendingDataScheduled)
+        {
+            return;
+        }
+        
+        _pendingDataScheduled = YES;
+    }
+    
+    // Schedule the delivery without wrapping it in a block, the task info carries everything
+    // needed to deliver the data.
+    dispatch_queue_t queue = self.queue;
+    if (queue)
+    {
+        dispatch_async_f(queue, (__bridge_retained void *)self, ADDeliverPendingData);
+        return;
+    }
+    
+    [self performSelector:@selector(deliverPendingData)
+                 onThread:self.thread
+               withObject:nil
+            waitUntilDone:NO];
+}
+
+- (void)deliverPendingData
+{
+    NSData *data = nil;
+    @synchronized (self)
+    {
+        data = _pendingData;
+        _pendingData = nil;
+        _pendingDataCoalesced = NO;
+        _pendingDataScheduled = NO;
+    }
+    
+    id<NSURLSessionDataDelegate> delegate = self.delegate;
+    if (data && delegate)
+    {
+        [delegate URLSession:self.session dataTask:self.task didReceiveData:data];
+    }
+}
+
 - (void)invalidate
 {
     self.delegate = nil;
     self.thread = nil;
+    self.queue = nil;
 }
 
 @end
 
+static void ADDeliverPendingData(void *context)
+{
+    ADURLSessionDemuxTaskInfo *taskInfo = (__bridge_transfer ADURLSessionDemuxTaskInfo *)context;
+    [taskInfo deliverPendingData];
+}
+
 
 @interface ADURLSessionDemux() <NSURLSessionDataDelegate>
+{
+    NSMutableDictionary<NSNumber *, ADURLSessionDemuxTaskInfo *> *_taskInfoByTaskId;
+}
 
 @end
 
 
 @implementation ADURLSessionDemux
 
-static const void *s_taskKey = &s_taskKey;
-
 - (instancetype)initWithConfiguration:(NSURLSessionConfiguration *)configuration
                         delegateQueue:(NSOperationQueue *)delegateQueue
 {
@@ -90,6 +186,7 @@ static const void *s_taskKey = &s_taskKey;
     if (self)
     {
         self->_configuration = [configuration copy];
+        self->_taskInfoByTaskId = [NSMutableDictionary new];
         self->_session = [NSURLSession sessionWithConfiguration:self->_configuration delegate:self delegateQueue:delegateQueue];
     }
     
@@ -97,24 +194,45 @@ static const void *s_taskKey = &s_taskKey;
 }
 
 - (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request delegate:(id<NSURLSessionDataDelegate>)delegate
+{
+    return [self dataTaskWithRequest:request delegate:delegate queue:nil];
+}
+
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                                     delegate:(id<NSURLSessionDataDelegate>)delegate
+                                        queue:(dispatch_queue_t)queue
 {
     NSURLSessionDataTask *task;
     ADURLSessionDemuxTaskInfo *taskInfo;
     
     task = [self.session dataTaskWithRequest:request];
     taskInfo = [[ADURLSessionDemuxTaskInfo alloc] initWithTask:task
-                                                      delegate:delegate];
+                                                       session:self.session
+                                                      delegate:delegate
+                                                         queue:queue];
     
-    objc_setAssociatedObject(task, s_taskKey, taskInfo, OBJC_ASSOCIATION_RETAIN);
+    @synchronized (_taskInfoByTaskId)
+    {
+        _taskInfoByTaskId[@(task.taskIdentifier)] = taskInfo;
+    }
     
     return task;
 }
 
 - (ADURLSessionDemuxTaskInfo *)taskInfoForTask:(NSURLSessionTask *)task
 {
-    ADURLSessionDemuxTaskInfo *result;
-    result = objc_getAssociatedObject(task, s_taskKey);
-    return result;
+    @synchronized (_taskInfoByTaskId)
+    {
+        return _taskInfoByTaskId[@(task.taskIdentifier)];
+    }
+}
+
+- (void)removeTaskInfoForTask:(NSURLSessionTask *)task
+{
+    @synchronized (_taskInfoByTaskId)
+    {
+        [_taskInfoByTaskId removeObjectForKey:@(task.taskIdentifier)];
+    }
 }
 
 #pragma mark - NSURLSession delegates
@@ -165,7 +283,10 @@ didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge
     ADURLSessionDemuxTaskInfo *taskInfo;
     
     taskInfo = [self taskInfoForTask:task];
+    [self removeTaskInfoForTask:task];
     
+    // Any data still waiting to be delivered was scheduled before this, so it reaches the
+    // delegate first.
     if ([taskInfo.delegate respondsToSelector:@selector(URLSession:task:didCompleteWithError:)])
     {
         [taskInfo performBlock:^{
@@ -201,14 +322,13 @@ didReceiveResponse:(NSURLResponse *)response
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data
 {
+    (void)session;
     ADURLSessionDemuxTaskInfo *    taskInfo;
     
     taskInfo = [self taskInfoForTask:dataTask];
     if ([taskInfo.delegate respondsToSelector:@selector(URLSession:dataTask:didReceiveData:)])
     {
-        [taskInfo performBlock:^{
-            [taskInfo.delegate URLSession:session dataTask:dataTask didReceiveData:data];
-        }];
+        [taskInfo enqueueData:data];
     }
 }
 
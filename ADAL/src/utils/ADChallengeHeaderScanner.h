@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+/*! One of the comma separated elements of a WWW-Authenticate style challenge header, e.g.
+ 'Bearer authorization_uri="https://login.windows.net/common"', 'resource_id="something"'
+ or 'TFS-Federated'. All of the ranges are byte ranges into the UTF-8 header, strings only
+ get created for the ones asked for with ADChallengeHeaderString(). */
+typedef struct
+{
+    /*! The auth scheme starting a new challenge, location is NSNotFound if there is none */
+    NSRange scheme;
+    /*! The auth parameter name, location is NSNotFound if there is none */
+    NSRange name;
+    /*! The auth parameter value, without the quotes */
+    NSRange value;
+    /*! YES if the value was a quoted string */
+    BOOL quoted;
+    /*! YES if there was nothing but whitespace in the element */
+    BOOL empty;
+    /*! YES if this is the last element of the header */
+    BOOL last;
+} ADChallengeHeaderElement;
+
+typedef enum
+{
+    AD_CHALLENGE_HEADER_ELEMENT,
+    AD_CHALLENGE_HEADER_END,
+    AD_CHALLENGE_HEADER_MALFORMED,
+} ADChallengeHeaderScanResult;
+
+/*! Scans a challenge header one element at a time without copying it. The header string
+ has to outlive the scanner. */
+typedef struct
+{
+    const char *bytes;
+    size_t length;
+    size_t position;
+    BOOL done;
+} ADChallengeHeaderScanner;
+
+void ADChallengeHeaderScannerInit(ADChallengeHeaderScanner *scanner, NSString *header);
+
+/*! Scans the next element of the header into element. Returns AD_CHALLENGE_HEADER_END once
+ all of the elements have been scanned, and AD_CHALLENGE_HEADER_MALFORMED if the header
+ can't be parsed, in which case scanning should stop. */
+ADChallengeHeaderScanResult ADChallengeHeaderScanElement(ADChallengeHeaderScanner *scanner, ADChallengeHeaderElement *element);
+
+/*! Returns YES if the range of the header holds exactly the given ASCII string. */
+BOOL ADChallengeHeaderRangeEquals(const ADChallengeHeaderScanner *scanner, NSRange range, const char *string);
+
+/*! Creates the string for a range of the header. */
+NSString *ADChallengeHeaderString(const ADChallengeHeaderScanner *scanner, NSRange range);
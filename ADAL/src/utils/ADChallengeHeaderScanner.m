@@ -0,0 +1,210 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "ADChallengeHeaderScanner.h"
+
+static inline BOOL ADIsWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static inline BOOL ADIsTokenChar(char c)
+{
+    return c != ',' && c != '=' && c != '"' && !ADIsWhitespace(c);
+}
+
+static inline void ADSkipWhitespace(ADChallengeHeaderScanner *scanner)
+{
+    while (scanner->position < scanner->length && ADIsWhitespace(scanner->bytes[scanner->position]))
+    {
+        ++scanner->position;
+    }
+}
+
+static inline BOOL ADAtEnd(ADChallengeHeaderScanner *scanner)
+{
+    return scanner->position >= scanner->length;
+}
+
+static inline char ADCurrent(ADChallengeHeaderScanner *scanner)
+{
+    return scanner->bytes[scanner->position];
+}
+
+static NSRange ADScanToken(ADChallengeHeaderScanner *scanner)
+{
+    size_t start = scanner->position;
+    while (!ADAtEnd(scanner) && ADIsTokenChar(ADCurrent(scanner)))
+    {
+        ++scanner->position;
+    }
+    
+    return NSMakeRange(start, scanner->position - start);
+}
+
+// Scans the parameter value following the "=", returns NO if it's an unterminated quoted string
+static BOOL ADScanValue(ADChallengeHeaderScanner *scanner, ADChallengeHeaderElement *element)
+{
+    ADSkipWhitespace(scanner);
+    
+    if (!ADAtEnd(scanner) && ADCurrent(scanner) == '"')
+    {
+        size_t start = ++scanner->position;
+        while (!ADAtEnd(scanner) && ADCurrent(scanner) != '"')
+        {
+            // Skip over escaped characters, the value is handed back as is
+            scanner->position += (ADCurrent(scanner) == '\\') ? 2 : 1;
+        }
+        
+        if (ADAtEnd(scanner))
+        {
+            return NO;
+        }
+        
+        element->value = NSMakeRange(start, scanner->position - start);
+        element->quoted = YES;
+        ++scanner->position;
+        return YES;
+    }
+    
+    // Unquoted values run up to the next comma, minus any trailing whitespace
+    size_t start = scanner->position;
+    size_t end = start;
+    while (!ADAtEnd(scanner) && ADCurrent(scanner) != ',')
+    {
+        if (!ADIsWhitespace(ADCurrent(scanner)))
+        {
+            end = scanner->position + 1;
+        }
+        ++scanner->position;
+    }
+    
+    element->value = NSMakeRange(start, end - start);
+    return YES;
+}
+
+void ADChallengeHeaderScannerInit(ADChallengeHeaderScanner *scanner, NSString *header)
+{
+    scanner->bytes = header.UTF8String;
+    scanner->length = scanner->bytes ? strlen(scanner->bytes) : 0;
+    scanner->position = 0;
+    scanner->done = (scanner->bytes == NULL);
+}
+
+ADChallengeHeaderScanResult ADChallengeHeaderScanElement(ADChallengeHeaderScanner *scanner, ADChallengeHeaderElement *element)
+{
+    if (scanner->done)
+    {
+        return AD_CHALLENGE_HEADER_END;
+    }
+    
+    element->scheme = NSMakeRange(NSNotFound, 0);
+    element->name = NSMakeRange(NSNotFound, 0);
+    element->value = NSMakeRange(NSNotFound, 0);
+    element->quoted = NO;
+    element->empty = NO;
+    element->last = NO;
+    
+    ADSkipWhitespace(scanner);
+    
+    if (ADAtEnd(scanner) || ADCurrent(scanner) == ',')
+    {
+        element->empty = YES;
+    }
+    else
+    {
+        NSRange token = ADScanToken(scanner);
+        if (token.length == 0)
+        {
+            return AD_CHALLENGE_HEADER_MALFORMED;
+        }
+        
+        ADSkipWhitespace(scanner);
+        
+        if (!ADAtEnd(scanner) && ADCurrent(scanner) != ',' && ADCurrent(scanner) != '=')
+        {
+            // The token was an auth scheme followed by its first parameter
+            element->scheme = token;
+            token = ADScanToken(scanner);
+            if (token.length == 0)
+            {
+                return AD_CHALLENGE_HEADER_MALFORMED;
+            }
+            
+            ADSkipWhitespace(scanner);
+            if (ADAtEnd(scanner) || ADCurrent(scanner) != '=')
+            {
+                return AD_CHALLENGE_HEADER_MALFORMED;
+            }
+        }
+        
+        if (!ADAtEnd(scanner) && ADCurrent(scanner) == '=')
+        {
+            element->name = token;
+            ++scanner->position;
+            if (!ADScanValue(scanner, element))
+            {
+                return AD_CHALLENGE_HEADER_MALFORMED;
+            }
+        }
+        else
+        {
+            // Auth scheme on its own
+            element->scheme = token;
+        }
+        
+        ADSkipWhitespace(scanner);
+    }
+    
+    if (ADAtEnd(scanner))
+    {
+        element->last = YES;
+        scanner->done = YES;
+        return AD_CHALLENGE_HEADER_ELEMENT;
+    }
+    
+    if (ADCurrent(scanner) != ',')
+    {
+        return AD_CHALLENGE_HEADER_MALFORMED;
+    }
+    
+    ++scanner->position;
+    return AD_CHALLENGE_HEADER_ELEMENT;
+}
+
+BOOL ADChallengeHeaderRangeEquals(const ADChallengeHeaderScanner *scanner, NSRange range, const char *string)
+{
+    size_t length = strlen(string);
+    return range.location != NSNotFound && range.length == length && memcmp(scanner->bytes + range.location, string, length) == 0;
+}
+
+NSString *ADChallengeHeaderString(const ADChallengeHeaderScanner *scanner, NSRange range)
+{
+    if (range.location == NSNotFound)
+    {
+        return nil;
+    }
+    
+    return [[NSString alloc] initWithBytes:scanner->bytes + range.location length:range.length encoding:NSUTF8StringEncoding];
+}
@@ -35,7 +35,22 @@
                                         context:(NSString *)context
                                    symmetricKey:(NSData *)symmetricKey;
 
-+ (NSString *)JSONFromDictionary:(NSDictionary *)dictionary;
+/*! Serializes the header and payload as minified JSON and returns a buffer holding the
+ base64url encoded JWS signing input, "<header>.<payload>". The signature gets appended to
+ the same buffer with appendJWSSignature:length:toSigningInput:. */
++ (NSMutableData *)createJWSSigningInputForHeader:(NSDictionary *)header
+                                          payload:(NSDictionary *)payload;
+
+/*! Appends "." and the base64url encoded signature to the signing input and returns the
+ compact serialization of the JWS. */
++ (NSString *)appendJWSSignature:(const void *)signature
+                          length:(size_t)length
+                  toSigningInput:(NSMutableData *)signingInput;
+
+/*! Appends the unpadded base64url encoding of the bytes to the buffer. */
++ (void)appendBase64UrlEncodedBytes:(const void *)bytes
+                             length:(size_t)length
+                             toData:(NSMutableData *)data;
 
 + (NSData*)computeKDFInCounterMode:(NSData *)key
                            context:(NSData *)ctx;
@@ -59,4 +74,21 @@
 
 + (NSString *)normalizeUserId:(NSString *)userId;
 
+/*! The dispatch QoS class for the quality of service, NSQualityOfServiceDefault maps to
+ QOS_CLASS_UNSPECIFIED so that the system defaults are left alone. */
++ (qos_class_t)qosClassForQualityOfService:(NSQualityOfService)qualityOfService;
+
+/*! The global concurrent queue for the QoS class, the default priority queue if it's
+ QOS_CLASS_UNSPECIFIED. */
++ (dispatch_queue_t)globalQueueForQOSClass:(qos_class_t)qosClass;
+
+/*! Wraps the block so it runs at the QoS class instead of inheriting the class of the thread
+ that submits it. This can only raise the block above the class of the queue it runs on, never
+ lower it, so to run at a lower class submit it to globalQueueForQOSClass: or to a queue with
+ a lower class. The block is returned as is if the class is QOS_CLASS_UNSPECIFIED. */
++ (dispatch_block_t)block:(dispatch_block_t)block withQOSClass:(qos_class_t)qosClass;
+
+/*! The NSURLSessionTask priority requests made at the QoS class are sent with. */
++ (float)taskPriorityForQOSClass:(qos_class_t)qosClass;
+
 @end
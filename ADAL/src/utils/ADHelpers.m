@@ -31,6 +31,33 @@
 #import "ADAL_Internal.h"
 #import "ADAuthorityUtils.h"
 
+// SP800-108 KDF in counter mode with HMAC-SHA256 as the PRF, producing a single 256 bit
+// block. The fixed input (label || 0x00 || context || L) is fed to the HMAC piece by piece
+// instead of being assembled in a buffer, so no memory gets allocated.
+static void ADKDFInCounterMode(const void *key,
+                               size_t keyLength,
+                               const void *context,
+                               size_t contextLength,
+                               uint8_t derivedKey[CC_SHA256_DIGEST_LENGTH])
+{
+    static const uint8_t s_counter[4] = { 0x00, 0x00, 0x00, 0x01 };
+    static const uint8_t s_separator[1] = { 0x00 };
+    // L, the length of the derived key in bits, big-endian
+    static const uint8_t s_outputLength[4] = { 0x00, 0x00, 0x01, 0x00 };
+    
+    CCHmacContext hmac;
+    CCHmacInit(&hmac, kCCHmacAlgSHA256, key, keyLength);
+    CCHmacUpdate(&hmac, s_counter, sizeof(s_counter));
+    const char *label = ADAL_AAD_SECURECONVERSATION_LABEL.UTF8String;
+    CCHmacUpdate(&hmac, label, strlen(label));
+    CCHmacUpdate(&hmac, s_separator, sizeof(s_separator));
+    CCHmacUpdate(&hmac, context, contextLength);
+    CCHmacUpdate(&hmac, s_outputLength, sizeof(s_outputLength));
+    CCHmacFinal(&hmac, derivedKey);
+    
+    memset_s(&hmac, sizeof(hmac), 0, sizeof(hmac));
+}
+
 @implementation ADHelpers
 
 
@@ -95,142 +122,138 @@
                                         context:(NSString *)context
                                    symmetricKey:(NSData *)symmetricKey
 {
-    NSString* signingInput = [NSString stringWithFormat:@"%@.%@",
-                              [[ADHelpers JSONFromDictionary:header] msidBase64UrlEncode],
-                              [[ADHelpers JSONFromDictionary:payload] msidBase64UrlEncode]];
+    NSMutableData* signingInput = [ADHelpers createJWSSigningInputForHeader:header payload:payload];
+    if (!signingInput)
+    {
+        return nil;
+    }
     
-    NSData* derivedKey = [ADHelpers computeKDFInCounterMode:symmetricKey
-                                                    context:[context dataUsingEncoding:NSUTF8StringEncoding]];
+    const char* contextBytes = context.UTF8String;
+    uint8_t derivedKey[CC_SHA256_DIGEST_LENGTH];
+    ADKDFInCounterMode(symmetricKey.bytes,
+                       symmetricKey.length,
+                       contextBytes,
+                       contextBytes ? strlen(contextBytes) : 0,
+                       derivedKey);
     
-    NSData* data = [signingInput dataUsingEncoding:NSUTF8StringEncoding];
     unsigned char cHMAC[CC_SHA256_DIGEST_LENGTH];
     CCHmac(kCCHmacAlgSHA256,
-           derivedKey.bytes,
-           derivedKey.length,
-           [data bytes],
-           [data length],
+           derivedKey,
+           sizeof(derivedKey),
+           signingInput.bytes,
+           signingInput.length,
            cHMAC);
-    NSData* signedData = [[NSData alloc] initWithBytes:cHMAC length:sizeof(cHMAC)];
-    NSString* signedEncodedDataString = [NSString msidBase64UrlEncodeData:signedData];
-    return [NSString stringWithFormat:@"%@.%@",
-            signingInput,
-            signedEncodedDataString];
+    memset_s(derivedKey, sizeof(derivedKey), 0, sizeof(derivedKey));
+    
+    return [ADHelpers appendJWSSignature:cHMAC length:sizeof(cHMAC) toSigningInput:signingInput];
 }
 
+#pragma mark - JWS
 
-+ (NSString *)JSONFromDictionary:(NSDictionary *)dictionary
++ (NSMutableData *)createJWSSigningInputForHeader:(NSDictionary *)header
+                                          payload:(NSDictionary *)payload
 {
-    
     NSError *error = nil;
-    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:dictionary
-                                                       options:NSJSONWritingPrettyPrinted
-                                                         error:&error];
-    if (!jsonData)
+    NSData *headerJSON = [NSJSONSerialization dataWithJSONObject:header options:0 error:&error];
+    NSData *payloadJSON = headerJSON ? [NSJSONSerialization dataWithJSONObject:payload options:0 error:&error] : nil;
+    if (!payloadJSON)
     {
+        MSID_LOG_ERROR(nil, @"Failed to serialize JWT, error code: %ld", (long)error.code);
+        MSID_LOG_ERROR_PII(nil, @"Failed to serialize JWT, error code: %ld error: %@", (long)error.code, error);
         return nil;
     }
     
-    NSString* json = [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
-    return json;
+    // Sized for both parts plus a SHA-256 or 2048 bit RSA signature, so appending
+    // the signature doesn't have to grow the buffer.
+    NSUInteger capacity = ((headerJSON.length + payloadJSON.length + 256) * 4) / 3 + 8;
+    NSMutableData *signingInput = [NSMutableData dataWithCapacity:capacity];
+    
+    [ADHelpers appendBase64UrlEncodedBytes:headerJSON.bytes length:headerJSON.length toData:signingInput];
+    [signingInput appendBytes:"." length:1];
+    [ADHelpers appendBase64UrlEncodedBytes:payloadJSON.bytes length:payloadJSON.length toData:signingInput];
+    
+    return signingInput;
 }
 
-+ (NSData*)computeKDFInCounterMode:(NSData *)key
-                           context:(NSData *)ctx
++ (NSString *)appendJWSSignature:(const void *)signature
+                          length:(size_t)length
+                  toSigningInput:(NSMutableData *)signingInput
 {
-    NSData* labelData = [ADAL_AAD_SECURECONVERSATION_LABEL dataUsingEncoding:NSUTF8StringEncoding];
-    NSMutableData* mutData = [NSMutableData new];
-    [mutData appendBytes:labelData.bytes length:labelData.length];
-    Byte bytes[] = {0x00};
-    [mutData appendBytes:bytes length:1];
-    [mutData appendBytes:ctx.bytes length:ctx.length];
-    int32_t size = CFSwapInt32HostToBig(256); //make big-endian
-    [mutData appendBytes:&size length:sizeof(size)];
-    
-    uint8_t* pbDerivedKey = [ADHelpers KDFCounterMode:(uint8_t*)key.bytes
-                                     keyDerivationKeyLength:key.length
-                                                 fixedInput:(uint8_t*)mutData.bytes
-                                           fixedInputLength:mutData.length];
-    mutData = nil;
-    NSData* returnedData = [NSData dataWithBytes:(const void *)pbDerivedKey length:32];
-    free(pbDerivedKey);
-    return returnedData;
+    if (!signingInput)
+    {
+        return nil;
+    }
+    
+    // A failed signature still produces "<header>.<payload>." like before
+    [signingInput appendBytes:"." length:1];
+    [ADHelpers appendBase64UrlEncodedBytes:signature length:length toData:signingInput];
+    
+    return [[NSString alloc] initWithData:signingInput encoding:NSASCIIStringEncoding];
 }
 
-
-
-+ (uint8_t*) KDFCounterMode:(uint8_t*) keyDerivationKey
-     keyDerivationKeyLength:(size_t) keyDerivationKeyLength
-                 fixedInput:(uint8_t*) fixedInput
-           fixedInputLength:(size_t) fixedInputLength
++ (void)appendBase64UrlEncodedBytes:(const void *)bytes
+                             length:(size_t)length
+                             toData:(NSMutableData *)data
 {
-    uint8_t ctr;
-    unsigned char cHMAC[CC_SHA256_DIGEST_LENGTH];
-    uint8_t* keyDerivated;
-    uint8_t* dataInput;
-    int len;
-    int numCurrentElements;
-    int numCurrentElements_bytes;
-    int outputSizeBit = 256;
-    
-    numCurrentElements = 0;
-    ctr = 1;
-    keyDerivated = (uint8_t*)malloc(outputSizeBit/8); //output is 32 bytes
-    
-    do{
-        //update data using "ctr"
-        dataInput =  [ADHelpers updateDataInput:ctr
-                                     fixedInput:fixedInput
-                              fixedInput_length: fixedInputLength];
-        
-        CCHmac(kCCHmacAlgSHA256,
-               keyDerivationKey,
-               keyDerivationKeyLength,
-               dataInput,
-               (fixedInputLength+4), //+4 to account for ctr
-               cHMAC);
-        
-        //decide how many bytes (so the "length") copy for currently keyDerivated?
-        if (256 >= outputSizeBit) {
-            len = outputSizeBit;
-        } else {
-            len = MIN(256, outputSizeBit - numCurrentElements);
-        }
-        
-        //convert bits in byte
-        numCurrentElements_bytes = numCurrentElements/8;
-        
-        //copy KI in part of keyDerivated
-        memcpy((keyDerivated + numCurrentElements_bytes), cHMAC, 32);
-        
-        //increment ctr and numCurrentElements copied in keyDerivated
-        numCurrentElements = numCurrentElements + len;
-        ctr++;
-        
-        //deallock space in memory
-        free(dataInput);
-        
-    } while (numCurrentElements < outputSizeBit);
+    static const char s_base64UrlAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    
+    // Encode straight into the tail of the buffer, unpadded output is at most 4 bytes
+    // for every 3 input bytes.
+    NSUInteger offset = data.length;
+    [data increaseLengthBy:((length + 2) / 3) * 4];
     
-    return keyDerivated;
+    const uint8_t *in = (const uint8_t *)bytes;
+    char *out = (char *)data.mutableBytes + offset;
+    size_t i = 0;
+    for (; i + 3 <= length; i += 3)
+    {
+        uint32_t triple = ((uint32_t)in[i] << 16) | ((uint32_t)in[i + 1] << 8) | in[i + 2];
+        *out++ = s_base64UrlAlphabet[(triple >> 18) & 0x3F];
+        *out++ = s_base64UrlAlphabet[(triple >> 12) & 0x3F];
+        *out++ = s_base64UrlAlphabet[(triple >> 6) & 0x3F];
+        *out++ = s_base64UrlAlphabet[triple & 0x3F];
+    }
+    
+    if (length - i == 1)
+    {
+        uint32_t triple = (uint32_t)in[i] << 16;
+        *out++ = s_base64UrlAlphabet[(triple >> 18) & 0x3F];
+        *out++ = s_base64UrlAlphabet[(triple >> 12) & 0x3F];
+    }
+    else if (length - i == 2)
+    {
+        uint32_t triple = ((uint32_t)in[i] << 16) | ((uint32_t)in[i + 1] << 8);
+        *out++ = s_base64UrlAlphabet[(triple >> 18) & 0x3F];
+        *out++ = s_base64UrlAlphabet[(triple >> 12) & 0x3F];
+        *out++ = s_base64UrlAlphabet[(triple >> 6) & 0x3F];
+    }
+    
+    // Trim the space reserved for the padding we don't write
+    [data setLength:(NSUInteger)(out - (char *)data.mutableBytes)];
 }
 
-
-/*
- * Function used to shift data of 1 byte. This byte is the "ctr".
- */
-+(uint8_t*) updateDataInput:(uint8_t) ctr
-                 fixedInput:(uint8_t*) fixedInput
-          fixedInput_length:(size_t) fixedInput_length
++ (NSData*)computeKDFInCounterMode:(NSData *)key
+                           context:(NSData *)ctx
 {
-    uint8_t* tmpFixedInput = (uint8_t *)malloc(fixedInput_length + 4); //+4 is caused from the ctr
+    uint8_t derivedKey[CC_SHA256_DIGEST_LENGTH];
+    ADKDFInCounterMode(key.bytes, key.length, ctx.bytes, ctx.length, derivedKey);
     
-    tmpFixedInput[0] = (ctr >> 24);
-    tmpFixedInput[1] = (ctr >> 16);
-    tmpFixedInput[2] = (ctr >> 8);
-    tmpFixedInput[3] = ctr;
+    NSData* returnedData = [NSData dataWithBytes:derivedKey length:sizeof(derivedKey)];
+    memset_s(derivedKey, sizeof(derivedKey), 0, sizeof(derivedKey));
+    return returnedData;
+}
+
++ (NSCache *)versionedURLCache
+{
+    static NSCache *s_versionedURLCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        s_versionedURLCache = [NSCache new];
+        // Requests go to a handful of authority endpoints, this only needs to cover those
+        s_versionedURLCache.countLimit = 64;
+    });
     
-    memcpy(tmpFixedInput + 4, fixedInput, fixedInput_length * sizeof(uint8_t));
-    return tmpFixedInput;
+    return s_versionedURLCache;
 }
 
 + (NSURL*)addClientVersionToURL:(NSURL*)url
@@ -240,6 +263,15 @@
         return nil;
     }
     
+    // Token and discovery requests are sent to the same few endpoints over and over, so
+    // remember the versioned form instead of decomposing the URL every time.
+    NSCache *cache = [self versionedURLCache];
+    NSURL *versionedURL = [cache objectForKey:url];
+    if (versionedURL)
+    {
+        return versionedURL;
+    }
+    
     // Pull apart the request URL and add the ADAL Client version to the query parameters
     NSURLComponents* components = [[NSURLComponents alloc] initWithURL:url resolvingAgainstBaseURL:NO];
     if (!components)
@@ -251,19 +283,33 @@
     // Don't bother adding it if it's already there
     if (query && [query containsString:ADAL_ID_VERSION])
     {
-        return url;
+        versionedURL = url;
     }
-    
-    if (query)
+    else
     {
-        [components setPercentEncodedQuery:[query stringByAppendingString:[NSString stringWithFormat:@"&%@=%@", ADAL_ID_VERSION, ADAL_VERSION_NSSTRING]]];
+        if (query)
+        {
+            [components setPercentEncodedQuery:[query stringByAppendingString:[NSString stringWithFormat:@"&%@=%@", ADAL_ID_VERSION, ADAL_VERSION_NSSTRING]]];
+        }
+        else
+        {
+            [components setPercentEncodedQuery:[NSString stringWithFormat:@"%@=%@", ADAL_ID_VERSION, ADAL_VERSION_NSSTRING]];
+        }
+        
+        versionedURL = [components URL];
     }
-    else
+    
+    // Only endpoint URLs are remembered, per-request query strings (GET parameters, login
+    // hints) would just churn the cache.
+    if (versionedURL && !url.query)
     {
-        [components setPercentEncodedQuery:[NSString stringWithFormat:@"%@=%@", ADAL_ID_VERSION, ADAL_VERSION_NSSTRING]];
+        [cache setObject:versionedURL forKey:url];
+        
+        // A versioned URL maps to itself, so redirects and resends short circuit as well
+        [cache setObject:versionedURL forKey:versionedURL];
     }
     
-    return [components URL];
+    return versionedURL;
 }
 
 + (NSString*)addClientVersionToURLString:(NSString*)url
@@ -397,4 +443,53 @@
     return normalized.length ? normalized : nil;
 }
 
+#pragma mark - Quality of service
+
++ (qos_class_t)qosClassForQualityOfService:(NSQualityOfService)qualityOfService
+{
+    switch (qualityOfService)
+    {
+        case NSQualityOfServiceUserInteractive: return QOS_CLASS_USER_INTERACTIVE;
+        case NSQualityOfServiceUserInitiated: return QOS_CLASS_USER_INITIATED;
+        case NSQualityOfServiceUtility: return QOS_CLASS_UTILITY;
+        case NSQualityOfServiceBackground: return QOS_CLASS_BACKGROUND;
+        default: return QOS_CLASS_UNSPECIFIED;
+    }
+}
+
++ (dispatch_queue_t)globalQueueForQOSClass:(qos_class_t)qosClass
+{
+    if (qosClass == QOS_CLASS_UNSPECIFIED)
+    {
+        return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    }
+    
+    return dispatch_get_global_queue(qosClass, 0);
+}
+
++ (dispatch_block_t)block:(dispatch_block_t)block withQOSClass:(qos_class_t)qosClass
+{
+    if (qosClass == QOS_CLASS_UNSPECIFIED)
+    {
+        return block;
+    }
+    
+    return dispatch_block_create_with_qos_class(DISPATCH_BLOCK_ENFORCE_QOS_CLASS, qosClass, 0, block);
+}
+
++ (float)taskPriorityForQOSClass:(qos_class_t)qosClass
+{
+    switch (qosClass)
+    {
+        case QOS_CLASS_USER_INTERACTIVE:
+        case QOS_CLASS_USER_INITIATED:
+            return NSURLSessionTaskPriorityHigh;
+        case QOS_CLASS_UTILITY:
+        case QOS_CLASS_BACKGROUND:
+            return NSURLSessionTaskPriorityLow;
+        default:
+            return NSURLSessionTaskPriorityDefault;
+    }
+}
+
 @end
@@ -26,6 +26,7 @@
 
 @class ADAuthorityValidationResponse;
 @class MSIDAadAuthorityCache;
+@class ADInstanceDiscoveryStore;
 
 /*! The completion block declaration. */
 typedef void(^ADAuthorityValidationCallback)(BOOL validated, ADAuthenticationError *error);
@@ -35,9 +36,13 @@ typedef void(^ADAuthorityValidationCallback)(BOOL validated, ADAuthenticationErr
 @interface ADAuthorityValidation : NSObject
 {
     MSIDAadAuthorityCache *_aadCache;
+    ADInstanceDiscoveryStore *_discoveryStore;
 }
 
 @property (readonly) MSIDAadAuthorityCache *aadCache;
+/*! Where AAD validation results are kept across launches when
+ ADAuthenticationSettings.instanceDiscoveryCacheLifetime is set. */
+@property (retain) ADInstanceDiscoveryStore *discoveryStore;
 
 + (ADAuthorityValidation *)sharedInstance;
 
@@ -36,6 +36,8 @@
 #import "ADAuthenticationErrorConverter.h"
 #import "MSIDAuthority.h"
 #import "NSURL+MSIDExtensions.h"
+#import "ADInstanceDiscoveryStore.h"
+#import "ADAuthenticationSettings.h"
 
 // Trusted relation for webFinger
 static NSString* const s_kTrustedRelation              = @"http://schemas.microsoft.com/rel/trusted-realm";
@@ -78,13 +80,17 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
     
     _validatedAdfsAuthorities = [NSMutableDictionary new];
     _aadCache = [MSIDAadAuthorityCache sharedInstance];
+    _discoveryStore = [ADInstanceDiscoveryStore defaultStore];
     
     // A serial dispatch queue for all authority validation operations. A very common pattern is for
     // applications to spawn a bunch of threads and call acquireToken on them right at the start. Many
     // of those acquireToken calls will be to the same authority. To avoid making the exact same
     // authority validation network call multiple times we throw the requests in this validation
     // queue.
-    _aadValidationQueue = dispatch_queue_create("adal.validation.queue", DISPATCH_QUEUE_SERIAL);
+    // The queue sits at the lowest class, each block raises it to the class of its request. A
+    // block can only be raised above the class of its queue, never lowered below it.
+    dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_BACKGROUND, 0);
+    _aadValidationQueue = dispatch_queue_create("adal.validation.queue", attr);
     
     return self;
 }
@@ -212,7 +218,9 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
     
     // If we wither didn't have a cache, or couldn't get the read lock (which only happens if someone
     // has or is trying to get the write lock) then dispatch onto the AAD validation queue.
-    dispatch_async(_aadValidationQueue, ^{
+    // The block carries the class of the request, so an interactive validation queued up
+    // behind a background one raises the queue rather than waiting at the lower class.
+    dispatch_async(_aadValidationQueue, [ADHelpers block:^{
         
         // If we didn't have anything in the cache then we need to hold onto the queue until we
         // get a response back from the server, or timeout, or fail for any other reason
@@ -227,7 +235,7 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
              // validation network request at a time, we want to jump off this queue as quick as
              // possible whenever we hit an error to unblock the queue
              
-             dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+             dispatch_async([ADHelpers globalQueueForQOSClass:requestParams.qosClass], ^{
                  completionBlock(validated, error);
              });
              
@@ -245,7 +253,7 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
             dispatch_semaphore_wait(dsem, DISPATCH_TIME_FOREVER);
             MSID_LOG_INFO(requestParams, @"Returned from Authority Validation Queue");
         }
-    });
+    } withQOSClass:requestParams.qosClass == QOS_CLASS_UNSPECIFIED ? QOS_CLASS_DEFAULT : requestParams.qosClass]);
 }
 
 - (void)requestAADValidation:(NSURL *)authority
@@ -261,6 +269,13 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
         return;
     }
     
+    NSTimeInterval storeLifetime = [[ADAuthenticationSettings sharedInstance] instanceDiscoveryCacheLifetime];
+    if (storeLifetime > 0 && [self loadStoredMetadataForAuthority:authority requestParams:requestParams])
+    {
+        completionBlock(YES, nil);
+        return;
+    }
+    
     NSString *trustedHost = ADTrustedAuthorityWorldWide;
     
     if ([ADAuthorityUtils isKnownHost:authority])
@@ -307,10 +322,42 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
              return;
          }
          
+         if (storeLifetime > 0)
+         {
+             [_discoveryStore setMetadata:response[@"metadata"]
+                             forAuthority:authority
+                                expiresOn:[NSDate dateWithTimeIntervalSinceNow:storeLifetime]];
+         }
+         
          completionBlock(YES, nil);
      }];
 }
 
+// Replays metadata an earlier launch got for the authority's host into the in-memory cache
+- (BOOL)loadStoredMetadataForAuthority:(NSURL *)authority
+                         requestParams:(ADRequestParameters *)requestParams
+{
+    NSArray *metadata = [_discoveryStore metadataForAuthority:authority];
+    if (!metadata)
+    {
+        return NO;
+    }
+    
+    NSError *msidError = nil;
+    if (![_aadCache processMetadata:metadata.count ? metadata : nil
+                          authority:authority
+                            context:requestParams
+                              error:&msidError])
+    {
+        MSID_LOG_WARN(requestParams, @"Stored instance discovery metadata couldn't be processed, validating against the server");
+        [_discoveryStore removeMetadataForAuthority:authority];
+        return NO;
+    }
+    
+    MSID_LOG_INFO(requestParams, @"Authority validated from stored instance discovery metadata");
+    return YES;
+}
+
 - (void)addInvalidAuthority:(NSString *)authority
 {
     [_aadCache addInvalidRecord:[NSURL URLWithString:authority] oauthError:nil context:nil];
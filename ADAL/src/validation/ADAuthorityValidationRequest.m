@@ -24,6 +24,7 @@
 
 #import "ADAuthorityValidationRequest.h"
 #import "ADWebAuthRequest.h"
+#import "ADAuthenticationSettings.h"
 
 static NSString* const s_kApiVersionKey            = @"api-version";
 static NSString* const s_kApiVersion               = @AAD_AUTHORITY_VALIDATION_API_VERSION;
@@ -41,6 +42,7 @@ static NSString* const s_kAuthorizationEndPointKey = @"authorization_endpoint";
                                                                  context:context];
     
     [webRequest setIsGetRequest:YES];
+    [webRequest setHedgeDelay:[[ADAuthenticationSettings sharedInstance] requestHedgingDelay]];
     [webRequest sendRequest:^(ADAuthenticationError *error, NSMutableDictionary *response)
     {
         if (error)
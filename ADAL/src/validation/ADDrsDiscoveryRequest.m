@@ -24,6 +24,7 @@
 
 #import "ADDrsDiscoveryRequest.h"
 #import "ADWebAuthRequest.h"
+#import "ADAuthenticationSettings.h"
 
 @implementation ADDrsDiscoveryRequest
 
@@ -36,6 +37,7 @@
     
     ADWebAuthRequest *webRequest = [[ADWebAuthRequest alloc] initWithURL:url context:context];
     [webRequest setIsGetRequest:YES];
+    [webRequest setHedgeDelay:[[ADAuthenticationSettings sharedInstance] requestHedgingDelay]];
     [webRequest setAcceptOnlyOKResponse:YES];
     
     [webRequest sendRequest:^(ADAuthenticationError *error, NSMutableDictionary *response)
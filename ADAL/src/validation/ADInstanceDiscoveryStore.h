@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+/*!
+    File backed store of AAD instance discovery metadata, so that a process can skip the
+    instance discovery round trip for an authority an earlier launch already validated.
+    Only successful validations are kept. The file is read lazily on first lookup, and is
+    ignored as a whole when it was written with a different store or ADAL version. Entries
+    that don't look like instance discovery metadata are dropped when the file is read.
+    The class is thread-safe.
+ */
+@interface ADInstanceDiscoveryStore : NSObject
+{
+    NSURL *_fileURL;
+    NSMutableDictionary *_entries;
+    BOOL _loaded;
+}
+
+@property (readonly) NSURL *fileURL;
+
+/*! The store in a directory named after the application's bundle identifier, under the
+    user's caches directory. */
++ (ADInstanceDiscoveryStore *)defaultStore;
+
+- (id)initWithFileURL:(NSURL *)fileURL;
+
+/*!
+    Returns the metadata the authority's host was validated with, an empty array if the
+    response had none, or nil if there is no entry for the host or it has expired.
+ */
+- (NSArray *)metadataForAuthority:(NSURL *)authority;
+
+/*! Records the metadata for the authority's host and writes the store out. */
+- (void)setMetadata:(NSArray *)metadata
+       forAuthority:(NSURL *)authority
+          expiresOn:(NSDate *)expiresOn;
+
+/*! Drops the entry for the authority's host, e.g. when its metadata turned out to be unusable. */
+- (void)removeMetadataForAuthority:(NSURL *)authority;
+
+/*! Drops all entries and deletes the file. */
+- (void)removeAll;
+
+@end
@@ -0,0 +1,299 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "ADInstanceDiscoveryStore.h"
+#import "NSURL+MSIDExtensions.h"
+
+// Bumped whenever the layout of the file changes, files with another version are ignored
+static NSInteger const s_kStoreVersion = 1;
+
+static NSString *const s_kVersionKey        = @"version";
+static NSString *const s_kClientVersionKey  = @"client_version";
+static NSString *const s_kEntriesKey        = @"entries";
+static NSString *const s_kMetadataKey       = @"metadata";
+static NSString *const s_kExpiresOnKey      = @"expires_on";
+
+@implementation ADInstanceDiscoveryStore
+
+@synthesize fileURL = _fileURL;
+
++ (ADInstanceDiscoveryStore *)defaultStore
+{
+    static ADInstanceDiscoveryStore *s_defaultStore = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        // Outside of the iOS sandbox the caches directory is shared by every app the user runs,
+        // so the file goes under a directory of the app's own.
+        NSString *appDirectory = [[NSBundle mainBundle] bundleIdentifier];
+        if (!appDirectory)
+        {
+            appDirectory = [[NSProcessInfo processInfo] processName];
+        }
+        
+        NSURL *cachesURL = [[[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask] firstObject];
+        NSURL *fileURL = [[cachesURL URLByAppendingPathComponent:appDirectory isDirectory:YES]
+                          URLByAppendingPathComponent:@"com.microsoft.adal/instance_discovery.json"];
+        s_defaultStore = [[ADInstanceDiscoveryStore alloc] initWithFileURL:fileURL];
+    });
+    
+    return s_defaultStore;
+}
+
+- (id)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return nil;
+}
+
+- (id)initWithFileURL:(NSURL *)fileURL
+{
+    if (!fileURL)
+    {
+        return nil;
+    }
+    
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _fileURL = fileURL;
+    
+    return self;
+}
+
+#pragma mark - Entries
+
+- (NSArray *)metadataForAuthority:(NSURL *)authority
+{
+    NSString *host = authority.msidHostWithPortIfNecessary;
+    if (!host)
+    {
+        return nil;
+    }
+    
+    @synchronized(self)
+    {
+        [self loadIfNeeded];
+        
+        NSDictionary *entry = _entries[host];
+        if (!entry)
+        {
+            return nil;
+        }
+        
+        NSTimeInterval expiresOn = [entry[s_kExpiresOnKey] doubleValue];
+        if (expiresOn <= [[NSDate date] timeIntervalSince1970])
+        {
+            [_entries removeObjectForKey:host];
+            return nil;
+        }
+        
+        return entry[s_kMetadataKey];
+    }
+}
+
+- (void)setMetadata:(NSArray *)metadata
+       forAuthority:(NSURL *)authority
+          expiresOn:(NSDate *)expiresOn
+{
+    NSString *host = authority.msidHostWithPortIfNecessary;
+    if (!host || !expiresOn)
+    {
+        return;
+    }
+    
+    @synchronized(self)
+    {
+        [self loadIfNeeded];
+        
+        _entries[host] = @{ s_kMetadataKey : metadata ? metadata : @[],
+                            s_kExpiresOnKey : @([expiresOn timeIntervalSince1970]) };
+        
+        [self save];
+    }
+}
+
+- (void)removeMetadataForAuthority:(NSURL *)authority
+{
+    NSString *host = authority.msidHostWithPortIfNecessary;
+    if (!host)
+    {
+        return;
+    }
+    
+    @synchronized(self)
+    {
+        [self loadIfNeeded];
+        
+        if (!_entries[host])
+        {
+            return;
+        }
+        
+        [_entries removeObjectForKey:host];
+        [self save];
+    }
+}
+
+- (void)removeAll
+{
+    @synchronized(self)
+    {
+        _entries = [NSMutableDictionary new];
+        _loaded = YES;
+        
+        [[NSFileManager defaultManager] removeItemAtURL:_fileURL error:nil];
+    }
+}
+
+#pragma mark - File
+
+// Has to be called while holding the lock
+- (void)loadIfNeeded
+{
+    if (_loaded)
+    {
+        return;
+    }
+    
+    _loaded = YES;
+    _entries = [NSMutableDictionary new];
+    
+    NSData *data = [NSData dataWithContentsOfURL:_fileURL];
+    if (!data)
+    {
+        return;
+    }
+    
+    NSDictionary *contents = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    if (![contents isKindOfClass:[NSDictionary class]])
+    {
+        MSID_LOG_WARN(nil, @"Instance discovery store is unreadable, ignoring it");
+        return;
+    }
+    
+    // Metadata written by another version of the library might not mean the same thing
+    if (![contents[s_kVersionKey] isEqual:@(s_kStoreVersion)] ||
+        ![contents[s_kClientVersionKey] isEqual:ADAL_VERSION_NSSTRING])
+    {
+        MSID_LOG_INFO(nil, @"Instance discovery store was written by another version, ignoring it");
+        return;
+    }
+    
+    NSDictionary *entries = contents[s_kEntriesKey];
+    if (![entries isKindOfClass:[NSDictionary class]])
+    {
+        return;
+    }
+    
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+    
+    for (NSString *host in entries)
+    {
+        NSDictionary *entry = entries[host];
+        if (![entry isKindOfClass:[NSDictionary class]] ||
+            ![ADInstanceDiscoveryStore isValidMetadata:entry[s_kMetadataKey]] ||
+            ![entry[s_kExpiresOnKey] isKindOfClass:[NSNumber class]] ||
+            [entry[s_kExpiresOnKey] doubleValue] <= now)
+        {
+            continue;
+        }
+        
+        _entries[host] = entry;
+    }
+}
+
+// Checks the metadata has the shape of an instance discovery response, anything else in the
+// file was not written by us and is left out.
++ (BOOL)isValidMetadata:(id)metadata
+{
+    if (![metadata isKindOfClass:[NSArray class]])
+    {
+        return NO;
+    }
+    
+    for (NSDictionary *record in metadata)
+    {
+        if (![record isKindOfClass:[NSDictionary class]])
+        {
+            return NO;
+        }
+        
+        NSArray *aliases = record[@"aliases"];
+        if (![aliases isKindOfClass:[NSArray class]] || aliases.count == 0)
+        {
+            return NO;
+        }
+        
+        for (NSString *alias in aliases)
+        {
+            if (![alias isKindOfClass:[NSString class]])
+            {
+                return NO;
+            }
+        }
+        
+        for (NSString *key in @[ @"preferred_network", @"preferred_cache" ])
+        {
+            id value = record[key];
+            if (value && ![value isKindOfClass:[NSString class]])
+            {
+                return NO;
+            }
+        }
+    }
+    
+    return YES;
+}
+
+// Has to be called while holding the lock
+- (void)save
+{
+    NSDictionary *contents = @{ s_kVersionKey : @(s_kStoreVersion),
+                                s_kClientVersionKey : ADAL_VERSION_NSSTRING,
+                                s_kEntriesKey : _entries };
+    
+    NSError *error = nil;
+    NSData *data = [NSJSONSerialization dataWithJSONObject:contents options:0 error:&error];
+    if (!data)
+    {
+        MSID_LOG_WARN(nil, @"Failed to serialize instance discovery store");
+        return;
+    }
+    
+    [[NSFileManager defaultManager] createDirectoryAtURL:[_fileURL URLByDeletingLastPathComponent]
+                             withIntermediateDirectories:YES
+                                              attributes:nil
+                                                   error:nil];
+    
+    if (![data writeToURL:_fileURL options:NSDataWritingAtomic error:&error])
+    {
+        MSID_LOG_WARN(nil, @"Failed to write instance discovery store");
+        MSID_LOG_WARN_PII(nil, @"Failed to write instance discovery store, error: %@", error);
+    }
+}
+
+@end
@@ -23,6 +23,7 @@
 
 #import "ADJwtHelper.h"
 #import "ADErrorCodes.h"
+#import "ADHelpers.h"
 #import <CommonCrypto/CommonDigest.h>
 #import <Security/Security.h>
 #import <Security/SecKey.h>
@@ -34,14 +35,16 @@
                               payload:(NSDictionary *)payload
                            signingKey:(SecKeyRef)signingKey
 {
-    NSString* headerJSON = [ADJwtHelper JSONFromDictionary:header];
-    NSString* payloadJSON = [ADJwtHelper JSONFromDictionary:payload];
-    NSString* signingInput = [NSString stringWithFormat:@"%@.%@", [headerJSON msidBase64UrlEncode], [payloadJSON msidBase64UrlEncode]];
+    NSMutableData* signingInput = [ADHelpers createJWSSigningInputForHeader:header payload:payload];
+    if (!signingInput)
+    {
+        return nil;
+    }
+    
     NSData* signedData = [ADJwtHelper sign:signingKey
-                                      data:[signingInput dataUsingEncoding:NSUTF8StringEncoding]];
-    NSString* signedEncodedDataString = [NSString msidBase64UrlEncodeData: signedData];
+                                      data:signingInput];
     
-    return [NSString stringWithFormat:@"%@.%@", signingInput, signedEncodedDataString];
+    return [ADHelpers appendJWSSignature:signedData.bytes length:signedData.length toSigningInput:signingInput];
 }
 
 
@@ -132,24 +135,4 @@
     return signedHash;
 }
 
-
-+ (NSString *)JSONFromDictionary:(NSDictionary *)dictionary
-{
-    
-    NSError *error = nil;
-    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:dictionary
-                                                       options:NSJSONWritingPrettyPrinted
-                                                         error:&error];
-    if (!jsonData)
-    {
-        MSID_LOG_ERROR(nil, @"Got an error code: %ld", (long)error.code);
-        MSID_LOG_ERROR_PII(nil, @"Got an error code: %ld error: %@", (long)error.code, error);
-        
-        return nil;
-    }
-
-    NSString* json = [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
-    return json;
-}
-
 @end
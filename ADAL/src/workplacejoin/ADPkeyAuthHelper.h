@@ -37,7 +37,22 @@ typedef enum
                                        context:(nullable id<MSIDRequestContext>)context
                                          error:(ADAuthenticationError * __nullable __autoreleasing * __nullable)error;
 
++ (nonnull NSString*)computeThumbprint:(nonnull NSData*)data;
+
 + (nonnull NSString*)computeThumbprint:(nonnull NSData*)data
                                 isSha2:(BOOL)isSha2;
 
+/*!
+    Returns "OU=<GUID>" using the first GUID found in the issuer, or nil if
+    the issuer does not contain one.
+ */
++ (nullable NSString*)getOrgUnitFromIssuer:(nullable NSString*)issuer;
+
+/*!
+    Returns YES if one of the "OU=<GUID>" entries in the cert authorities
+    matches the keychain cert issuer OU, ignoring case.
+ */
++ (BOOL)isValidIssuer:(nullable NSString*)certAuths
+   keychainCertIssuer:(nullable NSString*)keychainCertIssuer;
+
 @end
@@ -44,7 +44,7 @@
         length = CC_SHA256_DIGEST_LENGTH;
     }
     
-    unsigned char dataBuffer[length];
+    unsigned char dataBuffer[CC_SHA256_DIGEST_LENGTH];
     if(!isSha2){
         CC_SHA1(data.bytes, (CC_LONG)data.length, dataBuffer);
     }
@@ -52,17 +52,49 @@
         CC_SHA256(data.bytes, (CC_LONG)data.length, dataBuffer);
     }
     
-    NSMutableString *fingerprint = [NSMutableString stringWithCapacity:length * 3];
+    static const char s_hexDigits[] = "0123456789ABCDEF";
+    char fingerprint[CC_SHA256_DIGEST_LENGTH * 2];
     for (int i = 0; i < length; ++i)
     {
-        [fingerprint appendFormat:@"%02x ",dataBuffer[i]];
+        fingerprint[i * 2] = s_hexDigits[dataBuffer[i] >> 4];
+        fingerprint[i * 2 + 1] = s_hexDigits[dataBuffer[i] & 0x0F];
     }
     
-    NSString* thumbprint = [fingerprint stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
-    thumbprint = [thumbprint uppercaseString];
-    return [thumbprint stringByReplacingOccurrencesOfString:@" " withString:@""];
+    return [[NSString alloc] initWithBytes:fingerprint length:length * 2 encoding:NSASCIIStringEncoding];
 }
 
+#pragma mark - Issuer matching
+
+// Length of a textual GUID, "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+#define AD_GUID_LENGTH 36
+// Length of "OU="
+#define AD_OU_PREFIX_LENGTH 3
+
+static inline BOOL ADIsHexDigit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Returns YES if the AD_GUID_LENGTH characters starting at str form a GUID.
+static BOOL ADIsGuidAt(const char *str)
+{
+    for (NSUInteger i = 0; i < AD_GUID_LENGTH; ++i)
+    {
+        if (i == 8 || i == 13 || i == 18 || i == 23)
+        {
+            if (str[i] != '-')
+            {
+                return NO;
+            }
+        }
+        else if (!ADIsHexDigit(str[i]))
+        {
+            return NO;
+        }
+    }
+    
+    return YES;
+}
 
 + (nullable NSString*)createDeviceAuthResponse:(nonnull NSString*)authorizationServer
                                 challengeData:(nullable NSDictionary*)challengeData
@@ -104,8 +136,7 @@
         
         if (certAuths)
         {
-            NSString* issuerOU = [ADPkeyAuthHelper getOrgUnitFromIssuer:[info certificateIssuer]];
-            if (![self isValidIssuer:certAuths keychainCertIssuer:issuerOU])
+            if (![self isValidIssuer:certAuths keychainCertIssuer:[info certificateIssuerOrgUnit]])
             {
                 MSID_LOG_ERROR(nil, @"PKeyAuth Error: Certificate Authority specified by device auth request does not match certificate in keychain.");
                 
@@ -114,7 +145,7 @@
         }
         else if (expectedThumbprint)
         {
-            if (![expectedThumbprint isEqualToString:[ADPkeyAuthHelper computeThumbprint:[info certificateData]]])
+            if (![expectedThumbprint isEqualToString:[info certificateThumbprint]])
             {
                 MSID_LOG_ERROR(nil, @"PKeyAuth Error: Certificate Thumbprint does not match certificate in keychain.");
                 
@@ -139,13 +170,22 @@
 
 + (NSString*)getOrgUnitFromIssuer:(NSString*)issuer
 {
-    NSString *regexString = @"[a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}";
-    NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:regexString options:0 error:NULL];
+    // Hand written equivalent of the [a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}
+    // regular expression, this gets run for every PKeyAuth challenge.
+    const char *issuerBytes = issuer.UTF8String;
+    if (!issuerBytes)
+    {
+        return nil;
+    }
     
-    for (NSTextCheckingResult* myMatch in [regex matchesInString:issuer options:0 range:NSMakeRange(0, [issuer length])]){
-        if (myMatch.numberOfRanges > 0) {
-            NSRange matchedRange = [myMatch rangeAtIndex: 0];
-            return [NSString stringWithFormat:@"OU=%@", [issuer substringWithRange: matchedRange]];
+    size_t length = strlen(issuerBytes);
+    for (size_t i = 0; i + AD_GUID_LENGTH <= length; ++i)
+    {
+        if (ADIsGuidAt(issuerBytes + i))
+        {
+            char orgUnit[AD_OU_PREFIX_LENGTH + AD_GUID_LENGTH] = { 'O', 'U', '=' };
+            memcpy(orgUnit + AD_OU_PREFIX_LENGTH, issuerBytes + i, AD_GUID_LENGTH);
+            return [[NSString alloc] initWithBytes:orgUnit length:sizeof(orgUnit) encoding:NSASCIIStringEncoding];
         }
     }
     
@@ -155,23 +195,40 @@
 + (BOOL)isValidIssuer:(NSString *)certAuths
    keychainCertIssuer:(NSString *)keychainCertIssuer
 {
-    NSString *regexString = @"OU=[a-fA-F0-9]{8}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{4}-[a-fA-F0-9]{12}";
-    keychainCertIssuer = [keychainCertIssuer uppercaseString];
-    certAuths = [certAuths uppercaseString];
-    NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:regexString options:0 error:NULL];
+    // Looks for a case insensitive "OU=<GUID>" in the list of cert authorities that
+    // matches the issuer of the certificate in the keychain
+    const char *issuerBytes = keychainCertIssuer.UTF8String;
+    const char *certAuthsBytes = certAuths.UTF8String;
+    if (!issuerBytes || !certAuthsBytes)
+    {
+        return NO;
+    }
+    
+    if (strlen(issuerBytes) != AD_OU_PREFIX_LENGTH + AD_GUID_LENGTH)
+    {
+        return NO;
+    }
     
-    for (NSTextCheckingResult* myMatch in [regex matchesInString:certAuths options:0 range:NSMakeRange(0, [certAuths length])]){
-        for (NSUInteger i = 0; i < myMatch.numberOfRanges; ++i)
+    size_t length = strlen(certAuthsBytes);
+    size_t i = 0;
+    while (i + AD_OU_PREFIX_LENGTH + AD_GUID_LENGTH <= length)
+    {
+        const char *candidate = certAuthsBytes + i;
+        if (strncasecmp(candidate, "OU=", AD_OU_PREFIX_LENGTH) != 0 || !ADIsGuidAt(candidate + AD_OU_PREFIX_LENGTH))
         {
-            NSRange matchedRange = [myMatch rangeAtIndex: i];
-            NSString *text = [certAuths substringWithRange:matchedRange];
-            if ([text isEqualToString:keychainCertIssuer]){
-                return true;
-            }
+            ++i;
+            continue;
         }
+        
+        if (strncasecmp(candidate, issuerBytes, AD_OU_PREFIX_LENGTH + AD_GUID_LENGTH) == 0)
+        {
+            return YES;
+        }
+        
+        i += AD_OU_PREFIX_LENGTH + AD_GUID_LENGTH;
     }
     
-    return false;
+    return NO;
 }
 
 + (NSString *)createDeviceAuthResponse:(NSString *)audience
@@ -32,6 +32,9 @@
     NSString *_certificateIssuer;
     NSData *_certificateData;
     SecKeyRef _privateKey;
+    
+    NSString *_certificateIssuerOrgUnit;
+    NSString *_certificateThumbprint;
 }
 
 @property (nonatomic, readonly) SecIdentityRef securityIdentity;
@@ -41,6 +44,11 @@
 @property (nonatomic, readonly) NSData *certificateData;
 @property (nonatomic, readonly) SecKeyRef privateKey;
 
+/*! The "OU=<GUID>" of the certificate issuer, computed once per registration. */
+@property (readonly) NSString *certificateIssuerOrgUnit;
+/*! The SHA-1 thumbprint of the certificate, computed once per registration. */
+@property (readonly) NSString *certificateThumbprint;
+
 - (id)initWithSecurityIdentity:(SecIdentityRef)identity
              certificateIssuer:(NSString*)certificateIssuer
                    certificate:(SecCertificateRef)certificate
@@ -22,6 +22,7 @@
 // THE SOFTWARE.
 
 #import "ADRegistrationInformation.h"
+#import "ADPkeyAuthHelper.h"
 
 @implementation ADRegistrationInformation
 
@@ -75,6 +76,32 @@
     _privateKey = NULL;    
 }
 
+- (NSString *)certificateIssuerOrgUnit
+{
+    @synchronized(self)
+    {
+        if (!_certificateIssuerOrgUnit)
+        {
+            _certificateIssuerOrgUnit = [ADPkeyAuthHelper getOrgUnitFromIssuer:_certificateIssuer];
+        }
+        
+        return _certificateIssuerOrgUnit;
+    }
+}
+
+- (NSString *)certificateThumbprint
+{
+    @synchronized(self)
+    {
+        if (!_certificateThumbprint && _certificateData)
+        {
+            _certificateThumbprint = [ADPkeyAuthHelper computeThumbprint:_certificateData];
+        }
+        
+        return _certificateThumbprint;
+    }
+}
+
 - (BOOL)isWorkPlaceJoined
 {
     return _certificate != nil;
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+@class ADRegistrationInformation;
+
+/*!
+    Keeps the result of the last workplace join lookup for a short while, so that PKeyAuth
+    challenges arriving back to back don't each go to the keychain for the identity. "Not
+    joined" is cached as well, lookups that failed are not. There is no notification for
+    keychain changes, so besides the lifetime the cache is dropped whenever the app comes
+    back to the foreground or a broker response is handled, which is when a registration
+    made in another app shows up.
+    The class is thread-safe.
+ */
+@interface ADRegistrationInformationCache : NSObject
+{
+    ADRegistrationInformation *_information;
+    NSDate *_expiresOn;
+    NSTimeInterval _lifetime;
+}
+
+/*! How long a lookup is reused for, in seconds. 0 turns the cache off. */
+@property NSTimeInterval lifetime;
+
++ (ADRegistrationInformationCache *)sharedCache;
+
+/*!
+    Returns YES if a lookup that hasn't expired is cached, and sets information to its result,
+    which is nil when the device isn't joined.
+ */
+- (BOOL)getInformation:(ADRegistrationInformation * __autoreleasing *)information;
+
+/*! Caches the result of a lookup that succeeded, nil when the device isn't joined. */
+- (void)setInformation:(ADRegistrationInformation *)information;
+
+- (void)clear;
+
+@end
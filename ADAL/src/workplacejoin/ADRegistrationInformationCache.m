@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "ADRegistrationInformationCache.h"
+#import "ADRegistrationInformation.h"
+
+// Long enough to cover the challenges of a burst of token requests, short enough that a
+// certificate removed underneath us isn't used for long.
+static NSTimeInterval const s_kDefaultLifetime = 300;
+
+@implementation ADRegistrationInformationCache
+
+@synthesize lifetime = _lifetime;
+
++ (ADRegistrationInformationCache *)sharedCache
+{
+    static ADRegistrationInformationCache *s_sharedCache = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        s_sharedCache = [ADRegistrationInformationCache new];
+    });
+    
+    return s_sharedCache;
+}
+
+- (id)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _lifetime = s_kDefaultLifetime;
+    
+#if TARGET_OS_IPHONE
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(clear)
+                                                 name:UIApplicationWillEnterForegroundNotification
+                                               object:nil];
+#endif
+    
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (BOOL)getInformation:(ADRegistrationInformation * __autoreleasing *)information
+{
+    @synchronized(self)
+    {
+        if (!_expiresOn || [_expiresOn timeIntervalSinceNow] <= 0)
+        {
+            return NO;
+        }
+        
+        if (information)
+        {
+            *information = _information;
+        }
+        
+        return YES;
+    }
+}
+
+- (void)setInformation:(ADRegistrationInformation *)information
+{
+    @synchronized(self)
+    {
+        if (_lifetime <= 0)
+        {
+            return;
+        }
+        
+        _information = information;
+        _expiresOn = [NSDate dateWithTimeIntervalSinceNow:_lifetime];
+    }
+}
+
+- (void)clear
+{
+    @synchronized(self)
+    {
+        _information = nil;
+        _expiresOn = nil;
+    }
+}
+
+@end
@@ -27,6 +27,8 @@
 
 @interface ADWorkPlaceJoinUtil : NSObject
 
+/*! The workplace join registration of the device, nil if it isn't joined. Lookups are
+ reused for a short while, see ADRegistrationInformationCache. */
 + (ADRegistrationInformation*)getRegistrationInformation:(id<MSIDRequestContext>)context
                                                    error:(ADAuthenticationError * __autoreleasing *)error;
 
@@ -24,6 +24,7 @@
 #import "ADWorkPlaceJoinUtil.h"
 #import "ADKeychainUtil.h"
 #import "ADRegistrationInformation.h"
+#import "ADRegistrationInformationCache.h"
 #import "ADWorkPlaceJoinConstants.h"
 #import "ADErrorCodes.h"
 #import "ADAL_Internal.h"
@@ -53,6 +54,32 @@
 
 + (ADRegistrationInformation*)getRegistrationInformation:(id<MSIDRequestContext>)context
                                                    error:(ADAuthenticationError * __autoreleasing *)error
+{
+    ADRegistrationInformation *info = nil;
+    if ([[ADRegistrationInformationCache sharedCache] getInformation:&info])
+    {
+        MSID_LOG_VERBOSE(context, @"Using cached registration information");
+        return info;
+    }
+    
+    ADAuthenticationError *adError = nil;
+    info = [self registrationInformationFromKeychain:context error:&adError];
+    
+    if (adError)
+    {
+        if (error)
+        {
+            *error = adError;
+        }
+        return info;
+    }
+    
+    [[ADRegistrationInformationCache sharedCache] setInformation:info];
+    return info;
+}
+
++ (ADRegistrationInformation*)registrationInformationFromKeychain:(id<MSIDRequestContext>)context
+                                                            error:(ADAuthenticationError * __autoreleasing *)error
 {
     NSString* teamId = [ADKeychainUtil keychainTeamId:error];
 
@@ -155,6 +182,13 @@
                                                                                certificateSubject:certificateSubject
                                                                                   certificateData:certificateData
                                                                                        privateKey:privateKey];
+        
+        // The registration information retains what it holds on to, and now that it's kept
+        // around in the cache the references copied above must not leak with every lookup.
+        CFRelease(identity);
+        CFRelease(certificate);
+        CFRelease(privateKey);
+        
         return info;
     }
 _error:
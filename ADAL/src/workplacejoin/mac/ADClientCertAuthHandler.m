@@ -42,11 +42,6 @@
 
 @implementation ADClientCertAuthHandler
 
-+ (void)load
-{
-    [ADURLProtocol registerHandler:self authMethod:NSURLAuthenticationMethodClientCertificate];
-}
-
 + (void)resetHandler
 {
 }
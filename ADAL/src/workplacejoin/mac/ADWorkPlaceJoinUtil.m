@@ -25,14 +25,20 @@
 #import "ADKeychainUtil.h"
 #import "ADWorkPlaceJoinConstants.h"
 #import "ADRegistrationInformation.h"
+#import "ADRegistrationInformationCache.h"
 
 // Convenience macro for checking keychain status codes while looking up the WPJ information.
+// We don't send errors for errSecItemNotFound, not having WPJ information is an expected
+// case and the lookup has to come back clean for "not joined" to be cached.
 #define CHECK_KEYCHAIN_STATUS(OPERATION) \
 { \
   if (status != noErr) \
   { \
-    ADAuthenticationError* adError = [ADAuthenticationError keychainErrorFromOperation:OPERATION status:status correlationId:context.correlationId];\
-    if (error) { *error = adError; } \
+    if (status != errSecItemNotFound) \
+    { \
+      ADAuthenticationError* adError = [ADAuthenticationError keychainErrorFromOperation:OPERATION status:status correlationId:context.correlationId];\
+      if (error) { *error = adError; } \
+    } \
     goto _error; \
   } \
 }
@@ -41,8 +47,34 @@ static const UInt8 certificateIdentifier[] = "WorkPlaceJoin-Access\0";
 
 @implementation ADWorkPlaceJoinUtil
 
-+ (ADRegistrationInformation *)getRegistrationInformation:(id<MSIDRequestContext>)context
-                                                    error:(ADAuthenticationError * __autoreleasing *)error
++ (ADRegistrationInformation*)getRegistrationInformation:(id<MSIDRequestContext>)context
+                                                   error:(ADAuthenticationError * __autoreleasing *)error
+{
+    ADRegistrationInformation *info = nil;
+    if ([[ADRegistrationInformationCache sharedCache] getInformation:&info])
+    {
+        MSID_LOG_VERBOSE(context, @"Using cached registration information");
+        return info;
+    }
+    
+    ADAuthenticationError *adError = nil;
+    info = [self registrationInformationFromKeychain:context error:&adError];
+    
+    if (adError)
+    {
+        if (error)
+        {
+            *error = adError;
+        }
+        return info;
+    }
+    
+    [[ADRegistrationInformationCache sharedCache] setInformation:info];
+    return info;
+}
+
++ (ADRegistrationInformation *)registrationInformationFromKeychain:(id<MSIDRequestContext>)context
+                                                             error:(ADAuthenticationError * __autoreleasing *)error
 {
     ADRegistrationInformation *info = nil;
     SecIdentityRef identity = NULL;
@@ -95,6 +127,13 @@ static const UInt8 certificateIdentifier[] = "WorkPlaceJoin-Access\0";
         goto _error;
     }
     
+    // The certificate is of no use without its key, that's the same as not being joined
+    if (!privateKey)
+    {
+        MSID_LOG_WARN(context, @"WPJ certificate found without a private key, treating the device as not joined.");
+        goto _error;
+    }
+    
     if (!identity || !certificateIssuer || !certificateSubject || !certificateData || !privateKey)
     {
         // The code above will catch missing security items, but not missing item attributes. These are caught here.
@@ -29,6 +29,9 @@
 #import "ADTestCase.h"
 #import "ADClientMetrics.h"
 #import "ADAuthorityValidation+TestUtil.h"
+#import "ADRetryPolicy.h"
+#import "ADCircuitBreaker.h"
+#import "ADRegistrationInformationCache.h"
 
 #if TARGET_OS_IPHONE
 #import "ADApplicationTestUtil.h"
@@ -48,6 +51,9 @@
     [ADTestURLSession clearResponses];
     [[ADClientMetrics getInstance] clearMetrics];
     [ADAuthorityValidation clearAadCache];
+    [[ADRetryPolicy defaultPolicy] resetRetryBudgets];
+    [[ADCircuitBreaker sharedInstance] reset];
+    [[ADRegistrationInformationCache sharedCache] clear];
     
 #if TARGET_OS_IPHONE
     [ADApplicationTestUtil reset];
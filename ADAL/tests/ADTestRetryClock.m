@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "ADTestRetryClock.h"
+
+@implementation ADTestRetryClock
+
+- (id)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _currentDate = [NSDate dateWithTimeIntervalSince1970:1500000000];
+    _delays = [NSMutableArray new];
+    
+    return self;
+}
+
+- (NSDate *)now
+{
+    @synchronized(self)
+    {
+        return _currentDate;
+    }
+}
+
+- (void)advanceBy:(NSTimeInterval)interval
+{
+    @synchronized(self)
+    {
+        _currentDate = [_currentDate dateByAddingTimeInterval:interval];
+    }
+}
+
+- (dispatch_queue_t)lastQueue
+{
+    @synchronized(self)
+    {
+        return _lastQueue;
+    }
+}
+
+- (void)dispatchAfter:(NSTimeInterval)delay queue:(dispatch_queue_t)queue block:(dispatch_block_t)block
+{
+    @synchronized(self)
+    {
+        [_delays addObject:@(delay)];
+        _lastQueue = queue;
+    }
+    
+    [self advanceBy:delay];
+    dispatch_async(queue, block);
+}
+
+@end
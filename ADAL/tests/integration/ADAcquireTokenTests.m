@@ -45,6 +45,10 @@
 #import "ADTokenCacheKey.h"
 #import "MSIDBaseToken.h"
 #import "MSIDAADV1Oauth2Factory.h"
+#import "ADCircuitBreaker.h"
+#import "ADRequestDeadline.h"
+#import "ADTestRetryClock.h"
+#import "ADCancellationHandle.h"
 
 #if TARGET_OS_IPHONE
 #import "MSIDKeychainTokenCache+MSIDTestsUtil.h"
@@ -1561,6 +1565,502 @@ const int sAsyncContextTimeout = 10;
     XCTAssertTrue([ADTestURLSession noResponsesLeft]);
 }
 
+- (void)testResilencyTokenReturn_whenTokenEndpointKeepsFailing_shouldSkipNetworkOnceBreakerOpens
+{
+    ADAuthenticationError* error = nil;
+    ADAuthenticationContext* context = [self getTestAuthenticationContext];
+    id<ADTokenCacheDataSource> cache = self.cacheDataSource;
+    XCTestExpectation* expectation = [self expectationWithDescription:@"acquireTokenWithResource"];
+
+    // Add an MRRT to the cache
+    [cache addOrUpdateItem:[self adCreateMRRTCacheItem] correlationId:nil error:&error];
+    XCTAssertNil(error);
+
+    // Response with ext_expires_in value
+    [ADTestURLSession addResponse:[self adResponseRefreshToken:TEST_REFRESH_TOKEN
+                                                        authority:TEST_AUTHORITY
+                                                         resource:TEST_RESOURCE
+                                                         clientId:TEST_CLIENT_ID
+                                                    correlationId:TEST_CORRELATION_ID
+                                                  newRefreshToken:@"refresh token"
+                                                   newAccessToken:@"access token"
+                                                    newIDToken:[self adDefaultIDToken]
+                                                 additionalFields:@{ @"ext_expires_in" : @"3600"}]];
+
+    [context acquireTokenWithResource:TEST_RESOURCE
+                             clientId:TEST_CLIENT_ID
+                          redirectUri:TEST_REDIRECT_URL
+                               userId:TEST_USER_ID
+                      completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_SUCCEEDED);
+         XCTAssertNil(result.error);
+         XCTAssertEqualObjects(result.authority, TEST_AUTHORITY);
+
+         [expectation fulfill];
+     }];
+
+    [self waitForExpectations:@[expectation] timeout:1];
+
+    // retrieve the AT from cache
+    ADTokenCacheKey* atKey = [ADTokenCacheKey keyWithAuthority:TEST_AUTHORITY
+                                                        resource:TEST_RESOURCE
+                                                        clientId:TEST_CLIENT_ID
+                                                           error:&error];
+    XCTAssertNotNil(atKey);
+    XCTAssertNil(error);
+
+    ADTokenCacheItem* atItem = [cache getItemWithKey:atKey userId:TEST_USER_ID correlationId:nil error:&error];
+    XCTAssertNotNil(atItem);
+    XCTAssertNil(error);
+
+    // Make sure ext_expires_on is in the AT and set with proper value
+    NSDate* extExpires = [atItem.additionalServer valueForKey:@"ext_expires_on"];
+    NSDate* expectedExpiresTime = [NSDate dateWithTimeIntervalSinceNow:3600];
+    XCTAssertNotNil(extExpires);
+    XCTAssertTrue([expectedExpiresTime timeIntervalSinceDate:extExpires]<10); // 10 secs as tolerance
+
+    // Purposely expire the AT
+    atItem.expiresOn = [NSDate date];
+    [cache addOrUpdateItem:atItem correlationId:nil error:&error];
+    XCTAssertNil(error);
+
+    // Trip the breaker on the first outage
+    [ADCircuitBreaker sharedInstance].failureThreshold = 1;
+
+    // Test resiliency when response code 500 ... 599 happens
+    ADTestURLResponse* response = [ADTestURLResponse requestURLString:[NSString stringWithFormat:@"%@/oauth2/token?x-client-Ver=" ADAL_VERSION_STRING, TEST_AUTHORITY]
+                                                    responseURLString:@"https://contoso.com"
+                                                         responseCode:504
+                                                     httpHeaderFields:@{ }
+                                                     dictionaryAsJSON:@{ }];
+    [response setRequestHeaders:[ADTestURLResponse defaultHeaders]];
+    [response setUrlFormEncodedBody:@{ @"resource" : TEST_RESOURCE,
+                                       @"client_id" : TEST_CLIENT_ID,
+                                       @"grant_type" : @"refresh_token",
+                                       MSID_OAUTH2_CLIENT_INFO: @"1",
+                                       MSID_OAUTH2_SCOPE: MSID_OAUTH2_SCOPE_OPENID_VALUE,
+                                       @"refresh_token" : TEST_REFRESH_TOKEN }];
+
+    // Add the responsce twice because retry will happen
+    [ADTestURLSession addResponse:response];
+    [ADTestURLSession addResponse:response];
+
+    expectation = [self expectationWithDescription:@"acquireTokenWithResource"];
+
+    // Test whether valid stale access token is returned
+    [context setExtendedLifetimeEnabled:YES];
+    [context acquireTokenWithResource:TEST_RESOURCE
+                             clientId:TEST_CLIENT_ID
+                          redirectUri:TEST_REDIRECT_URL
+                               userId:TEST_USER_ID
+                      completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_SUCCEEDED);
+         XCTAssertNil(result.error);
+         XCTAssertTrue(result.extendedLifeTimeToken);
+         XCTAssertEqualObjects(result.tokenCacheItem.accessToken, @"access token");
+         XCTAssertEqualObjects(result.authority, TEST_AUTHORITY);
+
+         [expectation fulfill];
+     }];
+
+    [self waitForExpectations:@[expectation] timeout:1];
+
+    XCTAssertTrue([ADTestURLSession noResponsesLeft]);
+    XCTAssertEqual([[ADCircuitBreaker sharedInstance] stateForHost:@"login.windows.net"], ADCircuitBreakerStateOpen);
+
+    // No responses are added, the breaker is open so the stale token should come back without a request
+    expectation = [self expectationWithDescription:@"acquireTokenWithResource"];
+
+    [context acquireTokenWithResource:TEST_RESOURCE
+                             clientId:TEST_CLIENT_ID
+                          redirectUri:TEST_REDIRECT_URL
+                               userId:TEST_USER_ID
+                      completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_SUCCEEDED);
+         XCTAssertTrue(result.extendedLifeTimeToken);
+         XCTAssertEqualObjects(result.tokenCacheItem.accessToken, @"access token");
+
+         [expectation fulfill];
+     }];
+
+    [self waitForExpectations:@[expectation] timeout:1];
+
+    [ADCircuitBreaker sharedInstance].failureThreshold = 3;
+}
+
+- (void)openCircuitBreakerAndAcquireTokenSilentWithProbeError:(NSError *)probeError
+{
+    ADAuthenticationError* error = nil;
+    ADAuthenticationContext* context = [self getTestAuthenticationContext];
+    id<ADTokenCacheDataSource> cache = self.cacheDataSource;
+    XCTestExpectation* expectation = [self expectationWithDescription:@"acquireTokenWithResource"];
+
+    // Get an AT with ext_expires_in through the MRRT
+    [cache addOrUpdateItem:[self adCreateMRRTCacheItem] correlationId:nil error:&error];
+    XCTAssertNil(error);
+
+    [ADTestURLSession addResponse:[self adResponseRefreshToken:TEST_REFRESH_TOKEN
+                                                        authority:TEST_AUTHORITY
+                                                         resource:TEST_RESOURCE
+                                                         clientId:TEST_CLIENT_ID
+                                                    correlationId:TEST_CORRELATION_ID
+                                                  newRefreshToken:TEST_REFRESH_TOKEN
+                                                   newAccessToken:@"access token"
+                                                    newIDToken:[self adDefaultIDToken]
+                                                 additionalFields:@{ @"ext_expires_in" : @"3600"}]];
+
+    [context acquireTokenWithResource:TEST_RESOURCE
+                             clientId:TEST_CLIENT_ID
+                          redirectUri:TEST_REDIRECT_URL
+                               userId:TEST_USER_ID
+                      completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertEqual(result.status, AD_SUCCEEDED);
+         [expectation fulfill];
+     }];
+
+    [self waitForExpectations:@[expectation] timeout:1];
+
+    // Purposely expire the AT, it stays good in terms of extended lifetime
+    ADTokenCacheKey* atKey = [ADTokenCacheKey keyWithAuthority:TEST_AUTHORITY
+                                                        resource:TEST_RESOURCE
+                                                        clientId:TEST_CLIENT_ID
+                                                           error:&error];
+    ADTokenCacheItem* atItem = [cache getItemWithKey:atKey userId:TEST_USER_ID correlationId:nil error:&error];
+    XCTAssertNotNil(atItem);
+    atItem.expiresOn = [NSDate date];
+    [cache addOrUpdateItem:atItem correlationId:nil error:&error];
+    XCTAssertNil(error);
+
+    // Open the breaker and let the next request through right away as the probe
+    ADCircuitBreaker *breaker = [ADCircuitBreaker sharedInstance];
+    breaker.failureThreshold = 1;
+    breaker.openInterval = 0;
+    [breaker recordResultForHost:@"login.windows.net" serverUnavailable:YES context:nil];
+    XCTAssertEqual([breaker stateForHost:@"login.windows.net"], ADCircuitBreakerStateOpen);
+
+    ADTestURLResponse* response =
+    [ADTestURLResponse request:[NSURL URLWithString:TEST_AUTHORITY "/oauth2/token?x-client-Ver=" ADAL_VERSION_STRING]
+              respondWithError:probeError];
+    [response setRequestHeaders:[ADTestURLResponse defaultHeaders]];
+    [response setUrlFormEncodedBody:@{ @"resource" : TEST_RESOURCE,
+                                       @"client_id" : TEST_CLIENT_ID,
+                                       @"grant_type" : @"refresh_token",
+                                       MSID_OAUTH2_CLIENT_INFO: @"1",
+                                       MSID_OAUTH2_SCOPE: MSID_OAUTH2_SCOPE_OPENID_VALUE,
+                                       @"refresh_token" : TEST_REFRESH_TOKEN }];
+    [ADTestURLSession addResponse:response];
+
+    expectation = [self expectationWithDescription:@"acquireTokenSilentWithResource"];
+
+    [context setExtendedLifetimeEnabled:YES];
+    [context acquireTokenSilentWithResource:TEST_RESOURCE
+                                   clientId:TEST_CLIENT_ID
+                                redirectUri:TEST_REDIRECT_URL
+                                     userId:TEST_USER_ID
+                            completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_FAILED);
+         XCTAssertEqualObjects(result.error.domain, NSURLErrorDomain);
+         XCTAssertEqual(result.error.code, probeError.code);
+
+         [expectation fulfill];
+     }];
+
+    [self waitForExpectations:@[expectation] timeout:1];
+
+    XCTAssertTrue([ADTestURLSession noResponsesLeft]);
+}
+
+- (void)testAcquireTokenSilent_whenCircuitBreakerProbeCancelled_shouldStayHalfOpenAndAllowNextProbe
+{
+    [self openCircuitBreakerAndAcquireTokenSilentWithProbeError:[NSError errorWithDomain:NSURLErrorDomain
+                                                                                    code:NSURLErrorCancelled
+                                                                                userInfo:nil]];
+
+    ADCircuitBreaker *breaker = [ADCircuitBreaker sharedInstance];
+    XCTAssertEqual([breaker stateForHost:@"login.windows.net"], ADCircuitBreakerStateHalfOpen);
+    XCTAssertTrue([breaker shouldAllowRequestToHost:@"login.windows.net" context:nil]);
+
+    breaker.failureThreshold = 3;
+    breaker.openInterval = 30;
+}
+
+- (void)testAcquireTokenSilent_whenCircuitBreakerProbeOffline_shouldStayHalfOpenAndAllowNextProbe
+{
+    [self openCircuitBreakerAndAcquireTokenSilentWithProbeError:[NSError errorWithDomain:NSURLErrorDomain
+                                                                                    code:NSURLErrorNotConnectedToInternet
+                                                                                userInfo:nil]];
+
+    ADCircuitBreaker *breaker = [ADCircuitBreaker sharedInstance];
+    XCTAssertEqual([breaker stateForHost:@"login.windows.net"], ADCircuitBreakerStateHalfOpen);
+    XCTAssertTrue([breaker shouldAllowRequestToHost:@"login.windows.net" context:nil]);
+
+    breaker.failureThreshold = 3;
+    breaker.openInterval = 30;
+}
+
+- (void)testAcquireTokenSilent_whenStaleWhileRevalidateAndExtendedLifetimeToken_shouldReturnStaleTokenAndRefreshInBackground
+{
+    ADAuthenticationError* error = nil;
+    ADAuthenticationContext* context = [self getTestAuthenticationContext];
+    id<ADTokenCacheDataSource> cache = self.cacheDataSource;
+    XCTestExpectation* expectation = [self expectationWithDescription:@"acquireTokenWithResource"];
+
+    // Add an MRRT to the cache
+    [cache addOrUpdateItem:[self adCreateMRRTCacheItem] correlationId:nil error:&error];
+    XCTAssertNil(error);
+
+    // Response with ext_expires_in value
+    [ADTestURLSession addResponse:[self adResponseRefreshToken:TEST_REFRESH_TOKEN
+                                                        authority:TEST_AUTHORITY
+                                                         resource:TEST_RESOURCE
+                                                         clientId:TEST_CLIENT_ID
+                                                    correlationId:TEST_CORRELATION_ID
+                                                  newRefreshToken:@"refresh token"
+                                                   newAccessToken:@"access token"
+                                                    newIDToken:[self adDefaultIDToken]
+                                                 additionalFields:@{ @"ext_expires_in" : @"3600"}]];
+
+    [context acquireTokenWithResource:TEST_RESOURCE
+                             clientId:TEST_CLIENT_ID
+                          redirectUri:TEST_REDIRECT_URL
+                               userId:TEST_USER_ID
+                      completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_SUCCEEDED);
+         XCTAssertNil(result.error);
+         XCTAssertEqualObjects(result.authority, TEST_AUTHORITY);
+
+         [expectation fulfill];
+     }];
+
+    [self waitForExpectations:@[expectation] timeout:1];
+
+    // retrieve the AT from cache
+    ADTokenCacheKey* atKey = [ADTokenCacheKey keyWithAuthority:TEST_AUTHORITY
+                                                        resource:TEST_RESOURCE
+                                                        clientId:TEST_CLIENT_ID
+                                                           error:&error];
+    XCTAssertNotNil(atKey);
+    XCTAssertNil(error);
+
+    ADTokenCacheItem* atItem = [cache getItemWithKey:atKey userId:TEST_USER_ID correlationId:nil error:&error];
+    XCTAssertNotNil(atItem);
+    XCTAssertNil(error);
+
+    // Make sure ext_expires_on is in the AT and set with proper value
+    NSDate* extExpires = [atItem.additionalServer valueForKey:@"ext_expires_on"];
+    NSDate* expectedExpiresTime = [NSDate dateWithTimeIntervalSinceNow:3600];
+    XCTAssertNotNil(extExpires);
+    XCTAssertTrue([expectedExpiresTime timeIntervalSinceDate:extExpires]<10); // 10 secs as tolerance
+
+    // Purposely expire the AT
+    atItem.expiresOn = [NSDate date];
+    [cache addOrUpdateItem:atItem correlationId:nil error:&error];
+    XCTAssertNil(error);
+
+    [ADTestURLSession addResponse:[self adResponseRefreshToken:TEST_REFRESH_TOKEN
+                                                     authority:TEST_AUTHORITY
+                                                      resource:TEST_RESOURCE
+                                                      clientId:TEST_CLIENT_ID
+                                                 correlationId:TEST_CORRELATION_ID
+                                               newRefreshToken:@"refresh token"
+                                                newAccessToken:@"new access token"
+                                                    newIDToken:[self adDefaultIDToken]
+                                              additionalFields:@{ @"ext_expires_in" : @"3600"}]];
+
+    expectation = [self expectationWithDescription:@"acquireTokenSilentWithResource"];
+
+    // The stale token should come back without waiting for the refresh
+    [context acquireTokenSilentWithResource:TEST_RESOURCE
+                                   clientId:TEST_CLIENT_ID
+                                redirectUri:TEST_REDIRECT_URL
+                                     userId:TEST_USER_ID
+                       staleWhileRevalidate:YES
+                            completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_SUCCEEDED);
+         XCTAssertTrue(result.extendedLifeTimeToken);
+         XCTAssertEqualObjects(result.tokenCacheItem.accessToken, @"access token");
+
+         [expectation fulfill];
+     }];
+
+    [self waitForExpectations:@[expectation] timeout:1];
+
+    // The background refresh should land the new token in the cache
+    NSPredicate *refreshed = [NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, __unused NSDictionary *bindings)
+    {
+        ADTokenCacheItem *item = [evaluatedObject getItemWithKey:atKey userId:TEST_USER_ID correlationId:nil error:nil];
+        return [item.accessToken isEqualToString:@"new access token"];
+    }];
+    [self waitForExpectations:@[[self expectationForPredicate:refreshed evaluatedWithObject:cache handler:nil]] timeout:1];
+
+    XCTAssertTrue([ADTestURLSession noResponsesLeft]);
+}
+
+- (ADAuthenticationRequest *)silentRequestWithDeadline:(ADRequestDeadline *)deadline
+{
+    ADAuthenticationContext *context = [self getTestAuthenticationContext];
+    ADRequestParameters *params = [[ADRequestParameters alloc] initWithAuthority:context.authority
+                                                                        resource:TEST_RESOURCE
+                                                                        clientId:TEST_CLIENT_ID
+                                                                     redirectUri:TEST_REDIRECT_URL.absoluteString
+                                                                      identifier:[ADUserIdentifier identifierWithId:TEST_USER_ID]
+                                                                extendedLifetime:NO
+                                                                   correlationId:TEST_CORRELATION_ID
+                                                              telemetryRequestId:nil
+                                                                    logComponent:nil];
+    
+    ADAuthenticationRequest *req = [ADAuthenticationRequest requestWithContext:context
+                                                                 requestParams:params
+                                                                    tokenCache:self.tokenCache
+                                                                         error:nil];
+    [req setSilent:YES];
+    [req setDeadline:deadline];
+    
+    return req;
+}
+
+- (void)testAcquireTokenSilent_whenDeadlinePassed_shouldFailWithoutHittingNetwork
+{
+    ADAuthenticationError* error = nil;
+    XCTestExpectation* expectation = [self expectationWithDescription:@"acquireToken"];
+    
+    // An MRRT would normally be redeemed over the network
+    XCTAssertTrue([self.cacheDataSource addOrUpdateItem:[self adCreateMRRTCacheItem] correlationId:nil error:&error]);
+    XCTAssertNil(error);
+    
+    ADTestRetryClock *clock = [ADTestRetryClock new];
+    ADRequestDeadline *deadline = [[ADRequestDeadline alloc] initWithTimeout:5 clock:clock];
+    [clock advanceBy:6];
+    
+    ADAuthenticationRequest *req = [self silentRequestWithDeadline:deadline];
+    [req acquireToken:@"test" completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_FAILED);
+         XCTAssertEqualObjects(result.error.domain, NSURLErrorDomain);
+         XCTAssertEqual(result.error.code, NSURLErrorTimedOut);
+         
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    
+    // The MRRT is left alone
+    NSArray* allItems = [self.cacheDataSource allItems:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual(allItems.count, 1);
+}
+
+- (void)testAcquireTokenSilent_whenServerAsksToRetryPastDeadline_shouldFailFast
+{
+    ADAuthenticationError* error = nil;
+    XCTestExpectation* expectation = [self expectationWithDescription:@"acquireToken"];
+    
+    XCTAssertTrue([self.cacheDataSource addOrUpdateItem:[self adCreateMRRTCacheItem] correlationId:nil error:&error]);
+    XCTAssertNil(error);
+    
+    ADTestRetryClock *clock = [ADTestRetryClock new];
+    ADRequestDeadline *deadline = [[ADRequestDeadline alloc] initWithTimeout:3 clock:clock];
+    
+    // Without a deadline the Retry-After would be waited for and the request sent again
+    ADTestURLResponse* response = [ADTestURLResponse requestURLString:[NSString stringWithFormat:@"%@/oauth2/token?x-client-Ver=" ADAL_VERSION_STRING, TEST_AUTHORITY]
+                                                    responseURLString:@"https://contoso.com"
+                                                         responseCode:503
+                                                     httpHeaderFields:@{ @"Retry-After" : @"5" }
+                                                     dictionaryAsJSON:@{ }];
+    [response setRequestHeaders:[ADTestURLResponse defaultHeaders]];
+    [response setUrlFormEncodedBody:@{ @"resource" : TEST_RESOURCE,
+                                       @"client_id" : TEST_CLIENT_ID,
+                                       @"grant_type" : @"refresh_token",
+                                       MSID_OAUTH2_CLIENT_INFO: @"1",
+                                       MSID_OAUTH2_SCOPE: MSID_OAUTH2_SCOPE_OPENID_VALUE,
+                                       @"refresh_token" : TEST_REFRESH_TOKEN }];
+    [ADTestURLSession addResponse:response];
+    
+    ADAuthenticationRequest *req = [self silentRequestWithDeadline:deadline];
+    [req acquireToken:@"test" completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_FAILED);
+         XCTAssertNotNil(result.error);
+         
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    XCTAssertTrue([ADTestURLSession noResponsesLeft]);
+    XCTAssertEqualWithAccuracy([deadline remainingTime], 3, 0.0001);
+}
+
+- (void)testAcquireTokenSilent_whenCancelled_shouldReturnCancelledResultWithoutHittingNetwork
+{
+    ADAuthenticationError* error = nil;
+    XCTestExpectation* expectation = [self expectationWithDescription:@"acquireToken"];
+    
+    XCTAssertTrue([self.cacheDataSource addOrUpdateItem:[self adCreateMRRTCacheItem] correlationId:nil error:&error]);
+    XCTAssertNil(error);
+    
+    ADAuthenticationRequest *req = [self silentRequestWithDeadline:nil];
+    ADCancellationHandle *handle = [ADCancellationHandle new];
+    [[req requestParams] setCancellationHandle:handle];
+    [handle cancel];
+    
+    [req acquireToken:@"test" completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertNotNil(result);
+         XCTAssertEqual(result.status, AD_USER_CANCELLED);
+         XCTAssertEqualObjects(result.error.domain, ADAuthenticationErrorDomain);
+         XCTAssertEqual(result.error.code, AD_ERROR_REQUEST_CANCELLED);
+         
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    
+    NSArray* allItems = [self.cacheDataSource allItems:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual(allItems.count, 1);
+}
+
+- (void)testAcquireTokenSilent_shouldReturnCancellationHandle
+{
+    ADAuthenticationContext* context = [self getTestAuthenticationContext];
+    XCTestExpectation* expectation = [self expectationWithDescription:@"acquireTokenSilentWithResource"];
+    
+    // Nothing in the cache, so this fails without going to the network
+    ADCancellationHandle *handle = [context acquireTokenSilentWithResource:TEST_RESOURCE
+                                                                  clientId:TEST_CLIENT_ID
+                                                               redirectUri:TEST_REDIRECT_URL
+                                                                    userId:TEST_USER_ID
+                                                           completionBlock:^(ADAuthenticationResult *result)
+                                    {
+                                        XCTAssertEqual(result.status, AD_FAILED);
+                                        XCTAssertEqual(result.error.code, AD_ERROR_SERVER_USER_INPUT_NEEDED);
+                                        
+                                        [expectation fulfill];
+                                    }];
+    
+    XCTAssertNotNil(handle);
+    [self waitForExpectations:@[expectation] timeout:1];
+    
+    // Cancelling a finished request is harmless
+    [handle cancel];
+    XCTAssertTrue(handle.isCancelled);
+}
+
 - (void)testResilencyTokenDeletion
 {
     ADAuthenticationError* error = nil;
@@ -2542,4 +3042,62 @@ const int sAsyncContextTimeout = 10;
 }
 #endif
 
+#pragma mark - Prewarm
+
+- (void)testPrewarm_shouldLeaveNoValidationForFirstSilentCall
+{
+    ADAuthenticationContext *context = [[ADAuthenticationContext alloc] initWithAuthority:TEST_AUTHORITY
+                                                                        validateAuthority:YES
+                                                                                    error:nil];
+    context.tokenCache = self.tokenCache;
+    [context setCorrelationId:TEST_CORRELATION_ID];
+    
+    [ADTestURLSession addResponse:[ADTestAuthorityValidationResponse validAuthority:TEST_AUTHORITY]];
+    
+    XCTestExpectation *prewarmExpectation = [self expectationWithDescription:@"prewarm"];
+    [context prewarmWithCompletionBlock:^
+     {
+         [prewarmExpectation fulfill];
+     }];
+    [self waitForExpectations:@[prewarmExpectation] timeout:1];
+    XCTAssertTrue([ADTestURLSession noResponsesLeft]);
+    
+    // Only the token request goes out, validation is answered from the cache
+    ADAuthenticationError *error = nil;
+    [self.cacheDataSource addOrUpdateItem:[self adCreateMRRTCacheItem] correlationId:nil error:&error];
+    XCTAssertNil(error);
+    [ADTestURLSession addResponse:[self adDefaultRefreshResponse:@"new refresh token" accessToken:@"new access token" newIDToken:[self adDefaultIDToken]]];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"acquireTokenSilentWithResource"];
+    [context acquireTokenSilentWithResource:TEST_RESOURCE
+                                   clientId:TEST_CLIENT_ID
+                                redirectUri:TEST_REDIRECT_URL
+                                     userId:TEST_USER_ID
+                            completionBlock:^(ADAuthenticationResult *result)
+     {
+         XCTAssertEqual(result.status, AD_SUCCEEDED);
+         XCTAssertEqualObjects(result.accessToken, @"new access token");
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+- (void)testPrewarm_whenADFSNotValidated_shouldCompleteWithoutRequests
+{
+    ADAuthenticationContext *context = [[ADAuthenticationContext alloc] initWithAuthority:@"https://login.contoso.com/adfs"
+                                                                        validateAuthority:NO
+                                                                                    error:nil];
+    
+    // Validation answers not validated without an error and nothing goes out
+    XCTestExpectation *prewarmExpectation = [self expectationWithDescription:@"prewarm"];
+    [context prewarmWithCompletionBlock:^
+     {
+         [prewarmExpectation fulfill];
+     }];
+    [self waitForExpectations:@[prewarmExpectation] timeout:1];
+    
+    XCTAssertTrue([ADTestURLSession noResponsesLeft]);
+}
+
 @end
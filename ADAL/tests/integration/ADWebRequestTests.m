@@ -0,0 +1,484 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <XCTest/XCTest.h>
+#import "XCTestCase+TestHelperMethods.h"
+#import "ADWebRequest.h"
+#import "ADWebAuthRequest.h"
+#import "ADWebResponse.h"
+#import "ADMSIDContext.h"
+#import "ADHelpers.h"
+#import "ADTestURLSession.h"
+#import "ADTestURLResponse.h"
+
+static NSString * const kTestEndpoint = @"https://login.windows.net/contoso.com/oauth2/token";
+static NSString * const kTestDiscoveryEndpoint = @"https://login.windows.net/common/discovery/instance";
+
+@interface ADWebRequest (TestSend)
+
+- (void)send;
+
+@end
+
+// Injected network delays, handed out in order to each request as it goes out. The requests
+// are kept in the order they were sent in, so tests can tell the original from the hedge.
+static NSArray<NSNumber *> *s_injectedDelays = nil;
+static NSUInteger s_injectedDelayIndex = 0;
+static NSMutableArray *s_sentRequests = nil;
+
+@interface ADDelayedWebAuthRequest : ADWebAuthRequest
+
+@property BOOL wasCancelled;
+
+@end
+
+@implementation ADDelayedWebAuthRequest
+
+- (void)cancel
+{
+    self.wasCancelled = YES;
+    [super cancel];
+}
+
+- (void)send
+{
+    NSTimeInterval delay = 0;
+    
+    @synchronized([ADDelayedWebAuthRequest class])
+    {
+        if (s_injectedDelays.count)
+        {
+            delay = s_injectedDelays[s_injectedDelayIndex++ % s_injectedDelays.count].doubleValue;
+        }
+        
+        [s_sentRequests addObject:self];
+    }
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [super send];
+    });
+}
+
+@end
+
+@interface ADWebRequestTests : ADTestCase
+
+@end
+
+@implementation ADWebRequestTests
+
+- (void)setUp
+{
+    [super setUp];
+}
+
+- (void)tearDown
+{
+    [super tearDown];
+}
+
+- (ADTestURLResponse *)responseForCorrelationId:(NSUUID *)correlationId
+{
+    NSMutableDictionary *headers = [[ADTestURLResponse defaultHeaders] mutableCopy];
+    headers[MSID_OAUTH2_CORRELATION_ID_REQUEST_VALUE] = [correlationId UUIDString];
+    
+    ADTestURLResponse *response = [ADTestURLResponse requestURLString:[kTestEndpoint stringByAppendingString:@"?x-client-Ver=" ADAL_VERSION_STRING]
+                                                    responseURLString:@"https://contoso.com"
+                                                         responseCode:200
+                                                     httpHeaderFields:@{}
+                                                     dictionaryAsJSON:@{}];
+    [response setRequestHeaders:headers];
+    
+    return response;
+}
+
+- (ADTestURLResponse *)responseForCorrelationId:(NSUUID *)correlationId
+                                    contentType:(NSString *)contentType
+                                           body:(NSData *)body
+{
+    ADTestURLResponse *response = [self responseForCorrelationId:correlationId];
+    [response setResponseURL:@"https://contoso.com" code:200 headerFields:@{ @"Content-Type" : contentType }];
+    [response setResponseData:body];
+    
+    return response;
+}
+
+- (NSData *)largeHTMLPage
+{
+    NSMutableString *page = [NSMutableString stringWithString:@"<html><body>"];
+    for (NSUInteger i = 0; i < 20000; i++)
+    {
+        [page appendString:@"<p>Service unavailable</p>"];
+    }
+    [page appendString:@"</body></html>"];
+    
+    return [page dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (void)sendRequest:(ADWebRequest *)request
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request send:^(NSError *error, ADWebResponse *response)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqual(response.statusCode, 200);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+}
+
+#pragma mark - Tests
+
+- (void)testAddClientVersionToURL_whenCalledTwice_shouldReturnSameURL
+{
+    NSURL *url = [NSURL URLWithString:kTestEndpoint];
+    
+    NSURL *versionedURL = [ADHelpers addClientVersionToURL:url];
+    
+    XCTAssertEqualObjects(versionedURL.absoluteString, [kTestEndpoint stringByAppendingString:@"?x-client-Ver=" ADAL_VERSION_STRING]);
+    XCTAssertEqual([ADHelpers addClientVersionToURL:url], versionedURL);
+    XCTAssertEqual([ADHelpers addClientVersionToURL:versionedURL], versionedURL);
+}
+
+- (void)testAddClientVersionToURL_whenQueryPresent_shouldAppendVersion
+{
+    NSURL *url = [NSURL URLWithString:[kTestEndpoint stringByAppendingString:@"?api-version=1.0"]];
+    
+    NSURL *versionedURL = [ADHelpers addClientVersionToURL:url];
+    
+    XCTAssertEqualObjects(versionedURL.absoluteString, [kTestEndpoint stringByAppendingString:@"?api-version=1.0&x-client-Ver=" ADAL_VERSION_STRING]);
+}
+
+- (void)testSend_shouldSendDefaultAndCorrelationHeaders
+{
+    NSUUID *correlationId = [NSUUID UUID];
+    [ADTestURLSession addResponse:[self responseForCorrelationId:correlationId]];
+    
+    ADMSIDContext *context = [[ADMSIDContext alloc] initWithCorrelationId:correlationId];
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:context];
+    request.isGetRequest = YES;
+    
+    [self sendRequest:request];
+    [request invalidate];
+}
+
+- (void)testCancel_whenCalledFromManyThreadsWhileSending_shouldCompleteOnce
+{
+    NSUUID *correlationId = [NSUUID UUID];
+    [ADTestURLSession addResponse:[self responseForCorrelationId:correlationId]];
+    
+    ADMSIDContext *context = [[ADMSIDContext alloc] initWithCorrelationId:correlationId];
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:context];
+    request.isGetRequest = YES;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request send:^(NSError *error, __unused ADWebResponse *response)
+     {
+         // Depending on who wins, the response made it or the task got cancelled
+         XCTAssertTrue(!error || error.code == NSURLErrorCancelled);
+         [expectation fulfill];
+     }];
+    
+    dispatch_apply(16, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(__unused size_t i) {
+        [request cancel];
+    });
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+    [ADTestURLSession clearResponses];
+}
+
+- (void)testResend_shouldSendSameHeadersAndURL
+{
+    NSUUID *correlationId = [NSUUID UUID];
+    [ADTestURLSession addResponses:@[[self responseForCorrelationId:correlationId], [self responseForCorrelationId:correlationId]]];
+    
+    ADMSIDContext *context = [[ADMSIDContext alloc] initWithCorrelationId:correlationId];
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:context];
+    request.isGetRequest = YES;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send and resend"];
+    __block NSUInteger callCount = 0;
+    __weak ADWebRequest *weakRequest = request;
+    
+    [request send:^(NSError *error, ADWebResponse *response)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqual(response.statusCode, 200);
+         
+         if (++callCount == 1)
+         {
+             [weakRequest resend];
+             return;
+         }
+         
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+}
+
+- (void)testSend_whenJSONExpectedAndHTMLReturned_shouldDiscardBodyAndKeepStatus
+{
+    NSUUID *correlationId = [NSUUID UUID];
+    [ADTestURLSession addResponse:[self responseForCorrelationId:correlationId
+                                                     contentType:@"text/html; charset=utf-8"
+                                                            body:[self largeHTMLPage]]];
+    
+    ADMSIDContext *context = [[ADMSIDContext alloc] initWithCorrelationId:correlationId];
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:context];
+    request.isGetRequest = YES;
+    request.expectsJSONResponse = YES;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request send:^(NSError *error, ADWebResponse *response)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqual(response.statusCode, 200);
+         XCTAssertEqual(response.body.length, 0);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+}
+
+- (void)testSend_whenJSONNotExpectedAndHTMLReturned_shouldReturnBody
+{
+    NSUUID *correlationId = [NSUUID UUID];
+    NSData *page = [self largeHTMLPage];
+    [ADTestURLSession addResponse:[self responseForCorrelationId:correlationId
+                                                     contentType:@"text/html"
+                                                            body:page]];
+    
+    ADMSIDContext *context = [[ADMSIDContext alloc] initWithCorrelationId:correlationId];
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:context];
+    request.isGetRequest = YES;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request send:^(NSError *error, ADWebResponse *response)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqualObjects(response.body, page);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+}
+
+- (void)testSend_whenJRDResponseExpectedAsJSON_shouldReturnBody
+{
+    NSUUID *correlationId = [NSUUID UUID];
+    NSData *body = [@"{\"subject\":\"https://fs.contoso.com\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    [ADTestURLSession addResponse:[self responseForCorrelationId:correlationId
+                                                     contentType:@"application/jrd+json"
+                                                            body:body]];
+    
+    ADMSIDContext *context = [[ADMSIDContext alloc] initWithCorrelationId:correlationId];
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:context];
+    request.isGetRequest = YES;
+    request.expectsJSONResponse = YES;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request send:^(NSError *error, ADWebResponse *response)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqualObjects(response.body, body);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+}
+
+- (void)testSend_whenResponseExceedsMaxSize_shouldFailWithDataLengthExceedsMaximum
+{
+    NSUUID *correlationId = [NSUUID UUID];
+    [ADTestURLSession addResponse:[self responseForCorrelationId:correlationId
+                                                     contentType:@"text/html"
+                                                            body:[self largeHTMLPage]]];
+    
+    ADMSIDContext *context = [[ADMSIDContext alloc] initWithCorrelationId:correlationId];
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:context];
+    request.isGetRequest = YES;
+    request.maxResponseSize = 1024;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request send:^(NSError *error, ADWebResponse *response)
+     {
+         XCTAssertNil(response);
+         XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+         XCTAssertEqual(error.code, NSURLErrorDataLengthExceedsMaximum);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+}
+
+#pragma mark - Hedging
+
+- (void)addDiscoveryResponseWithCode:(NSInteger)code endpoint:(NSString *)endpoint
+{
+    ADTestURLResponse *response = [ADTestURLResponse requestURLString:[kTestDiscoveryEndpoint stringByAppendingString:@"?x-client-Ver=" ADAL_VERSION_STRING]
+                                                    responseURLString:@"https://contoso.com"
+                                                         responseCode:code
+                                                     httpHeaderFields:@{}
+                                                     dictionaryAsJSON:@{ @"tenant_discovery_endpoint" : endpoint }];
+    [ADTestURLSession addResponse:response];
+}
+
+// Responses are handed out in the order requests reach the server, the delays are chosen so
+// that order is known up front.
+- (NSArray<ADDelayedWebAuthRequest *> *)sendHedgedRequestWithDelays:(NSArray<NSNumber *> *)delays
+                                                         hedgeDelay:(NSTimeInterval)hedgeDelay
+                                                         completion:(ADWebResponseCallback)completionBlock
+{
+    @synchronized([ADDelayedWebAuthRequest class])
+    {
+        s_injectedDelays = delays;
+        s_injectedDelayIndex = 0;
+        s_sentRequests = [NSMutableArray new];
+    }
+    
+    ADDelayedWebAuthRequest *request = [[ADDelayedWebAuthRequest alloc] initWithURL:[NSURL URLWithString:kTestDiscoveryEndpoint] context:nil];
+    request.isGetRequest = YES;
+    request.retryPolicy = nil;
+    request.hedgeDelay = hedgeDelay;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"hedged request"];
+    
+    [request sendRequest:^(ADAuthenticationError *error, NSMutableDictionary *response)
+     {
+         completionBlock(error, response);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:2];
+    [request invalidate];
+    [ADTestURLSession clearResponses];
+    
+    NSArray *sentRequests = nil;
+    @synchronized([ADDelayedWebAuthRequest class])
+    {
+        sentRequests = [s_sentRequests copy];
+        s_injectedDelays = nil;
+        s_sentRequests = nil;
+    }
+    
+    return sentRequests;
+}
+
+- (void)testSendRequest_whenHedgedAndOriginalSlow_shouldUseHedgeAndCancelOriginal
+{
+    // The hedge reaches the server first and gets the first response
+    [self addDiscoveryResponseWithCode:200 endpoint:@"hedge"];
+    [self addDiscoveryResponseWithCode:200 endpoint:@"original"];
+    
+    __block NSString *endpoint = nil;
+    NSArray<ADDelayedWebAuthRequest *> *sent = [self sendHedgedRequestWithDelays:@[@(0.5), @(0)]
+                                                                      hedgeDelay:0.05
+                                                                      completion:^(ADAuthenticationError *error, NSMutableDictionary *response)
+                                                {
+                                                    XCTAssertNil(error);
+                                                    endpoint = response[@"tenant_discovery_endpoint"];
+                                                }];
+    
+    XCTAssertEqualObjects(endpoint, @"hedge");
+    XCTAssertEqual(sent.count, 2);
+    XCTAssertTrue(sent[0].wasCancelled);
+    XCTAssertFalse(sent[1].wasCancelled);
+}
+
+- (void)testSendRequest_whenHedgedAndOriginalFailsFirst_shouldWaitForHedge
+{
+    // The original reaches the server first and fails, the hedge still answers after that
+    [self addDiscoveryResponseWithCode:500 endpoint:@"original"];
+    [self addDiscoveryResponseWithCode:200 endpoint:@"hedge"];
+    
+    __block ADAuthenticationError *resultError = nil;
+    __block NSString *endpoint = nil;
+    NSArray<ADDelayedWebAuthRequest *> *sent = [self sendHedgedRequestWithDelays:@[@(0.1), @(0.3)]
+                                                                      hedgeDelay:0.02
+                                                                      completion:^(ADAuthenticationError *error, NSMutableDictionary *response)
+                                                {
+                                                    resultError = error;
+                                                    endpoint = response[@"tenant_discovery_endpoint"];
+                                                }];
+    
+    XCTAssertNil(resultError);
+    XCTAssertEqualObjects(endpoint, @"hedge");
+    XCTAssertEqual(sent.count, 2);
+    XCTAssertFalse(sent[0].wasCancelled);
+    XCTAssertFalse(sent[1].wasCancelled);
+}
+
+- (void)testSendRequest_whenHedgedAndBothFail_shouldReturnFirstError
+{
+    [self addDiscoveryResponseWithCode:500 endpoint:@"original"];
+    [self addDiscoveryResponseWithCode:503 endpoint:@"hedge"];
+    
+    __block ADAuthenticationError *resultError = nil;
+    NSArray<ADDelayedWebAuthRequest *> *sent = [self sendHedgedRequestWithDelays:@[@(0.1), @(0.3)]
+                                                                      hedgeDelay:0.02
+                                                                      completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+                                                {
+                                                    resultError = error;
+                                                }];
+    
+    XCTAssertNotNil(resultError);
+    XCTAssertEqual(resultError.code, 500);
+    XCTAssertEqual(sent.count, 2);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformance_constructAndSend
+{
+    NSUUID *correlationId = [NSUUID UUID];
+    ADMSIDContext *context = [[ADMSIDContext alloc] initWithCorrelationId:correlationId];
+    NSURL *url = [NSURL URLWithString:kTestEndpoint];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 50; i++)
+        {
+            [ADTestURLSession addResponse:[self responseForCorrelationId:correlationId]];
+            
+            ADWebRequest *request = [[ADWebRequest alloc] initWithURL:url context:context];
+            request.isGetRequest = YES;
+            [self sendRequest:request];
+            [request invalidate];
+        }
+    }];
+}
+
+@end
@@ -42,9 +42,37 @@
 
 - (void)tearDown
 {
+    [[ADAuthenticationSettings sharedInstance] setResourceChallengeCacheLifetime:0];
+    [ADAuthenticationParameters clearChallengeCache];
+    
     [super tearDown];
 }
 
+- (ADTestURLResponse *)challengeResponseWithAuthority:(NSString *)authority
+{
+    NSString *header = [NSString stringWithFormat:@"Bearer authorization_uri=\"%@\"", authority];
+    return [ADTestURLResponse requestURLString:@"https://testapi007.azurewebsites.net/api/WorkItem?x-client-Ver=" ADAL_VERSION_STRING
+                             responseURLString:@"https://contoso.com"
+                                  responseCode:HTTP_UNAUTHORIZED
+                              httpHeaderFields:@{@"WWW-Authenticate" : header }
+                              dictionaryAsJSON:@{}];
+}
+
+- (void)parametersFromResourceUrlExpectingAuthority:(NSString *)authority
+{
+    NSURL *resourceUrl = [NSURL URLWithString:@"https://testapi007.azurewebsites.net/api/WorkItem"];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Get parameters for valid resourceUrl."];
+    
+    [ADAuthenticationParameters parametersFromResourceUrl:resourceUrl completionBlock:^(ADAuthenticationParameters *parameters, ADAuthenticationError *error)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqualObjects(parameters.authority, authority);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+}
+
 #pragma mark - Initialization
 
 - (void)testNew_shouldThrow
@@ -150,6 +178,68 @@
     [self waitForExpectationsWithTimeout:1 handler:nil];
 }
 
+#pragma mark - Challenge cache
+
+- (void)testParametersFromResourceUrl_whenCacheLifetimeSet_shouldReuseChallengeForHost
+{
+    [[ADAuthenticationSettings sharedInstance] setResourceChallengeCacheLifetime:300];
+    [ADTestURLSession addResponse:[self challengeResponseWithAuthority:@"https://login.windows.net/omercantest.onmicrosoft.com"]];
+    
+    [self parametersFromResourceUrlExpectingAuthority:@"https://login.windows.net/omercantest.onmicrosoft.com"];
+    // No response queued for the second call
+    [self parametersFromResourceUrlExpectingAuthority:@"https://login.windows.net/omercantest.onmicrosoft.com"];
+}
+
+- (void)testParametersFromResourceUrl_whenCacheLifetimeNotSet_shouldSendRequestEachTime
+{
+    [ADTestURLSession addResponse:[self challengeResponseWithAuthority:@"https://login.windows.net/first.onmicrosoft.com"]];
+    [self parametersFromResourceUrlExpectingAuthority:@"https://login.windows.net/first.onmicrosoft.com"];
+    
+    [ADTestURLSession addResponse:[self challengeResponseWithAuthority:@"https://login.windows.net/second.onmicrosoft.com"]];
+    [self parametersFromResourceUrlExpectingAuthority:@"https://login.windows.net/second.onmicrosoft.com"];
+}
+
+- (void)testParametersFromResourceUrl_whenCalledConcurrently_shouldShareOneRequest
+{
+    NSURL *resourceUrl = [NSURL URLWithString:@"https://testapi007.azurewebsites.net/api/WorkItem"];
+    [ADTestURLSession addResponse:[self challengeResponseWithAuthority:@"https://login.windows.net/omercantest.onmicrosoft.com"]];
+    
+    XCTestExpectation *first = [self expectationWithDescription:@"first"];
+    XCTestExpectation *second = [self expectationWithDescription:@"second"];
+    
+    [ADAuthenticationParameters parametersFromResourceUrl:resourceUrl completionBlock:^(ADAuthenticationParameters *parameters, ADAuthenticationError *error)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqualObjects(parameters.authority, @"https://login.windows.net/omercantest.onmicrosoft.com");
+         [first fulfill];
+     }];
+    [ADAuthenticationParameters parametersFromResourceUrl:resourceUrl completionBlock:^(ADAuthenticationParameters *parameters, ADAuthenticationError *error)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqualObjects(parameters.authority, @"https://login.windows.net/omercantest.onmicrosoft.com");
+         [second fulfill];
+     }];
+    
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+}
+
+- (void)testParametersFromResponse_whenChallengeChanged_shouldReplaceCachedParameters
+{
+    [[ADAuthenticationSettings sharedInstance] setResourceChallengeCacheLifetime:300];
+    [ADTestURLSession addResponse:[self challengeResponseWithAuthority:@"https://login.windows.net/first.onmicrosoft.com"]];
+    [self parametersFromResourceUrlExpectingAuthority:@"https://login.windows.net/first.onmicrosoft.com"];
+    
+    // A protected request comes back with another challenge
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"https://testapi007.azurewebsites.net/api/Other"]
+                                                              statusCode:HTTP_UNAUTHORIZED
+                                                             HTTPVersion:@"1.1"
+                                                            headerFields:@{ @"WWW-Authenticate" : @"Bearer authorization_uri=\"https://login.windows.net/second.onmicrosoft.com\"" }];
+    ADAuthenticationParameters *parameters = [ADAuthenticationParameters parametersFromResponse:response error:nil];
+    XCTAssertEqualObjects(parameters.authority, @"https://login.windows.net/second.onmicrosoft.com");
+    
+    [self parametersFromResourceUrlExpectingAuthority:@"https://login.windows.net/second.onmicrosoft.com"];
+}
+
 #pragma mark - parametersFromResponse
 
 - (void)testParametersFromResponse_whenResponseNilErrorPointerIsProvided_shouldReturnErrorAndNilParameters
@@ -600,4 +690,18 @@
     XCTAssertNotNil(error);
 }
 
+#pragma mark - Performance
+
+- (void)testPerformance_extractChallengeParameters
+{
+    NSString *challengeString = @"Basic realm=\"https://contoso.com/\", Bearer authorization_uri=\"https://login.microsoftonline.com/72f988bf-86f1-41af-91ab-2d7cd011db47\", error=\"invalid_token\", error_description=\"The access token is missing, expired or invalid\", resource_id=\"https://contoso.com/api\", TFS-Federated";
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [ADAuthenticationParameters extractChallengeParameters:challengeString error:nil];
+        }
+    }];
+}
+
 @end
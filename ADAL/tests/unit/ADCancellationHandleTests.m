@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <XCTest/XCTest.h>
+#import "ADCancellationHandle+Internal.h"
+#import "ADWebAuthRequest.h"
+#import "XCTestCase+TestHelperMethods.h"
+
+@interface ADCancellationHandleTests : ADTestCase
+
+@end
+
+@implementation ADCancellationHandleTests
+
+- (void)testCancel_shouldRunCancellationBlocksOnce
+{
+    ADCancellationHandle *handle = [ADCancellationHandle new];
+    __block NSUInteger calls = 0;
+    
+    [handle addCancellationBlock:^{ ++calls; }];
+    XCTAssertFalse(handle.isCancelled);
+    XCTAssertEqual(calls, 0);
+    
+    [handle cancel];
+    XCTAssertTrue(handle.isCancelled);
+    XCTAssertEqual(calls, 1);
+    
+    [handle cancel];
+    XCTAssertEqual(calls, 1);
+}
+
+- (void)testAddCancellationBlock_whenAlreadyCancelled_shouldRunRightAway
+{
+    ADCancellationHandle *handle = [ADCancellationHandle new];
+    [handle cancel];
+    
+    __block BOOL called = NO;
+    [handle addCancellationBlock:^{ called = YES; }];
+    
+    XCTAssertTrue(called);
+}
+
+- (void)testSendRequest_whenHandleCancelled_shouldFailWithoutHittingNetwork
+{
+    ADCancellationHandle *handle = [ADCancellationHandle new];
+    [handle cancel];
+    
+    ADWebAuthRequest *request = [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:@"https://login.windows.net/contoso.com/oauth2/token"] context:nil];
+    request.cancellationHandle = handle;
+    request.requestDictionary = @{ MSID_OAUTH2_GRANT_TYPE : MSID_OAUTH2_REFRESH_TOKEN };
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    // No responses are set up, the mock network fails the test if the request goes out
+    [request sendRequest:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNotNil(error);
+         XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+         XCTAssertEqual(error.code, NSURLErrorCancelled);
+         
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    XCTAssertEqual(request.attempts, 1);
+    [request invalidate];
+}
+
+@end
@@ -0,0 +1,183 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <XCTest/XCTest.h>
+#import "ADCircuitBreaker.h"
+#import "XCTestCase+TestHelperMethods.h"
+
+static NSString * const kTestHost = @"login.windows.net";
+
+@interface ADCircuitBreakerTests : ADTestCase
+
+@end
+
+@implementation ADCircuitBreakerTests
+
+- (void)setUp
+{
+    [super setUp];
+}
+
+- (void)tearDown
+{
+    [super tearDown];
+}
+
+- (ADCircuitBreaker *)breakerWithThreshold:(NSUInteger)threshold openInterval:(NSTimeInterval)openInterval
+{
+    ADCircuitBreaker *breaker = [ADCircuitBreaker new];
+    breaker.failureThreshold = threshold;
+    breaker.openInterval = openInterval;
+    
+    return breaker;
+}
+
+- (void)recordFailures:(NSUInteger)count breaker:(ADCircuitBreaker *)breaker
+{
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        [breaker recordResultForHost:kTestHost serverUnavailable:YES context:nil];
+    }
+}
+
+- (void)testShouldAllowRequest_whenUnknownHost_shouldAllow
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:3 openInterval:30];
+    
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateClosed);
+}
+
+- (void)testRecordResult_whenFailuresBelowThreshold_shouldStayClosed
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:3 openInterval:30];
+    
+    [self recordFailures:2 breaker:breaker];
+    
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateClosed);
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+}
+
+- (void)testRecordResult_whenSuccessInBetween_shouldResetFailureCount
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:3 openInterval:30];
+    
+    [self recordFailures:2 breaker:breaker];
+    [breaker recordResultForHost:kTestHost serverUnavailable:NO context:nil];
+    [self recordFailures:2 breaker:breaker];
+    
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateClosed);
+}
+
+- (void)testRecordResult_whenThresholdReached_shouldOpenAndRejectRequests
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:3 openInterval:30];
+    
+    [self recordFailures:3 breaker:breaker];
+    
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateOpen);
+    XCTAssertFalse([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    
+    // Other hosts aren't affected
+    XCTAssertTrue([breaker shouldAllowRequestToHost:@"login.microsoftonline.com" context:nil]);
+}
+
+- (void)testShouldAllowRequest_whenOpenIntervalPassed_shouldLetOneProbeThrough
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:1 openInterval:0];
+    
+    [self recordFailures:1 breaker:breaker];
+    
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateHalfOpen);
+    XCTAssertFalse([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    XCTAssertFalse([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+}
+
+- (void)testRecordResult_whenProbeSucceeds_shouldClose
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:1 openInterval:0];
+    
+    [self recordFailures:1 breaker:breaker];
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    
+    [breaker recordResultForHost:kTestHost serverUnavailable:NO context:nil];
+    
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateClosed);
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+}
+
+- (void)testRecordResult_whenProbeFails_shouldReopen
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:1 openInterval:0];
+    
+    [self recordFailures:1 breaker:breaker];
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    
+    breaker.openInterval = 30;
+    [breaker recordResultForHost:kTestHost serverUnavailable:YES context:nil];
+    
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateOpen);
+    XCTAssertFalse([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+}
+
+- (void)testRecordNoResponse_whenProbeGotNoResponse_shouldStayHalfOpenAndLetNextProbeThrough
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:1 openInterval:0];
+    
+    [self recordFailures:1 breaker:breaker];
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    XCTAssertFalse([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    
+    [breaker recordNoResponseForHost:kTestHost];
+    
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateHalfOpen);
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+    XCTAssertFalse([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+}
+
+- (void)testRecordNoResponse_whenClosed_shouldNotCountAsFailure
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:2 openInterval:30];
+    
+    [self recordFailures:1 breaker:breaker];
+    [breaker recordNoResponseForHost:kTestHost];
+    [breaker recordNoResponseForHost:kTestHost];
+    
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateClosed);
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+}
+
+- (void)testReset_shouldCloseAllBreakers
+{
+    ADCircuitBreaker *breaker = [self breakerWithThreshold:1 openInterval:30];
+    
+    [self recordFailures:1 breaker:breaker];
+    [breaker reset];
+    
+    XCTAssertEqual([breaker stateForHost:kTestHost], ADCircuitBreakerStateClosed);
+    XCTAssertTrue([breaker shouldAllowRequestToHost:kTestHost context:nil]);
+}
+
+@end
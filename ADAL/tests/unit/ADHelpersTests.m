@@ -22,9 +22,26 @@
 // THE SOFTWARE.
 
 #import <XCTest/XCTest.h>
+#import <CommonCrypto/CommonHMAC.h>
 #import "ADHelpers.h"
+#import "ADRequestParameters.h"
+#import "ADWebRequest.h"
 #import "XCTestCase+TestHelperMethods.h"
 
+#define TEST_JWT_HEADER @{ @"alg" : @"HS256", @"typ" : @"JWT", @"ctx" : @"dGhpc2lzYWNvbnRleHQ=" }
+#define TEST_JWT_PAYLOAD @{ @"aud" : @"https://login.windows.net/common/oauth2/token", @"iss" : @"c3c7f5e5-7153-44d4-90e6-329686d48d76", @"grant_type" : @"refresh_token", @"refresh_token" : @"refresh token", @"request_nonce" : @"nonce", @"iat" : @"1387224169", @"nbf" : @"1387224169", @"exp" : @"1387227769" }
+
+static NSString *ADHexStringFromData(NSData *data)
+{
+    NSMutableString *hex = [NSMutableString new];
+    const uint8_t *bytes = data.bytes;
+    for (NSUInteger i = 0; i < data.length; i++)
+    {
+        [hex appendFormat:@"%02x", bytes[i]];
+    }
+    return hex;
+}
+
 @interface ADHelpersTests : ADTestCase
 
 @end
@@ -122,4 +139,171 @@
     ADAssertStringEquals([ADHelpers getUPNSuffix:@"user@microsoft.com"], @"microsoft.com");
 }
 
+#pragma mark - Quality of service
+
+- (void)testQosClassForQualityOfService_shouldMapEachClass
+{
+    XCTAssertEqual([ADHelpers qosClassForQualityOfService:NSQualityOfServiceUserInteractive], QOS_CLASS_USER_INTERACTIVE);
+    XCTAssertEqual([ADHelpers qosClassForQualityOfService:NSQualityOfServiceUserInitiated], QOS_CLASS_USER_INITIATED);
+    XCTAssertEqual([ADHelpers qosClassForQualityOfService:NSQualityOfServiceUtility], QOS_CLASS_UTILITY);
+    XCTAssertEqual([ADHelpers qosClassForQualityOfService:NSQualityOfServiceBackground], QOS_CLASS_BACKGROUND);
+    XCTAssertEqual([ADHelpers qosClassForQualityOfService:NSQualityOfServiceDefault], QOS_CLASS_UNSPECIFIED);
+}
+
+- (void)testTaskPriorityForQOSClass_shouldFavourInteractiveClasses
+{
+    XCTAssertEqual([ADHelpers taskPriorityForQOSClass:QOS_CLASS_USER_INITIATED], NSURLSessionTaskPriorityHigh);
+    XCTAssertEqual([ADHelpers taskPriorityForQOSClass:QOS_CLASS_UTILITY], NSURLSessionTaskPriorityLow);
+    XCTAssertEqual([ADHelpers taskPriorityForQOSClass:QOS_CLASS_UNSPECIFIED], NSURLSessionTaskPriorityDefault);
+}
+
+- (void)testBlockWithQOSClass_whenUnspecified_shouldReturnBlock
+{
+    dispatch_block_t block = ^{};
+    XCTAssertEqual([ADHelpers block:block withQOSClass:QOS_CLASS_UNSPECIFIED], block);
+}
+
+- (void)testBlockWithQOSClass_whenQueueHasLowerClass_shouldRaiseToClass
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"block ran"];
+    __block qos_class_t qosClass = QOS_CLASS_UNSPECIFIED;
+    
+    dispatch_block_t block = [ADHelpers block:^{
+        qosClass = qos_class_self();
+        [expectation fulfill];
+    } withQOSClass:QOS_CLASS_USER_INITIATED];
+    dispatch_async([ADHelpers globalQueueForQOSClass:QOS_CLASS_UTILITY], block);
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqual(qosClass, QOS_CLASS_USER_INITIATED);
+}
+
+- (void)testGlobalQueueForQOSClass_whenLowerThanSubmitter_shouldRunAtClass
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"block ran"];
+    __block qos_class_t qosClass = QOS_CLASS_UNSPECIFIED;
+    
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        dispatch_async([ADHelpers globalQueueForQOSClass:QOS_CLASS_UTILITY], ^{
+            qosClass = qos_class_self();
+            [expectation fulfill];
+        });
+    });
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqual(qosClass, QOS_CLASS_UTILITY);
+}
+
+- (void)testWebRequestInitWithContext_whenContextHasQOSClass_shouldPickItUp
+{
+    ADRequestParameters *params = [ADRequestParameters new];
+    params.qosClass = QOS_CLASS_USER_INITIATED;
+    
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:@"https://login.windows.net/common"] context:params];
+    XCTAssertEqual(request.qosClass, QOS_CLASS_USER_INITIATED);
+    XCTAssertEqual(request.session.delegateQueue.qualityOfService, NSQualityOfServiceUserInitiated);
+    
+    // Copies of the parameters keep the class
+    XCTAssertEqual([params copy].qosClass, QOS_CLASS_USER_INITIATED);
+    
+    [request invalidate];
+}
+
+#pragma mark - KDF
+
+- (void)testComputeKDFInCounterMode_shouldMatchSP800108Output
+{
+    NSData *key = [@"0123456789abcdef0123456789abcdef" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    NSData *derivedKey = [ADHelpers computeKDFInCounterMode:key context:[@"context" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertEqualObjects(ADHexStringFromData(derivedKey), @"1d63a47dec67bc89b52bcec37b0ccade0218c238119d2606c163617c2a591313");
+    
+    derivedKey = [ADHelpers computeKDFInCounterMode:key context:[NSData data]];
+    XCTAssertEqualObjects(ADHexStringFromData(derivedKey), @"0fc2d4b47e60d81695f5982eb0e1f009373085c0fae4104138318bc7f845aa4c");
+}
+
+#pragma mark - JWS
+
+- (void)testAppendBase64UrlEncodedBytes_shouldMatchUnpaddedBase64Url
+{
+    NSArray *inputs = @[ @"", @"f", @"fo", @"foo", @"foob", @"fooba", @"foobar", @"\u00ff\u00fe\u00fd" ];
+    NSArray *expected = @[ @"", @"Zg", @"Zm8", @"Zm9v", @"Zm9vYg", @"Zm9vYmE", @"Zm9vYmFy", @"w7_DvsO9" ];
+    
+    for (NSUInteger i = 0; i < inputs.count; i++)
+    {
+        NSData *input = [inputs[i] dataUsingEncoding:NSUTF8StringEncoding];
+        NSMutableData *output = [NSMutableData dataWithBytes:"x" length:1];
+        [ADHelpers appendBase64UrlEncodedBytes:input.bytes length:input.length toData:output];
+        
+        NSString *outputString = [[NSString alloc] initWithData:output encoding:NSASCIIStringEncoding];
+        XCTAssertEqualObjects(outputString, [@"x" stringByAppendingString:expected[i]]);
+        XCTAssertEqualObjects([outputString substringFromIndex:1], [inputs[i] msidBase64UrlEncode]);
+    }
+}
+
+- (void)testCreateSignedJWTUsingKeyDerivation_shouldBeCompactAndVerifiable
+{
+    NSData *key = [@"0123456789abcdef0123456789abcdef" dataUsingEncoding:NSUTF8StringEncoding];
+    NSString *jwt = [ADHelpers createSignedJWTUsingKeyDerivation:TEST_JWT_HEADER
+                                                         payload:TEST_JWT_PAYLOAD
+                                                         context:@"context"
+                                                    symmetricKey:key];
+    
+    NSArray *parts = [jwt componentsSeparatedByString:@"."];
+    XCTAssertEqual(parts.count, 3);
+    
+    NSString *header = [parts[0] msidBase64UrlDecode];
+    NSString *payload = [parts[1] msidBase64UrlDecode];
+    XCTAssertEqual([header rangeOfCharacterFromSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]].location, NSNotFound);
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:[header dataUsingEncoding:NSUTF8StringEncoding] options:0 error:nil], TEST_JWT_HEADER);
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:[payload dataUsingEncoding:NSUTF8StringEncoding] options:0 error:nil], TEST_JWT_PAYLOAD);
+    
+    NSData *derivedKey = [ADHelpers computeKDFInCounterMode:key context:[@"context" dataUsingEncoding:NSUTF8StringEncoding]];
+    NSData *signingInput = [[NSString stringWithFormat:@"%@.%@", parts[0], parts[1]] dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char hmac[CC_SHA256_DIGEST_LENGTH];
+    CCHmac(kCCHmacAlgSHA256, derivedKey.bytes, derivedKey.length, signingInput.bytes, signingInput.length, hmac);
+    XCTAssertEqualObjects(parts[2], [NSString msidBase64UrlEncodeData:[NSData dataWithBytes:hmac length:sizeof(hmac)]]);
+}
+
+- (void)testCreateJWSSigningInput_shouldBeSmallerThanPrettyPrinted
+{
+    NSData *prettyHeader = [NSJSONSerialization dataWithJSONObject:TEST_JWT_HEADER options:NSJSONWritingPrettyPrinted error:nil];
+    NSData *prettyPayload = [NSJSONSerialization dataWithJSONObject:TEST_JWT_PAYLOAD options:NSJSONWritingPrettyPrinted error:nil];
+    NSString *prettySigningInput = [NSString stringWithFormat:@"%@.%@", [NSString msidBase64UrlEncodeData:prettyHeader], [NSString msidBase64UrlEncodeData:prettyPayload]];
+    
+    NSData *signingInput = [ADHelpers createJWSSigningInputForHeader:TEST_JWT_HEADER payload:TEST_JWT_PAYLOAD];
+    
+    XCTAssertLessThan(signingInput.length, prettySigningInput.length);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformance_computeKDFInCounterMode
+{
+    NSData *key = [@"0123456789abcdef0123456789abcdef" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *context = [@"2b5ba3e3ad2ff1b9c2b0e2b64a7d4a53e41e2d4d4b8b5bfa7b5b8e1ae4e1e3c4" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [ADHelpers computeKDFInCounterMode:key context:context];
+        }
+    }];
+}
+
+- (void)testPerformance_createSignedJWTUsingKeyDerivation
+{
+    NSData *key = [@"0123456789abcdef0123456789abcdef" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            [ADHelpers createSignedJWTUsingKeyDerivation:TEST_JWT_HEADER
+                                                 payload:TEST_JWT_PAYLOAD
+                                                 context:@"context"
+                                            symmetricKey:key];
+        }
+    }];
+}
+
 @end
@@ -0,0 +1,245 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <XCTest/XCTest.h>
+#import "ADInstanceDiscoveryStore.h"
+#import "ADAuthorityValidation.h"
+#import "ADAuthorityValidation+TestUtil.h"
+#import "ADAuthenticationSettings.h"
+#import "ADRequestParameters.h"
+#import "MSIDAadAuthorityCache.h"
+#import "NSURL+MSIDExtensions.h"
+#import "XCTestCase+TestHelperMethods.h"
+#import "ADTestURLSession.h"
+#import "ADTestURLResponse.h"
+
+static NSString * const kTestAuthority = @"https://login.windows-ppe.net/common";
+
+@interface ADInstanceDiscoveryStoreTests : ADTestCase
+{
+    NSURL *_fileURL;
+}
+
+@end
+
+@implementation ADInstanceDiscoveryStoreTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    NSString *fileName = [NSString stringWithFormat:@"%@.json", [[NSUUID UUID] UUIDString]];
+    _fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtURL:_fileURL error:nil];
+    [[ADAuthenticationSettings sharedInstance] setInstanceDiscoveryCacheLifetime:0];
+    
+    [super tearDown];
+}
+
+- (NSArray *)testMetadata
+{
+    return @[ @{ @"preferred_network" : @"login.windows-ppe.net",
+                 @"preferred_cache" : @"login.windows-ppe.net",
+                 @"aliases" : @[ @"login.windows-ppe.net", @"sts.windows-ppe.net" ] } ];
+}
+
+- (ADAuthorityValidation *)validationWithStore:(ADInstanceDiscoveryStore *)store
+{
+    ADAuthorityValidation *authorityValidation = [[ADAuthorityValidation alloc] init];
+    authorityValidation.discoveryStore = store;
+    return authorityValidation;
+}
+
+- (void)validate:(ADAuthorityValidation *)authorityValidation
+{
+    ADRequestParameters *requestParams = [ADRequestParameters new];
+    requestParams.authority = kTestAuthority;
+    requestParams.correlationId = [NSUUID UUID];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Validate authority."];
+    [authorityValidation checkAuthority:requestParams
+                      validateAuthority:YES
+                        completionBlock:^(BOOL validated, ADAuthenticationError *error)
+     {
+         XCTAssertTrue(validated);
+         XCTAssertNil(error);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+}
+
+#pragma mark - Store
+
+- (void)testMetadataForAuthority_whenWrittenByEarlierInstance_shouldReturnIt
+{
+    NSURL *authority = [NSURL URLWithString:kTestAuthority];
+    
+    ADInstanceDiscoveryStore *store = [[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL];
+    [store setMetadata:[self testMetadata] forAuthority:authority expiresOn:[NSDate dateWithTimeIntervalSinceNow:3600]];
+    
+    // A new instance stands in for the next launch
+    ADInstanceDiscoveryStore *nextLaunch = [[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL];
+    XCTAssertEqualObjects([nextLaunch metadataForAuthority:[NSURL URLWithString:@"https://login.windows-ppe.net/contoso.com"]], [self testMetadata]);
+    XCTAssertNil([nextLaunch metadataForAuthority:[NSURL URLWithString:@"https://login.microsoftonline.com/common"]]);
+}
+
+- (void)testMetadataForAuthority_whenNoMetadata_shouldReturnEmptyArray
+{
+    NSURL *authority = [NSURL URLWithString:kTestAuthority];
+    
+    ADInstanceDiscoveryStore *store = [[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL];
+    [store setMetadata:nil forAuthority:authority expiresOn:[NSDate dateWithTimeIntervalSinceNow:3600]];
+    
+    XCTAssertEqualObjects([[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL] metadataForAuthority:authority], @[]);
+}
+
+- (void)testMetadataForAuthority_whenExpired_shouldReturnNil
+{
+    NSURL *authority = [NSURL URLWithString:kTestAuthority];
+    
+    ADInstanceDiscoveryStore *store = [[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL];
+    [store setMetadata:[self testMetadata] forAuthority:authority expiresOn:[NSDate dateWithTimeIntervalSinceNow:-1]];
+    
+    XCTAssertNil([store metadataForAuthority:authority]);
+    XCTAssertNil([[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL] metadataForAuthority:authority]);
+}
+
+- (void)testMetadataForAuthority_whenFileHasOtherVersion_shouldIgnoreIt
+{
+    NSDictionary *contents = @{ @"version" : @0,
+                                @"client_version" : ADAL_VERSION_NSSTRING,
+                                @"entries" : @{ @"login.windows-ppe.net" : @{ @"metadata" : [self testMetadata],
+                                                                              @"expires_on" : @([[NSDate distantFuture] timeIntervalSince1970]) } } };
+    [[NSJSONSerialization dataWithJSONObject:contents options:0 error:nil] writeToURL:_fileURL atomically:YES];
+    
+    ADInstanceDiscoveryStore *store = [[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL];
+    XCTAssertNil([store metadataForAuthority:[NSURL URLWithString:kTestAuthority]]);
+}
+
+- (void)testMetadataForAuthority_whenFileIsCorrupt_shouldIgnoreIt
+{
+    [[@"{ not json" dataUsingEncoding:NSUTF8StringEncoding] writeToURL:_fileURL atomically:YES];
+    
+    ADInstanceDiscoveryStore *store = [[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL];
+    XCTAssertNil([store metadataForAuthority:[NSURL URLWithString:kTestAuthority]]);
+}
+
+- (void)testMetadataForAuthority_whenEntryIsMalformed_shouldTreatItAsMiss
+{
+    NSTimeInterval expiresOn = [[NSDate distantFuture] timeIntervalSince1970];
+    NSDictionary *contents = @{ @"version" : @1,
+                                @"client_version" : ADAL_VERSION_NSSTRING,
+                                @"entries" : @{ @"login.windows-ppe.net" : @{ @"metadata" : @[ @{ @"aliases" : @[ @1 ] } ],
+                                                                              @"expires_on" : @(expiresOn) },
+                                                @"login.microsoftonline.com" : @{ @"metadata" : @[ @"not a record" ],
+                                                                                  @"expires_on" : @(expiresOn) },
+                                                @"login.windows.net" : @{ @"metadata" : [self testMetadata],
+                                                                          @"expires_on" : @(expiresOn) } } };
+    [[NSJSONSerialization dataWithJSONObject:contents options:0 error:nil] writeToURL:_fileURL atomically:YES];
+    
+    ADInstanceDiscoveryStore *store = [[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL];
+    XCTAssertNil([store metadataForAuthority:[NSURL URLWithString:kTestAuthority]]);
+    XCTAssertNil([store metadataForAuthority:[NSURL URLWithString:@"https://login.microsoftonline.com/common"]]);
+    XCTAssertEqualObjects([store metadataForAuthority:[NSURL URLWithString:@"https://login.windows.net/common"]], [self testMetadata]);
+}
+
+- (void)testRemoveMetadataForAuthority_shouldRemoveItFromFile
+{
+    NSURL *authority = [NSURL URLWithString:kTestAuthority];
+    
+    ADInstanceDiscoveryStore *store = [[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL];
+    [store setMetadata:[self testMetadata] forAuthority:authority expiresOn:[NSDate dateWithTimeIntervalSinceNow:3600]];
+    [store removeMetadataForAuthority:authority];
+    
+    XCTAssertNil([store metadataForAuthority:authority]);
+    XCTAssertNil([[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL] metadataForAuthority:authority]);
+}
+
+- (void)testDefaultStore_shouldBeScopedToApplication
+{
+    NSString *appDirectory = [[NSBundle mainBundle] bundleIdentifier] ?: [[NSProcessInfo processInfo] processName];
+    NSArray *components = [[ADInstanceDiscoveryStore defaultStore].fileURL pathComponents];
+    
+    XCTAssertTrue(components.count > 3);
+    XCTAssertEqualObjects(components[components.count - 3], appDirectory);
+    XCTAssertEqualObjects(components[components.count - 2], @"com.microsoft.adal");
+}
+
+#pragma mark - Authority validation
+
+- (void)testCheckAuthority_whenLifetimeSet_shouldValidateNextLaunchWithoutNetwork
+{
+    [[ADAuthenticationSettings sharedInstance] setInstanceDiscoveryCacheLifetime:3600];
+    
+    [ADTestURLSession addResponse:[ADTestAuthorityValidationResponse validAuthority:kTestAuthority withMetadata:[self testMetadata]]];
+    [self validate:[self validationWithStore:[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL]]];
+    
+    // Next launch: nothing in memory, no response queued
+    [ADAuthorityValidation clearAadCache];
+    ADAuthorityValidation *nextLaunch = [self validationWithStore:[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL]];
+    [self validate:nextLaunch];
+    
+    NSURL *authority = [NSURL URLWithString:kTestAuthority];
+    XCTAssertTrue([nextLaunch.aadCache tryCheckCache:authority.msidHostWithPortIfNecessary].validated);
+}
+
+- (void)testCheckAuthority_whenLifetimeNotSet_shouldNotWriteStore
+{
+    [ADTestURLSession addResponse:[ADTestAuthorityValidationResponse validAuthority:kTestAuthority]];
+    [self validate:[self validationWithStore:[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL]]];
+    
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:_fileURL.path]);
+}
+
+#pragma mark - Performance
+
+// Cold start: nothing in memory, so every iteration reads the file or goes to the (mocked) network
+- (void)testPerformance_coldStartValidation_network
+{
+    [self measureBlock:^{
+        [ADAuthorityValidation clearAadCache];
+        [ADTestURLSession addResponse:[ADTestAuthorityValidationResponse validAuthority:kTestAuthority withMetadata:[self testMetadata]]];
+        [self validate:[self validationWithStore:[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL]]];
+    }];
+}
+
+- (void)testPerformance_coldStartValidation_storedMetadata
+{
+    [[ADAuthenticationSettings sharedInstance] setInstanceDiscoveryCacheLifetime:3600];
+    [[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL] setMetadata:[self testMetadata]
+                                                                forAuthority:[NSURL URLWithString:kTestAuthority]
+                                                                   expiresOn:[NSDate dateWithTimeIntervalSinceNow:3600]];
+    
+    [self measureBlock:^{
+        [ADAuthorityValidation clearAadCache];
+        [self validate:[self validationWithStore:[[ADInstanceDiscoveryStore alloc] initWithFileURL:_fileURL]]];
+    }];
+}
+
+@end
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <XCTest/XCTest.h>
+#import <objc/runtime.h>
+#import "XCTestCase+TestHelperMethods.h"
+#import "ADAuthenticationContext.h"
+#import "ADTokenCacheItem+Internal.h"
+#import "ADURLProtocol.h"
+
+@interface ADLoadTimeTests : ADTestCase
+
+@end
+
+@implementation ADLoadTimeTests
+
+#pragma mark - Image load
+
+// Every +load method runs before main() in each app linking ADAL, so all of the setup ADAL
+// needs has to happen lazily on first use instead. The one exception is ADBrokerHelper, which
+// has to watch for the end of launch to catch broker responses sent to a relaunched app.
+- (void)testImageLoad_whenADALLinked_shouldOnlyImplementLoadInBrokerHelper
+{
+    NSSet *allowedClasses = [NSSet setWithObject:@"ADBrokerHelper"];
+    
+    const char *imageName = class_getImageName([ADAuthenticationContext class]);
+    XCTAssertTrue(imageName != NULL);
+    
+    unsigned int classCount = 0;
+    const char **classNames = objc_copyClassNamesForImage(imageName, &classCount);
+    XCTAssertTrue(classCount > 0);
+    
+    for (unsigned int i = 0; i < classCount; i++)
+    {
+        NSString *className = [NSString stringWithUTF8String:classNames[i]];
+        
+        // The test bundle can end up in the same image as ADAL
+        if (![className hasPrefix:@"AD"] || [className containsString:@"Test"] || [allowedClasses containsObject:className])
+        {
+            continue;
+        }
+        
+        unsigned int methodCount = 0;
+        Method *methods = class_copyMethodList(object_getClass(objc_getClass(classNames[i])), &methodCount);
+        
+        for (unsigned int j = 0; j < methodCount; j++)
+        {
+            XCTAssertFalse(sel_isEqual(method_getName(methods[j]), @selector(load)), @"%@ implements +load", className);
+        }
+        
+        free(methods);
+    }
+    
+    free(classNames);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformance_lazyInitialization_afterFirstUse
+{
+    // Pay for the first use once, the rest of the calls on the API paths should be free
+    [ADURLProtocol registerDefaultHandlers];
+    [ADTokenCacheItem setupArchiverClassNames];
+    
+    [self measureBlock:^{
+        for (int i = 0; i < 10000; i++)
+        {
+            [ADURLProtocol registerDefaultHandlers];
+            [ADTokenCacheItem setupArchiverClassNames];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <XCTest/XCTest.h>
+#import "ADPkeyAuthHelper.h"
+
+#define TEST_ISSUER @"CN=MS-Organization-Access, OU=82dbaca4-3e81-46ca-9c73-0950c1eaca97, DC=windows"
+#define TEST_CERT_AUTHORITIES @"OU=00000000-0000-0000-0000-000000000000,CN=MS-Organization-Access,DC=windows;OU=82DBACA4-3E81-46CA-9C73-0950C1EACA97,CN=MS-Organization-Access,DC=windows"
+
+@interface ADPkeyAuthHelperTests : ADTestCase
+
+@end
+
+@implementation ADPkeyAuthHelperTests
+
+#pragma mark - Thumbprint
+
+- (void)testComputeThumbprint_whenSha1_shouldReturnUppercaseHex
+{
+    NSData *data = [@"abc" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    XCTAssertEqualObjects([ADPkeyAuthHelper computeThumbprint:data], @"A9993E364706816ABA3E25717850C26C9CD0D89D");
+}
+
+- (void)testComputeThumbprint_whenSha2_shouldReturnUppercaseHex
+{
+    NSData *data = [@"abc" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    XCTAssertEqualObjects([ADPkeyAuthHelper computeThumbprint:data isSha2:YES], @"BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD");
+}
+
+#pragma mark - Issuer
+
+- (void)testGetOrgUnitFromIssuer_whenIssuerHasGuid_shouldReturnOU
+{
+    XCTAssertEqualObjects([ADPkeyAuthHelper getOrgUnitFromIssuer:TEST_ISSUER], @"OU=82dbaca4-3e81-46ca-9c73-0950c1eaca97");
+}
+
+- (void)testGetOrgUnitFromIssuer_whenGuidPrecededByHexDigits_shouldReturnFirstMatch
+{
+    XCTAssertEqualObjects([ADPkeyAuthHelper getOrgUnitFromIssuer:@"OU=a82dbaca4-3e81-46ca-9c73-0950c1eaca97"], @"OU=82dbaca4-3e81-46ca-9c73-0950c1eaca97");
+}
+
+- (void)testGetOrgUnitFromIssuer_whenNoGuid_shouldReturnNil
+{
+    XCTAssertNil([ADPkeyAuthHelper getOrgUnitFromIssuer:@"CN=MS-Organization-Access, OU=82dbaca4-3e81-46ca-9c73, DC=windows"]);
+    XCTAssertNil([ADPkeyAuthHelper getOrgUnitFromIssuer:@""]);
+    XCTAssertNil([ADPkeyAuthHelper getOrgUnitFromIssuer:nil]);
+}
+
+- (void)testIsValidIssuer_whenMatchingOUWithDifferentCase_shouldReturnYES
+{
+    XCTAssertTrue([ADPkeyAuthHelper isValidIssuer:TEST_CERT_AUTHORITIES
+                               keychainCertIssuer:@"OU=82dbaca4-3e81-46ca-9c73-0950c1eaca97"]);
+    XCTAssertTrue([ADPkeyAuthHelper isValidIssuer:[TEST_CERT_AUTHORITIES lowercaseString]
+                               keychainCertIssuer:@"OU=82DBACA4-3E81-46CA-9C73-0950C1EACA97"]);
+}
+
+- (void)testIsValidIssuer_whenNoMatchingOU_shouldReturnNO
+{
+    XCTAssertFalse([ADPkeyAuthHelper isValidIssuer:TEST_CERT_AUTHORITIES
+                                keychainCertIssuer:@"OU=11111111-3e81-46ca-9c73-0950c1eaca97"]);
+    XCTAssertFalse([ADPkeyAuthHelper isValidIssuer:TEST_CERT_AUTHORITIES
+                                keychainCertIssuer:@"82dbaca4-3e81-46ca-9c73-0950c1eaca97"]);
+    XCTAssertFalse([ADPkeyAuthHelper isValidIssuer:TEST_CERT_AUTHORITIES
+                                keychainCertIssuer:nil]);
+    XCTAssertFalse([ADPkeyAuthHelper isValidIssuer:nil
+                                keychainCertIssuer:@"OU=82dbaca4-3e81-46ca-9c73-0950c1eaca97"]);
+}
+
+#pragma mark - Performance
+
+// Everything createDeviceAuthResponse does to check a challenge against the
+// registration, the RSA signature of the response is not included.
+- (void)testPerformance_challengeValidation
+{
+    NSMutableData *certificateData = [NSMutableData dataWithLength:1024];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            NSString *issuerOU = [ADPkeyAuthHelper getOrgUnitFromIssuer:TEST_ISSUER];
+            [ADPkeyAuthHelper isValidIssuer:TEST_CERT_AUTHORITIES keychainCertIssuer:issuerOU];
+            [ADPkeyAuthHelper computeThumbprint:certificateData];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <XCTest/XCTest.h>
+#import "ADRegistrationInformationCache.h"
+#import "ADPkeyAuthHelper.h"
+#import "ADWorkPlaceJoinUtil.h"
+#import "XCTestCase+TestHelperMethods.h"
+
+@interface ADRegistrationInformationCacheTests : ADTestCase
+
+@end
+
+@implementation ADRegistrationInformationCacheTests
+
+- (void)tearDown
+{
+    [[ADRegistrationInformationCache sharedCache] setLifetime:300];
+    
+    [super tearDown];
+}
+
+#pragma mark - Cache
+
+- (void)testGetInformation_whenNothingCached_shouldReturnNO
+{
+    ADRegistrationInformationCache *cache = [ADRegistrationInformationCache new];
+    XCTAssertFalse([cache getInformation:nil]);
+}
+
+- (void)testGetInformation_whenNotJoinedCached_shouldReturnYESAndNil
+{
+    ADRegistrationInformationCache *cache = [ADRegistrationInformationCache new];
+    [cache setInformation:nil];
+    
+    ADRegistrationInformation *info = (ADRegistrationInformation *)@"not nil";
+    XCTAssertTrue([cache getInformation:&info]);
+    XCTAssertNil(info);
+}
+
+- (void)testGetInformation_whenCleared_shouldReturnNO
+{
+    ADRegistrationInformationCache *cache = [ADRegistrationInformationCache new];
+    [cache setInformation:nil];
+    [cache clear];
+    
+    XCTAssertFalse([cache getInformation:nil]);
+}
+
+- (void)testGetInformation_whenLifetimeZero_shouldNotCache
+{
+    ADRegistrationInformationCache *cache = [ADRegistrationInformationCache new];
+    cache.lifetime = 0;
+    [cache setInformation:nil];
+    
+    XCTAssertFalse([cache getInformation:nil]);
+}
+
+#if TARGET_OS_IPHONE
+- (void)testGetInformation_whenAppEntersForeground_shouldReturnNO
+{
+    ADRegistrationInformationCache *cache = [ADRegistrationInformationCache new];
+    [cache setInformation:nil];
+    
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationWillEnterForegroundNotification object:nil];
+    
+    XCTAssertFalse([cache getInformation:nil]);
+}
+#else
+- (void)testGetRegistrationInformation_whenNotJoined_shouldCacheNotJoined
+{
+    ADRegistrationInformationCache *cache = [ADRegistrationInformationCache sharedCache];
+    
+    // The test machine isn't workplace joined, the keychain lookup comes back with errSecItemNotFound
+    ADAuthenticationError *error = nil;
+    XCTAssertNil([ADWorkPlaceJoinUtil getRegistrationInformation:nil error:&error]);
+    XCTAssertNil(error);
+    
+    ADRegistrationInformation *info = (ADRegistrationInformation *)@"not nil";
+    XCTAssertTrue([cache getInformation:&info]);
+    XCTAssertNil(info);
+}
+#endif
+
+#pragma mark - Performance
+
+- (void)testPerformance_createDeviceAuthResponse_keychainLookup
+{
+    [[ADRegistrationInformationCache sharedCache] setLifetime:0];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100; i++)
+        {
+            [ADPkeyAuthHelper createDeviceAuthResponse:@"https://login.windows.net/common/oauth2/token"
+                                         challengeData:@{ @"nonce" : @"nonce", @"Context" : @"context", @"Version" : @"1.0" }
+                                               context:nil
+                                                 error:nil];
+        }
+    }];
+}
+
+- (void)testPerformance_createDeviceAuthResponse_cached
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100; i++)
+        {
+            [ADPkeyAuthHelper createDeviceAuthResponse:@"https://login.windows.net/common/oauth2/token"
+                                         challengeData:@{ @"nonce" : @"nonce", @"Context" : @"context", @"Version" : @"1.0" }
+                                               context:nil
+                                                 error:nil];
+        }
+    }];
+}
+
+@end
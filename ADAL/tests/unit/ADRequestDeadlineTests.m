@@ -0,0 +1,262 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <XCTest/XCTest.h>
+#import "ADRequestDeadline.h"
+#import "ADRetryPolicy.h"
+#import "ADWebAuthRequest.h"
+#import "ADRequestParameters.h"
+#import "XCTestCase+TestHelperMethods.h"
+#import "ADTestURLSession.h"
+#import "ADTestURLResponse.h"
+#import "ADTestRetryClock.h"
+#import "ADWebResponse.h"
+
+static NSString * const kTestEndpoint = @"https://login.windows.net/contoso.com/oauth2/token";
+
+@interface ADRequestDeadlineTests : ADTestCase
+{
+    ADTestRetryClock *_clock;
+}
+
+@end
+
+@implementation ADRequestDeadlineTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    _clock = [ADTestRetryClock new];
+}
+
+- (void)tearDown
+{
+    _clock = nil;
+    
+    [super tearDown];
+}
+
+#pragma mark - Deadline
+
+- (void)testRemainingTime_shouldCountDownWithClock
+{
+    ADRequestDeadline *deadline = [[ADRequestDeadline alloc] initWithTimeout:10 clock:_clock];
+    
+    XCTAssertEqualWithAccuracy([deadline remainingTime], 10, 0.0001);
+    XCTAssertFalse([deadline isExpired]);
+    
+    [_clock advanceBy:7];
+    XCTAssertEqualWithAccuracy([deadline remainingTime], 3, 0.0001);
+    XCTAssertFalse([deadline isExpired]);
+    
+    [_clock advanceBy:5];
+    XCTAssertEqual([deadline remainingTime], 0);
+    XCTAssertTrue([deadline isExpired]);
+}
+
+- (void)testExpiredError_shouldBeTimeout
+{
+    ADRequestDeadline *deadline = [[ADRequestDeadline alloc] initWithTimeout:0 clock:_clock];
+    
+    XCTAssertEqualObjects([deadline expiredError].domain, NSURLErrorDomain);
+    XCTAssertEqual([deadline expiredError].code, NSURLErrorTimedOut);
+}
+
+#pragma mark - Web requests
+
+- (void)testInitWithContext_whenContextHasDeadline_shouldShareIt
+{
+    ADRequestParameters *params = [ADRequestParameters new];
+    params.deadline = [[ADRequestDeadline alloc] initWithTimeout:10 clock:_clock];
+    
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:params];
+    XCTAssertEqual(request.deadline, params.deadline);
+    
+    // Copies of the parameters draw from the same budget
+    XCTAssertEqual([params copy].deadline, params.deadline);
+    
+    [request invalidate];
+}
+
+- (void)testRequestTimeout_shouldBeCappedByRemainingTime
+{
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:nil];
+    request.timeout = 30;
+    XCTAssertEqualWithAccuracy([request requestTimeout], 30, 0.0001);
+    
+    request.deadline = [[ADRequestDeadline alloc] initWithTimeout:10 clock:_clock];
+    XCTAssertEqualWithAccuracy([request requestTimeout], 10, 0.0001);
+    
+    [_clock advanceBy:8];
+    XCTAssertEqualWithAccuracy([request requestTimeout], 2, 0.0001);
+    
+    request.deadline = [[ADRequestDeadline alloc] initWithTimeout:60 clock:_clock];
+    XCTAssertEqualWithAccuracy([request requestTimeout], 30, 0.0001);
+    
+    [request invalidate];
+}
+
+- (ADTestURLResponse *)responseWithCode:(NSInteger)code
+{
+    ADTestURLResponse *response = [ADTestURLResponse requestURLString:[kTestEndpoint stringByAppendingString:@"?x-client-Ver=" ADAL_VERSION_STRING]
+                                                    responseURLString:@"https://contoso.com"
+                                                         responseCode:code
+                                                     httpHeaderFields:@{}
+                                                     dictionaryAsJSON:@{}];
+    [response setUrlFormEncodedBody:@{ MSID_OAUTH2_GRANT_TYPE : MSID_OAUTH2_REFRESH_TOKEN }];
+    
+    return response;
+}
+
+- (ADWebAuthRequest *)sendRequestWithDeadline:(ADRequestDeadline *)deadline
+                                       policy:(ADRetryPolicy *)policy
+                                   completion:(ADWebResponseCallback)completionBlock
+{
+    ADWebAuthRequest *request = [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:nil];
+    request.deadline = deadline;
+    request.retryPolicy = policy;
+    request.requestDictionary = @{ MSID_OAUTH2_GRANT_TYPE : MSID_OAUTH2_REFRESH_TOKEN };
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request sendRequest:^(ADAuthenticationError *error, NSMutableDictionary *response)
+     {
+         completionBlock(error, response);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+    
+    return request;
+}
+
+- (void)testSendRequest_whenDeadlinePassed_shouldFailWithoutHittingNetwork
+{
+    ADRequestDeadline *deadline = [[ADRequestDeadline alloc] initWithTimeout:5 clock:_clock];
+    [_clock advanceBy:5];
+    
+    // No responses are set up, the mock network fails the test if the request goes out
+    ADWebAuthRequest *request = [self sendRequestWithDeadline:deadline
+                                                       policy:[ADRetryPolicy defaultPolicy]
+                                                   completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+                                 {
+                                     XCTAssertNotNil(error);
+                                     XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+                                     XCTAssertEqual(error.code, NSURLErrorTimedOut);
+                                 }];
+    
+    // A timeout is normally retried, but not when there's no time left
+    XCTAssertEqual(request.attempts, 1);
+}
+
+- (void)testSend_whenDeadlinePassed_shouldCompleteAfterSendReturns
+{
+    ADRequestDeadline *deadline = [[ADRequestDeadline alloc] initWithTimeout:5 clock:_clock];
+    [_clock advanceBy:5];
+    
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:nil];
+    request.deadline = deadline;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    __block BOOL sendReturned = NO;
+    
+    [request send:^(NSError *error, __unused ADWebResponse *response)
+     {
+         XCTAssertTrue(sendReturned);
+         XCTAssertEqual(error.code, NSURLErrorTimedOut);
+         [expectation fulfill];
+     }];
+    sendReturned = YES;
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+}
+
+- (void)testSend_whenResponseArrivesBeforeDeadline_shouldCompleteOnce
+{
+    // The deadline timer runs on wall clock time, give it a short budget that
+    // would run out while the test is still waiting
+    ADRequestDeadline *deadline = [[ADRequestDeadline alloc] initWithTimeout:0.2 clock:[ADRetryPolicy systemClock]];
+    
+    [ADTestURLSession addResponse:[self responseWithCode:200]];
+    
+    ADWebRequest *request = [[ADWebRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:nil];
+    request.deadline = deadline;
+    request.body = [@"grant_type=refresh_token" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    XCTestExpectation *secondCall = [self expectationWithDescription:@"completion called again"];
+    secondCall.inverted = YES;
+    __block NSUInteger callCount = 0;
+    
+    [request send:^(NSError *error, ADWebResponse *response)
+     {
+         if (++callCount > 1)
+         {
+             [secondCall fulfill];
+             return;
+         }
+         
+         XCTAssertNil(error);
+         XCTAssertEqual(response.statusCode, 200);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [self waitForExpectations:@[secondCall] timeout:0.5];
+    [request invalidate];
+}
+
+- (void)testSendRequest_whenBackoffOutlivesDeadline_shouldStopRetrying
+{
+    ADRetryPolicy *policy = [ADRetryPolicy new];
+    policy.clock = _clock;
+    policy.randomSource = ^double { return 0.5; };
+    policy.maxAttempts = 5;
+    policy.baseDelay = 1;
+    
+    ADRequestDeadline *deadline = [[ADRequestDeadline alloc] initWithTimeout:3 clock:_clock];
+    
+    // Backoffs of 0.5 and 1 second fit into the budget, the third one of 2 seconds
+    // doesn't as only 1.5 seconds are left by then.
+    [ADTestURLSession addResponses:@[[self responseWithCode:503],
+                                     [self responseWithCode:503],
+                                     [self responseWithCode:503]]];
+    
+    ADWebAuthRequest *request = [self sendRequestWithDeadline:deadline
+                                                       policy:policy
+                                                   completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+                                 {
+                                     XCTAssertNotNil(error);
+                                     XCTAssertEqual(error.code, 503);
+                                 }];
+    
+    NSArray *expectedDelays = @[@(0.5), @(1)];
+    XCTAssertEqualObjects(_clock.delays, expectedDelays);
+    XCTAssertEqual(request.attempts, 3);
+    XCTAssertEqualWithAccuracy([deadline remainingTime], 1.5, 0.0001);
+}
+
+@end
@@ -0,0 +1,191 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <XCTest/XCTest.h>
+#import "XCTestCase+TestHelperMethods.h"
+#import "ADRequestTemplate.h"
+#import "MSIDDeviceId.h"
+
+@interface ADRequestTemplateTests : ADTestCase
+
+@property (nonatomic) ADRequestTemplate *requestTemplate;
+
+@end
+
+@implementation ADRequestTemplateTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    self.requestTemplate = [[ADRequestTemplate alloc] initWithAuthority:TEST_AUTHORITY
+                                                               clientId:TEST_CLIENT_ID
+                                                            redirectUri:TEST_REDIRECT_URL_STRING];
+}
+
+- (void)tearDown
+{
+    [super tearDown];
+}
+
+// The authorize URL as it was built before request templates were introduced
+- (NSString *)legacyAuthorizeURLWithLoginHint:(NSString *)loginHint prompt:(NSString *)prompt
+{
+    NSMutableString* startUrl = [NSMutableString stringWithFormat:@"%@?%@=%@&%@=%@&%@=%@&%@=%@&%@=%@",
+                                 [TEST_AUTHORITY stringByAppendingString:MSID_OAUTH2_AUTHORIZE_SUFFIX],
+                                 MSID_OAUTH2_RESPONSE_TYPE, MSID_OAUTH2_CODE,
+                                 MSID_OAUTH2_CLIENT_ID, [TEST_CLIENT_ID msidUrlFormEncode],
+                                 MSID_OAUTH2_RESOURCE, [TEST_RESOURCE msidUrlFormEncode],
+                                 MSID_OAUTH2_REDIRECT_URI, [TEST_REDIRECT_URL_STRING msidUrlFormEncode],
+                                 MSID_OAUTH2_STATE, @"state"];
+    
+    [startUrl appendFormat:@"&%@", [[MSIDDeviceId deviceId] msidURLFormEncode]];
+    
+    if (loginHint)
+    {
+        [startUrl appendFormat:@"&%@=%@", MSID_OAUTH2_LOGIN_HINT, [loginHint msidUrlFormEncode]];
+    }
+    
+    if (prompt)
+    {
+        [startUrl appendString:[NSString stringWithFormat:@"&prompt=%@", prompt]];
+    }
+    
+    [startUrl appendString:@"&haschrome=1"];
+    
+    return startUrl;
+}
+
+- (NSDictionary *)tokenRequestDictionary
+{
+    return @{ MSID_OAUTH2_GRANT_TYPE : MSID_OAUTH2_REFRESH_TOKEN,
+              MSID_OAUTH2_REFRESH_TOKEN : TEST_REFRESH_TOKEN,
+              MSID_OAUTH2_RESOURCE : TEST_RESOURCE,
+              MSID_OAUTH2_CLIENT_ID : TEST_CLIENT_ID,
+              MSID_OAUTH2_REDIRECT_URI : TEST_REDIRECT_URL_STRING,
+              MSID_OAUTH2_CLIENT_INFO : @"1",
+              MSID_OAUTH2_SCOPE : MSID_OAUTH2_SCOPE_OPENID_VALUE };
+}
+
+#pragma mark - Authorize URL
+
+- (void)testAuthorizeURL_withoutLoginHintAndPrompt_shouldMatchLegacyURL
+{
+    NSString *url = [self.requestTemplate authorizeURLWithResponseType:MSID_OAUTH2_CODE
+                                                              resource:TEST_RESOURCE
+                                                                 state:@"state"
+                                                             loginHint:nil
+                                                                prompt:nil];
+    
+    XCTAssertEqualObjects(url, [self legacyAuthorizeURLWithLoginHint:nil prompt:nil]);
+}
+
+- (void)testAuthorizeURL_withLoginHintAndPrompt_shouldMatchLegacyURL
+{
+    NSString *url = [self.requestTemplate authorizeURLWithResponseType:MSID_OAUTH2_CODE
+                                                              resource:TEST_RESOURCE
+                                                                 state:@"state"
+                                                             loginHint:@"user+1@contoso.com"
+                                                                prompt:@"login"];
+    
+    XCTAssertEqualObjects(url, [self legacyAuthorizeURLWithLoginHint:@"user+1@contoso.com" prompt:@"login"]);
+}
+
+#pragma mark - Form encoding
+
+- (void)testFormEncodedString_shouldMatchMSIDFormEncode
+{
+    NSDictionary *requestDictionary = [self tokenRequestDictionary];
+    
+    NSString *encoded = [self.requestTemplate formEncodedStringFromDictionary:requestDictionary];
+    
+    XCTAssertEqualObjects([NSDictionary msidURLFormDecode:encoded], [NSDictionary msidURLFormDecode:[requestDictionary msidURLFormEncode]]);
+    XCTAssertEqualObjects([NSDictionary msidURLFormDecode:encoded], requestDictionary);
+}
+
+- (void)testFormEncodedString_whenClientIdDiffersFromTemplate_shouldEncodeRequestValue
+{
+    NSDictionary *requestDictionary = @{ MSID_OAUTH2_CLIENT_ID : @"other client id" };
+    
+    NSString *encoded = [self.requestTemplate formEncodedStringFromDictionary:requestDictionary];
+    
+    XCTAssertEqualObjects([NSDictionary msidURLFormDecode:encoded], requestDictionary);
+}
+
+- (void)testFormEncodedString_whenEmptyDictionary_shouldReturnNil
+{
+    XCTAssertNil([self.requestTemplate formEncodedStringFromDictionary:@{}]);
+    XCTAssertNil([self.requestTemplate formEncodedBodyFromDictionary:nil]);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformance_authorizeURL_legacy
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            [self legacyAuthorizeURLWithLoginHint:TEST_USER_ID prompt:@"login"];
+        }
+    }];
+}
+
+- (void)testPerformance_authorizeURL_template
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            [self.requestTemplate authorizeURLWithResponseType:MSID_OAUTH2_CODE
+                                                      resource:TEST_RESOURCE
+                                                         state:@"state"
+                                                     loginHint:TEST_USER_ID
+                                                        prompt:@"login"];
+        }
+    }];
+}
+
+- (void)testPerformance_tokenRequestBody_legacy
+{
+    NSDictionary *requestDictionary = [self tokenRequestDictionary];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            [[requestDictionary msidURLFormEncode] dataUsingEncoding:NSUTF8StringEncoding];
+        }
+    }];
+}
+
+- (void)testPerformance_tokenRequestBody_template
+{
+    NSDictionary *requestDictionary = [self tokenRequestDictionary];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            [self.requestTemplate formEncodedBodyFromDictionary:requestDictionary];
+        }
+    }];
+}
+
+@end
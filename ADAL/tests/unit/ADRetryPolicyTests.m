@@ -0,0 +1,478 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <XCTest/XCTest.h>
+#import "ADRetryPolicy.h"
+#import "ADWebAuthRequest.h"
+#import "XCTestCase+TestHelperMethods.h"
+#import "ADTestURLSession.h"
+#import "ADTestURLResponse.h"
+#import "ADTestRetryClock.h"
+#import "ADRequestParameters.h"
+#import "ADHelpers.h"
+
+static NSString * const kTestEndpoint = @"https://login.windows.net/contoso.com/oauth2/token";
+
+@interface ADRetryPolicyTests : ADTestCase
+{
+    ADTestRetryClock *_clock;
+}
+
+@end
+
+@implementation ADRetryPolicyTests
+
+- (void)setUp
+{
+    [super setUp];
+    
+    _clock = [ADTestRetryClock new];
+}
+
+- (void)tearDown
+{
+    _clock = nil;
+    
+    [super tearDown];
+}
+
+- (ADRetryPolicy *)policyWithRandom:(double)random
+{
+    ADRetryPolicy *policy = [ADRetryPolicy new];
+    policy.clock = _clock;
+    policy.randomSource = ^double { return random; };
+    
+    return policy;
+}
+
+#pragma mark - Classification
+
+- (void)testShouldRetryStatusCode_shouldRetryThrottlingAndServerErrors
+{
+    ADRetryPolicy *policy = [ADRetryPolicy new];
+    
+    XCTAssertTrue([policy shouldRetryStatusCode:429]);
+    XCTAssertTrue([policy shouldRetryStatusCode:500]);
+    XCTAssertTrue([policy shouldRetryStatusCode:503]);
+    XCTAssertTrue([policy shouldRetryStatusCode:599]);
+    
+    XCTAssertFalse([policy shouldRetryStatusCode:200]);
+    XCTAssertFalse([policy shouldRetryStatusCode:400]);
+    XCTAssertFalse([policy shouldRetryStatusCode:401]);
+}
+
+- (void)testShouldRetryError_shouldOnlyRetryTransientNetworkErrors
+{
+    ADRetryPolicy *policy = [ADRetryPolicy new];
+    
+    XCTAssertTrue([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil]]);
+    XCTAssertTrue([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil]]);
+    XCTAssertTrue([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotConnectToHost userInfo:nil]]);
+    
+    XCTAssertFalse([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil]]);
+    XCTAssertFalse([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]]);
+    XCTAssertFalse([policy shouldRetryError:[NSError errorWithDomain:NSCocoaErrorDomain code:NSURLErrorTimedOut userInfo:nil]]);
+}
+
+- (void)testShouldRetryStatusCode_whenIdempotentOrByDefault_shouldRetryServerErrors
+{
+    ADRetryPolicy *policy = [ADRetryPolicy new];
+    
+    XCTAssertTrue(policy.retryNonIdempotentRequests);
+    XCTAssertTrue([policy shouldRetryStatusCode:500 idempotent:NO]);
+    XCTAssertTrue([policy shouldRetryStatusCode:504 idempotent:NO]);
+    XCTAssertTrue([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil] idempotent:NO]);
+    
+    policy.retryNonIdempotentRequests = NO;
+    XCTAssertTrue([policy shouldRetryStatusCode:500 idempotent:YES]);
+    XCTAssertTrue([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil] idempotent:YES]);
+}
+
+- (void)testShouldRetryStatusCode_whenNonIdempotentRetriesOff_shouldOnlyRetryUnprocessedRequests
+{
+    ADRetryPolicy *policy = [ADRetryPolicy new];
+    policy.retryNonIdempotentRequests = NO;
+    
+    XCTAssertTrue([policy shouldRetryStatusCode:429 idempotent:NO]);
+    XCTAssertTrue([policy shouldRetryStatusCode:503 idempotent:NO]);
+    
+    XCTAssertFalse([policy shouldRetryStatusCode:500 idempotent:NO]);
+    XCTAssertFalse([policy shouldRetryStatusCode:504 idempotent:NO]);
+    XCTAssertFalse([policy shouldRetryStatusCode:400 idempotent:NO]);
+}
+
+- (void)testShouldRetryError_whenNonIdempotentRetriesOff_shouldOnlyRetryWhenNotConnected
+{
+    ADRetryPolicy *policy = [ADRetryPolicy new];
+    policy.retryNonIdempotentRequests = NO;
+    
+    XCTAssertTrue([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotConnectToHost userInfo:nil] idempotent:NO]);
+    
+    XCTAssertFalse([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil] idempotent:NO]);
+    XCTAssertFalse([policy shouldRetryError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil] idempotent:NO]);
+}
+
+#pragma mark - Backoff
+
+- (void)testRetryDelay_shouldBackOffExponentiallyUpToMaxAttempts
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0.5];
+    policy.maxAttempts = 5;
+    policy.baseDelay = 0.5;
+    policy.maxDelay = 100;
+    
+    NSTimeInterval delay = 0;
+    
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+    XCTAssertEqualWithAccuracy(delay, 0.25, 0.0001);
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:2 endpoint:kTestEndpoint retryAfter:nil]);
+    XCTAssertEqualWithAccuracy(delay, 0.5, 0.0001);
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:3 endpoint:kTestEndpoint retryAfter:nil]);
+    XCTAssertEqualWithAccuracy(delay, 1.0, 0.0001);
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:4 endpoint:kTestEndpoint retryAfter:nil]);
+    XCTAssertEqualWithAccuracy(delay, 2.0, 0.0001);
+    
+    XCTAssertFalse([policy retryDelay:&delay forAttempts:5 endpoint:kTestEndpoint retryAfter:nil]);
+}
+
+- (void)testRetryDelay_shouldNotExceedMaxDelay
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0.999];
+    policy.maxAttempts = 20;
+    policy.maxDelay = 3;
+    
+    NSTimeInterval delay = 0;
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:10 endpoint:kTestEndpoint retryAfter:nil]);
+    
+    XCTAssertLessThan(delay, 3);
+}
+
+- (void)testRetryDelay_withDefaultRandomSource_shouldStayWithinCap
+{
+    ADRetryPolicy *policy = [ADRetryPolicy new];
+    policy.retryBudget = 1000;
+    
+    for (NSUInteger i = 0; i < 500; i++)
+    {
+        NSTimeInterval delay = -1;
+        XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+        XCTAssertGreaterThanOrEqual(delay, 0);
+        XCTAssertLessThan(delay, policy.baseDelay);
+    }
+}
+
+#pragma mark - Retry-After
+
+- (void)testRetryDelay_whenRetryAfterSeconds_shouldWaitAtLeastThatLong
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    
+    NSTimeInterval delay = 0;
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:@"3"]);
+    
+    XCTAssertEqualWithAccuracy(delay, 3, 0.0001);
+}
+
+- (void)testRetryDelay_whenRetryAfterHTTPDate_shouldWaitUntilThatDate
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    _clock.currentDate = [NSDate dateWithTimeIntervalSince1970:1445412475]; // Wed, 21 Oct 2015 07:27:55 GMT
+    
+    NSTimeInterval delay = 0;
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:@"Wed, 21 Oct 2015 07:28:00 GMT"]);
+    
+    XCTAssertEqualWithAccuracy(delay, 5, 0.0001);
+}
+
+- (void)testRetryDelay_whenRetryAfterTooLong_shouldNotRetry
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    policy.maxRetryAfter = 10;
+    
+    NSTimeInterval delay = 0;
+    XCTAssertFalse([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:@"120"]);
+}
+
+- (void)testIntervalFromRetryAfter_whenGarbage_shouldReturnNegative
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    
+    XCTAssertLessThan([policy intervalFromRetryAfter:nil], 0);
+    XCTAssertLessThan([policy intervalFromRetryAfter:@""], 0);
+    XCTAssertLessThan([policy intervalFromRetryAfter:@"soon"], 0);
+    XCTAssertLessThan([policy intervalFromRetryAfter:@"-5"], 0);
+    XCTAssertEqual([policy intervalFromRetryAfter:@" 7 "], 7);
+}
+
+#pragma mark - Retry budget
+
+- (void)testRetryDelay_whenBudgetExhausted_shouldNotRetryUntilRefilled
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    policy.retryBudget = 2;
+    policy.retryBudgetInterval = 60;
+    
+    NSTimeInterval delay = 0;
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+    XCTAssertFalse([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+    
+    // Other endpoints have their own budget
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:@"https://login.windows.net/common/discovery/instance" retryAfter:nil]);
+    
+    // Half the interval buys one retry back
+    [_clock advanceBy:30];
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+    XCTAssertFalse([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+    
+    [policy resetRetryBudgets];
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+}
+
+#pragma mark - Scripted server
+
+- (ADTestURLResponse *)responseWithCode:(NSInteger)code headers:(NSDictionary *)headers json:(NSDictionary *)json
+{
+    ADTestURLResponse *response = [ADTestURLResponse requestURLString:[kTestEndpoint stringByAppendingString:@"?x-client-Ver=" ADAL_VERSION_STRING]
+                                                    responseURLString:@"https://contoso.com"
+                                                         responseCode:code
+                                                     httpHeaderFields:headers
+                                                     dictionaryAsJSON:json];
+    [response setUrlFormEncodedBody:@{ MSID_OAUTH2_GRANT_TYPE : MSID_OAUTH2_REFRESH_TOKEN }];
+    
+    return response;
+}
+
+- (void)sendRequestWithPolicy:(ADRetryPolicy *)policy
+                   completion:(ADWebResponseCallback)completionBlock
+{
+    ADWebAuthRequest *request = [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:nil];
+    request.retryPolicy = policy;
+    request.requestDictionary = @{ MSID_OAUTH2_GRANT_TYPE : MSID_OAUTH2_REFRESH_TOKEN };
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request sendRequest:^(ADAuthenticationError *error, NSMutableDictionary *response)
+     {
+         completionBlock(error, response);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    XCTAssertEqual(request.attempts, _clock.delays.count + 1);
+    [request invalidate];
+}
+
+- (void)testSendRequest_whenServerRecoversWithinMaxAttempts_shouldSucceed
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0.5];
+    policy.maxAttempts = 3;
+    
+    [ADTestURLSession addResponses:@[[self responseWithCode:503 headers:@{} json:@{}],
+                                     [self responseWithCode:500 headers:@{} json:@{}],
+                                     [self responseWithCode:200 headers:@{} json:@{ MSID_OAUTH2_ACCESS_TOKEN : TEST_ACCESS_TOKEN }]]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, NSMutableDictionary *response)
+     {
+         XCTAssertNil(error);
+         XCTAssertEqualObjects(response[MSID_OAUTH2_ACCESS_TOKEN], TEST_ACCESS_TOKEN);
+     }];
+    
+    NSArray *expectedDelays = @[@(0.25), @(0.5)];
+    XCTAssertEqualObjects(_clock.delays, expectedDelays);
+}
+
+- (void)testSendRequest_whenServerKeepsFailing_shouldGiveUpAfterMaxAttempts
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0.5];
+    policy.maxAttempts = 3;
+    
+    [ADTestURLSession addResponses:@[[self responseWithCode:503 headers:@{} json:@{}],
+                                     [self responseWithCode:503 headers:@{} json:@{}],
+                                     [self responseWithCode:503 headers:@{} json:@{}]]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNotNil(error);
+         XCTAssertEqual(error.code, 503);
+     }];
+    
+    XCTAssertEqual(_clock.delays.count, 2);
+}
+
+- (void)testSendRequest_whenThrottledWithRetryAfter_shouldHonorRetryAfter
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    
+    [ADTestURLSession addResponses:@[[self responseWithCode:429 headers:@{ @"Retry-After" : @"2" } json:@{}],
+                                     [self responseWithCode:200 headers:@{} json:@{ MSID_OAUTH2_ACCESS_TOKEN : TEST_ACCESS_TOKEN }]]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNil(error);
+     }];
+    
+    NSArray *expectedDelays = @[@(2)];
+    XCTAssertEqualObjects(_clock.delays, expectedDelays);
+}
+
+- (void)testSendRequest_whenTransientNetworkError_shouldRetry
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    
+    NSURL *requestURL = [NSURL URLWithString:[kTestEndpoint stringByAppendingString:@"?x-client-Ver=" ADAL_VERSION_STRING]];
+    ADTestURLResponse *errorResponse = [ADTestURLResponse request:requestURL
+                                                 respondWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil]];
+    
+    [ADTestURLSession addResponses:@[errorResponse,
+                                     [self responseWithCode:200 headers:@{} json:@{ MSID_OAUTH2_ACCESS_TOKEN : TEST_ACCESS_TOKEN }]]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNil(error);
+     }];
+    
+    XCTAssertEqual(_clock.delays.count, 1);
+}
+
+- (void)testSendRequest_whenContextHasQOSClass_shouldRetryOnQueueOfClass
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    
+    [ADTestURLSession addResponses:@[[self responseWithCode:503 headers:@{} json:@{}],
+                                     [self responseWithCode:200 headers:@{} json:@{ MSID_OAUTH2_ACCESS_TOKEN : TEST_ACCESS_TOKEN }]]];
+    
+    ADRequestParameters *params = [ADRequestParameters new];
+    params.qosClass = QOS_CLASS_UTILITY;
+    
+    ADWebAuthRequest *request = [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:kTestEndpoint] context:params];
+    request.retryPolicy = policy;
+    request.requestDictionary = @{ MSID_OAUTH2_GRANT_TYPE : MSID_OAUTH2_REFRESH_TOKEN };
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"send request"];
+    
+    [request sendRequest:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNil(error);
+         [expectation fulfill];
+     }];
+    
+    [self waitForExpectations:@[expectation] timeout:1];
+    [request invalidate];
+    
+    XCTAssertEqual(_clock.lastQueue, [ADHelpers globalQueueForQOSClass:QOS_CLASS_UTILITY]);
+}
+
+- (void)testSendRequest_whenThrottledWithRetryAfterTooLong_shouldFailWithoutRetrying
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    
+    [ADTestURLSession addResponse:[self responseWithCode:429 headers:@{ @"Retry-After" : @"60" } json:@{}]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNotNil(error);
+         XCTAssertEqual(error.code, 429);
+     }];
+    
+    XCTAssertEqual(_clock.delays.count, 0);
+}
+
+- (void)testSendRequest_whenNonIdempotentRetriesOff_shouldNotRetryServerError
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    policy.retryNonIdempotentRequests = NO;
+    
+    [ADTestURLSession addResponse:[self responseWithCode:500 headers:@{} json:@{}]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNotNil(error);
+         XCTAssertEqual(error.code, 500);
+     }];
+    
+    XCTAssertEqual(_clock.delays.count, 0);
+}
+
+- (void)testSendRequest_whenNonIdempotentRetriesOffAndUnavailableWithRetryAfter_shouldRetry
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    policy.retryNonIdempotentRequests = NO;
+    
+    [ADTestURLSession addResponses:@[[self responseWithCode:503 headers:@{ @"Retry-After" : @"1" } json:@{}],
+                                     [self responseWithCode:200 headers:@{} json:@{ MSID_OAUTH2_ACCESS_TOKEN : TEST_ACCESS_TOKEN }]]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNil(error);
+     }];
+    
+    NSArray *expectedDelays = @[@(1)];
+    XCTAssertEqualObjects(_clock.delays, expectedDelays);
+}
+
+- (void)testSendRequest_whenBudgetUsedUpByEarlierRequest_shouldNotRetry
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    policy.retryBudget = 1;
+    
+    [ADTestURLSession addResponses:@[[self responseWithCode:500 headers:@{} json:@{}],
+                                     [self responseWithCode:200 headers:@{} json:@{ MSID_OAUTH2_ACCESS_TOKEN : TEST_ACCESS_TOKEN }]]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNil(error);
+     }];
+    XCTAssertEqual(_clock.delays.count, 1);
+    [_clock.delays removeAllObjects];
+    
+    // The one retry the endpoint had went to the first request
+    [ADTestURLSession addResponse:[self responseWithCode:500 headers:@{} json:@{}]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNotNil(error);
+         XCTAssertEqual(error.code, 500);
+     }];
+    XCTAssertEqual(_clock.delays.count, 0);
+}
+
+- (void)testSendRequest_whenBudgetExhausted_shouldFailWithoutRetrying
+{
+    ADRetryPolicy *policy = [self policyWithRandom:0];
+    policy.retryBudget = 1;
+    
+    NSTimeInterval delay = 0;
+    XCTAssertTrue([policy retryDelay:&delay forAttempts:1 endpoint:kTestEndpoint retryAfter:nil]);
+    
+    [ADTestURLSession addResponse:[self responseWithCode:503 headers:@{} json:@{}]];
+    
+    [self sendRequestWithPolicy:policy completion:^(ADAuthenticationError *error, __unused NSMutableDictionary *response)
+     {
+         XCTAssertNotNil(error);
+     }];
+    
+    XCTAssertEqual(_clock.delays.count, 0);
+}
+
+@end
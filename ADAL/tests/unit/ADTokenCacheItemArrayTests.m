@@ -0,0 +1,156 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <XCTest/XCTest.h>
+#import "ADTokenCacheItemArray.h"
+#import "ADTokenCacheItem+MSIDTokens.h"
+#import "XCTestCase+TestHelperMethods.h"
+#import "MSIDLegacyTokenCacheItem.h"
+#import "MSIDTestIdentifiers.h"
+
+@interface ADTokenCacheItemArrayTests : ADTestCase
+
+@end
+
+@implementation ADTokenCacheItemArrayTests
+
+- (void)setUp
+{
+    [super setUp];
+}
+
+- (void)tearDown
+{
+    [super tearDown];
+}
+
+- (NSArray *)cacheItemsWithCount:(NSUInteger)count
+{
+    NSMutableArray *cacheItems = [NSMutableArray arrayWithCapacity:count];
+    
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        MSIDLegacyTokenCacheItem *item = (i % 2) ? [self adCreateRefreshMSIDTokenCacheItem] : [self adCreateAccessMSIDTokenCacheItem];
+        item.clientId = [NSString stringWithFormat:@"client%lu", (unsigned long)(i % 4)];
+        [cacheItems addObject:item];
+    }
+    
+    return cacheItems;
+}
+
+#pragma mark - Tests
+
+- (void)testInitWithCacheItems_whenEmpty_shouldReturnEmptyArray
+{
+    ADTokenCacheItemArray *array = [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:@[]];
+    
+    XCTAssertNotNil(array);
+    XCTAssertEqual(array.count, 0);
+    XCTAssertNil(array.firstObject);
+}
+
+- (void)testInitWithCacheItems_whenUnsupportedCredentialType_shouldDropItem
+{
+    MSIDLegacyTokenCacheItem *idTokenItem = [self adCreateAccessMSIDTokenCacheItem];
+    idTokenItem.credentialType = MSIDIDTokenType;
+    
+    NSArray *cacheItems = @[[self adCreateAccessMSIDTokenCacheItem], idTokenItem, [self adCreateRefreshMSIDTokenCacheItem]];
+    
+    ADTokenCacheItemArray *array = [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:cacheItems];
+    
+    XCTAssertEqual(array.count, 2);
+    XCTAssertEqualObjects(array[0].accessToken, DEFAULT_TEST_ACCESS_TOKEN);
+    XCTAssertNotNil(array[1].refreshToken);
+}
+
+- (void)testObjectAtIndex_shouldMatchEagerConversion
+{
+    NSArray *cacheItems = @[[self adCreateAccessMSIDTokenCacheItem], [self adCreateRefreshMSIDTokenCacheItem], [self adCreateLegacySingleResourceMSIDTokenCacheItem]];
+    
+    ADTokenCacheItemArray *array = [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:cacheItems];
+    
+    XCTAssertEqual(array.count, cacheItems.count);
+    
+    for (NSUInteger i = 0; i < cacheItems.count; i++)
+    {
+        ADTokenCacheItem *expectedItem = [[ADTokenCacheItem alloc] initWithMSIDLegacyTokenCacheItem:cacheItems[i]];
+        XCTAssertEqualObjects(array[i], expectedItem);
+    }
+}
+
+- (void)testObjectAtIndex_whenCalledTwice_shouldReturnSameInstance
+{
+    ADTokenCacheItemArray *array = [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:@[[self adCreateAccessMSIDTokenCacheItem]]];
+    
+    XCTAssertTrue(array[0] == array[0]);
+}
+
+- (void)testObjectAtIndex_whenOutOfBounds_shouldThrow
+{
+    ADTokenCacheItemArray *array = [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:@[[self adCreateAccessMSIDTokenCacheItem]]];
+    
+    XCTAssertThrowsSpecificNamed([array objectAtIndex:1], NSException, NSRangeException);
+}
+
+- (void)testFastEnumeration_shouldReturnAllItems
+{
+    ADTokenCacheItemArray *array = [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:[self cacheItemsWithCount:10]];
+    
+    NSUInteger count = 0;
+    for (ADTokenCacheItem *item in array)
+    {
+        XCTAssertNotNil(item.clientId);
+        count++;
+    }
+    
+    XCTAssertEqual(count, 10);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformance_countOnly_largeCache
+{
+    NSArray *cacheItems = [self cacheItemsWithCount:2000];
+    
+    [self measureBlock:^{
+        ADTokenCacheItemArray *array = [[ADTokenCacheItemArray alloc] initWithMSIDLegacyTokenCacheItems:cacheItems];
+        XCTAssertEqual(array.count, 2000);
+    }];
+}
+
+- (void)testPerformance_eagerConversion_largeCache
+{
+    NSArray *cacheItems = [self cacheItemsWithCount:2000];
+    
+    [self measureBlock:^{
+        NSMutableArray *results = [NSMutableArray array];
+        for (MSIDLegacyTokenCacheItem *cacheItem in cacheItems)
+        {
+            ADTokenCacheItem *item = [[ADTokenCacheItem alloc] initWithMSIDLegacyTokenCacheItem:cacheItem];
+            if (item) [results addObject:item];
+        }
+        XCTAssertEqual(results.count, 2000);
+    }];
+}
+
+@end
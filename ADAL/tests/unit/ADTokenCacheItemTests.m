@@ -445,6 +445,8 @@
     
     NSData* itemData = [[NSData alloc] initWithBase64EncodedString:base64String options:0];
     XCTAssertNotNil(itemData);
+    // The class name mappings are set up on first use of the cache, not at load time
+    [ADTokenCacheItem setupArchiverClassNames];
     ADTokenCacheItem* item = [NSKeyedUnarchiver unarchiveObjectWithData:itemData];
     XCTAssertNotNil(item);
     
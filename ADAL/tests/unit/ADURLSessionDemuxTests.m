@@ -0,0 +1,214 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <XCTest/XCTest.h>
+#import "ADURLSessionDemux.h"
+
+// The demux is the session delegate, the tests play the part of the session
+@interface ADURLSessionDemux (Tests) <NSURLSessionDataDelegate>
+
+@end
+
+@interface ADURLSessionDemuxTestDelegate : NSObject <NSURLSessionDataDelegate>
+
+@property NSMutableData *receivedData;
+@property NSUInteger dataCallbacks;
+@property BOOL completedAfterData;
+@property NSThread *callbackThread;
+@property XCTestExpectation *expectation;
+
+@end
+
+@implementation ADURLSessionDemuxTestDelegate
+
+- (instancetype)init
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _receivedData = [NSMutableData new];
+    return self;
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data
+{
+    (void)session;
+    (void)dataTask;
+    [_receivedData appendData:data];
+    _dataCallbacks++;
+    _callbackThread = [NSThread currentThread];
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error
+{
+    (void)session;
+    (void)task;
+    (void)error;
+    _completedAfterData = _receivedData.length > 0;
+    [_expectation fulfill];
+}
+
+@end
+
+#define TEST_CHUNK_SIZE (16 * 1024)
+
+@interface ADURLSessionDemuxTests : ADTestCase
+
+@end
+
+@implementation ADURLSessionDemuxTests
+{
+    ADURLSessionDemux *_demux;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    
+    _demux = [[ADURLSessionDemux alloc] initWithConfiguration:[NSURLSessionConfiguration ephemeralSessionConfiguration] delegateQueue:nil];
+}
+
+- (void)tearDown
+{
+    [_demux.session invalidateAndCancel];
+    _demux = nil;
+    
+    [super tearDown];
+}
+
+#pragma mark - Helpers
+
+- (NSData *)chunkWithIndex:(NSUInteger)index
+{
+    NSMutableData *chunk = [NSMutableData dataWithLength:TEST_CHUNK_SIZE];
+    memset(chunk.mutableBytes, (int)(index % 256), TEST_CHUNK_SIZE);
+    return chunk;
+}
+
+// Sends the chunks and the completion to the demux the way a session would, from its
+// delegate queue, and waits for the delegate to see the task complete.
+- (void)deliverChunks:(NSArray<NSData *> *)chunks
+               toTask:(NSURLSessionDataTask *)task
+             delegate:(ADURLSessionDemuxTestDelegate *)delegate
+{
+    delegate.expectation = [self expectationWithDescription:@"task completed"];
+    
+    ADURLSessionDemux *demux = _demux;
+    [demux.session.delegateQueue addOperationWithBlock:^{
+        for (NSData *chunk in chunks)
+        {
+            [demux URLSession:demux.session dataTask:task didReceiveData:chunk];
+        }
+        [demux URLSession:demux.session task:task didCompleteWithError:nil];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10.0 handler:nil];
+}
+
+- (NSArray<NSData *> *)chunks:(NSUInteger)count
+{
+    NSMutableArray *chunks = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        [chunks addObject:[self chunkWithIndex:i]];
+    }
+    return chunks;
+}
+
+- (NSURLRequest *)testRequest
+{
+    return [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://login.windows.net/common/oauth2/authorize"]];
+}
+
+#pragma mark - Tests
+
+- (void)testDidReceiveData_whenThreadTargeted_shouldDeliverAllDataInOrderOnThread
+{
+    ADURLSessionDemuxTestDelegate *delegate = [ADURLSessionDemuxTestDelegate new];
+    NSURLSessionDataTask *task = [_demux dataTaskWithRequest:[self testRequest] delegate:delegate];
+    NSArray *chunks = [self chunks:64];
+    
+    [self deliverChunks:chunks toTask:task delegate:delegate];
+    
+    NSMutableData *expected = [NSMutableData new];
+    for (NSData *chunk in chunks)
+    {
+        [expected appendData:chunk];
+    }
+    XCTAssertEqualObjects(delegate.receivedData, expected);
+    XCTAssertTrue(delegate.completedAfterData);
+    XCTAssertLessThanOrEqual(delegate.dataCallbacks, chunks.count);
+    XCTAssertEqualObjects(delegate.callbackThread, [NSThread currentThread]);
+}
+
+- (void)testDidReceiveData_whenQueueTargeted_shouldDeliverAllDataInOrderOnQueue
+{
+    dispatch_queue_t queue = dispatch_queue_create("com.microsoft.adal.demuxtests", DISPATCH_QUEUE_SERIAL);
+    ADURLSessionDemuxTestDelegate *delegate = [ADURLSessionDemuxTestDelegate new];
+    NSURLSessionDataTask *task = [_demux dataTaskWithRequest:[self testRequest] delegate:delegate queue:queue];
+    NSArray *chunks = [self chunks:64];
+    
+    [self deliverChunks:chunks toTask:task delegate:delegate];
+    
+    NSMutableData *expected = [NSMutableData new];
+    for (NSData *chunk in chunks)
+    {
+        [expected appendData:chunk];
+    }
+    XCTAssertEqualObjects(delegate.receivedData, expected);
+    XCTAssertTrue(delegate.completedAfterData);
+    XCTAssertLessThanOrEqual(delegate.dataCallbacks, chunks.count);
+    XCTAssertNotEqualObjects(delegate.callbackThread, [NSThread mainThread]);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformance_didReceiveData_threadTargeted
+{
+    NSArray *chunks = [self chunks:1024];
+    ADURLSessionDemux *demux = _demux;
+    
+    [self measureBlock:^{
+        ADURLSessionDemuxTestDelegate *delegate = [ADURLSessionDemuxTestDelegate new];
+        NSURLSessionDataTask *task = [demux dataTaskWithRequest:[self testRequest] delegate:delegate];
+        [self deliverChunks:chunks toTask:task delegate:delegate];
+    }];
+}
+
+- (void)testPerformance_didReceiveData_queueTargeted
+{
+    NSArray *chunks = [self chunks:1024];
+    dispatch_queue_t queue = dispatch_queue_create("com.microsoft.adal.demuxtests", DISPATCH_QUEUE_SERIAL);
+    ADURLSessionDemux *demux = _demux;
+    
+    [self measureBlock:^{
+        ADURLSessionDemuxTestDelegate *delegate = [ADURLSessionDemuxTestDelegate new];
+        NSURLSessionDataTask *task = [demux dataTaskWithRequest:[self testRequest] delegate:delegate queue:queue];
+        [self deliverChunks:chunks toTask:task delegate:delegate];
+    }];
+}
+
+@end
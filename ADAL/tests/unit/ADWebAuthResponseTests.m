@@ -24,6 +24,9 @@
 
 #import <XCTest/XCTest.h>
 #import "ADWebAuthResponse.h"
+#import "ADWebAuthRequest.h"
+#import "ADWebResponse.h"
+#import "XCTestCase+TestHelperMethods.h"
 
 @interface ADWebAuthResponseTests : ADTestCase
 
@@ -74,4 +77,136 @@
     NSString* noComma = @"key1=\"value1\"key2=\"value2\"";
     XCTAssertNil([ADWebAuthResponse parseAuthHeader:noComma]);
 }
+
+- (void)testAuthParams_whenTrailingCommaAndRepeatedKey_shouldJoinValues
+{
+    NSString* authString = @"Context=\"a\", Context=\"b\", Version=1.0 ,";
+    
+    XCTAssertEqualObjects([ADWebAuthResponse parseAuthHeader:authString], (@{ @"Context" : @"a.b", @"Version" : @"1.0" }));
+}
+
+- (void)testPerformance_parseAuthHeader
+{
+    NSString* pkeyAuthString = @"nonce=\"4AuJ5sPw6YrIX3Js0mfUtRfbGqVX9h2tVzDtRR6P8LA\", CertAuthorities=\"OU=82dbaca4-3e81-46ca-9c73-0950c1eaca97,CN=MS-Organization-Access,DC=windows,DC=net\", Version=\"1.0\", Context=\"rQIIAbNSzigpKSi20tcvyC8qSczRy81MLsovzk8ryc_LycxL1UvOz9XLL0rPTAGxioS4BKKtds_puRVqzzSZcVxB7mEBf\"";
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++)
+        {
+            [ADWebAuthResponse parseAuthHeader:pkeyAuthString];
+        }
+    }];
+}
+
+#pragma mark - Response parsing
+
+- (ADWebResponse *)webResponseWithStatusCode:(NSInteger)statusCode body:(NSData *)body
+{
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:TEST_AUTHORITY "/oauth2/token"]
+                                                              statusCode:statusCode
+                                                             HTTPVersion:@"1.1"
+                                                            headerFields:@{}];
+    
+    return [[ADWebResponse alloc] initWithResponse:response data:body];
+}
+
+- (NSData *)tokenResponseBody
+{
+    NSDictionary *json = @{ MSID_OAUTH2_ACCESS_TOKEN : TEST_ACCESS_TOKEN,
+                            MSID_OAUTH2_REFRESH_TOKEN : TEST_REFRESH_TOKEN,
+                            MSID_OAUTH2_TOKEN_TYPE : TEST_ACCESS_TOKEN_TYPE,
+                            MSID_OAUTH2_RESOURCE : TEST_RESOURCE,
+                            MSID_OAUTH2_EXPIRES_IN : @"3600",
+                            MSID_OAUTH2_ID_TOKEN : [self adDefaultIDToken] };
+    
+    return [NSJSONSerialization dataWithJSONObject:json options:0 error:nil];
+}
+
+- (void)testJSONObject_whenCalledTwice_shouldParseOnce
+{
+    ADWebResponse *webResponse = [self webResponseWithStatusCode:200 body:[self tokenResponseBody]];
+    
+    id jsonObject = [webResponse JSONObject:nil];
+    
+    XCTAssertTrue([jsonObject isKindOfClass:[NSDictionary class]]);
+    XCTAssertEqual([webResponse JSONObject:nil], jsonObject);
+}
+
+- (void)testJSONObject_whenBodyIsHTML_shouldReturnErrorOnEveryCall
+{
+    NSData *body = [@"<html><body>Service unavailable</body></html>" dataUsingEncoding:NSUTF8StringEncoding];
+    ADWebResponse *webResponse = [self webResponseWithStatusCode:200 body:body];
+    
+    NSError *error = nil;
+    XCTAssertNil([webResponse JSONObject:&error]);
+    XCTAssertNotNil(error);
+    
+    error = nil;
+    XCTAssertNil([webResponse JSONObject:&error]);
+    XCTAssertNotNil(error);
+}
+
+- (void)testProcessResponse_whenTokenResponse_shouldReturnServerValuesAndURL
+{
+    ADWebResponse *webResponse = [self webResponseWithStatusCode:200 body:[self tokenResponseBody]];
+    ADWebAuthRequest *request = [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:TEST_AUTHORITY "/oauth2/token"] context:nil];
+    
+    __block NSDictionary *responseDictionary = nil;
+    [ADWebAuthResponse processResponse:webResponse
+                               request:request
+                            completion:^(ADAuthenticationError *error, NSMutableDictionary *response)
+     {
+         XCTAssertNil(error);
+         responseDictionary = response;
+     }];
+    
+    XCTAssertEqualObjects(responseDictionary[MSID_OAUTH2_ACCESS_TOKEN], TEST_ACCESS_TOKEN);
+    XCTAssertEqualObjects(responseDictionary[MSID_OAUTH2_REFRESH_TOKEN], TEST_REFRESH_TOKEN);
+    XCTAssertEqualObjects(responseDictionary[@"url"], webResponse.URL);
+    
+    [request invalidate];
+}
+
+- (void)testProcessResponse_shouldNotModifyParsedJSON
+{
+    ADWebResponse *webResponse = [self webResponseWithStatusCode:200 body:[self tokenResponseBody]];
+    ADWebAuthRequest *request = [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:TEST_AUTHORITY "/oauth2/token"] context:nil];
+    
+    NSDictionary *jsonObject = [webResponse JSONObject:nil];
+    NSDictionary *original = [jsonObject copy];
+    
+    [ADWebAuthResponse processResponse:webResponse
+                               request:request
+                            completion:^(ADAuthenticationError *error, NSMutableDictionary *response)
+     {
+         XCTAssertNil(error);
+         XCTAssertNotEqual(response, jsonObject);
+         XCTAssertEqualObjects(response[@"url"], webResponse.URL);
+     }];
+    
+    XCTAssertEqualObjects([webResponse JSONObject:nil], original);
+    XCTAssertNil(jsonObject[@"url"]);
+    
+    [request invalidate];
+}
+
+- (void)testPerformance_processTokenResponse
+{
+    NSData *body = [self tokenResponseBody];
+    ADWebAuthRequest *request = [[ADWebAuthRequest alloc] initWithURL:[NSURL URLWithString:TEST_AUTHORITY "/oauth2/token"] context:nil];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            ADWebResponse *webResponse = [self webResponseWithStatusCode:200 body:body];
+            
+            // Telemetry looks at the body first, then the response handler
+            [webResponse JSONObject:nil];
+            [ADWebAuthResponse processResponse:webResponse
+                                       request:request
+                                    completion:^(__unused ADAuthenticationError *error, __unused NSMutableDictionary *response) {}];
+        }
+    }];
+    
+    [request invalidate];
+}
 @end
@@ -89,4 +89,123 @@ enum {
     XCTAssertEqualObjects(decrypted, [payload dataUsingEncoding:NSUTF8StringEncoding]);
 }
 
+- (void)testDecryptWithHash_whenHashMatches_shouldReturnDecryptedData
+{
+    [ADBrokerKeyHelper setSymmetricKey:@"BU-bLN3zTfHmyhJ325A8dJJ1tzrnKMHEfsTlStdMo0U"];
+    ADBrokerKeyHelper* keyHelper = [[ADBrokerKeyHelper alloc] init];
+    ADAuthenticationError* error = nil;
+    
+    NSData* payload = [self syntheticBrokerPayload:1024];
+    NSData* decrypted = [keyHelper decryptBrokerResponse:[self encryptBrokerPayload:payload]
+                                                 version:2
+                                                    hash:[self hashForBrokerPayload:payload]
+                                                   error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(decrypted, payload);
+    
+    // The broker sends the hash in upper case, but the digests are what get compared
+    decrypted = [keyHelper decryptBrokerResponse:[self encryptBrokerPayload:payload]
+                                         version:2
+                                            hash:[[self hashForBrokerPayload:payload] lowercaseString]
+                                           error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(decrypted, payload);
+}
+
+- (void)testDecryptWithHash_whenHashDoesNotMatch_shouldReturnHashMismatchError
+{
+    [ADBrokerKeyHelper setSymmetricKey:@"BU-bLN3zTfHmyhJ325A8dJJ1tzrnKMHEfsTlStdMo0U"];
+    ADBrokerKeyHelper* keyHelper = [[ADBrokerKeyHelper alloc] init];
+    
+    NSData* payload = [self syntheticBrokerPayload:1024];
+    NSData* otherPayload = [self syntheticBrokerPayload:1025];
+    
+    for (NSString *hash in @[ [self hashForBrokerPayload:otherPayload], @"not a hash", @"" ])
+    {
+        ADAuthenticationError* error = nil;
+        NSData* decrypted = [keyHelper decryptBrokerResponse:[self encryptBrokerPayload:payload]
+                                                     version:2
+                                                        hash:hash
+                                                       error:&error];
+        XCTAssertNil(decrypted);
+        XCTAssertEqual(error.code, AD_ERROR_TOKENBROKER_RESPONSE_HASH_MISMATCH);
+    }
+}
+
+- (void)testDecryptWithHash_whenCorruptResponse_shouldReturnDecryptionError
+{
+    [ADBrokerKeyHelper setSymmetricKey:@"BU-bLN3zTfHmyhJ325A8dJJ1tzrnKMHEfsTlStdMo0U"];
+    ADBrokerKeyHelper* keyHelper = [[ADBrokerKeyHelper alloc] init];
+    ADAuthenticationError* error = nil;
+    
+    NSData* payload = [self syntheticBrokerPayload:1024];
+    NSData* encrypted = [[self encryptBrokerPayload:payload] subdataWithRange:NSMakeRange(0, 1000)];
+    NSData* decrypted = [keyHelper decryptBrokerResponse:encrypted
+                                                 version:2
+                                                    hash:[self hashForBrokerPayload:payload]
+                                                   error:&error];
+    XCTAssertNil(decrypted);
+    XCTAssertEqual(error.code, AD_ERROR_TOKENBROKER_DECRYPTION_FAILED);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformance_decryptBrokerResponseWithHash
+{
+    [ADBrokerKeyHelper setSymmetricKey:@"BU-bLN3zTfHmyhJ325A8dJJ1tzrnKMHEfsTlStdMo0U"];
+    
+    // Roughly the size of a broker response carrying an access token, refresh token and id token
+    NSData* payload = [self syntheticBrokerPayload:8 * 1024];
+    NSData* encrypted = [self encryptBrokerPayload:payload];
+    NSString* hash = [self hashForBrokerPayload:payload];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; i++)
+        {
+            ADBrokerKeyHelper* keyHelper = [[ADBrokerKeyHelper alloc] init];
+            [keyHelper decryptBrokerResponse:encrypted version:2 hash:hash error:nil];
+        }
+    }];
+}
+
+#pragma mark - Helpers
+
+- (NSData *)syntheticBrokerPayload:(NSUInteger)length
+{
+    NSMutableData* payload = [NSMutableData dataWithLength:length];
+    uint8_t* bytes = payload.mutableBytes;
+    for (NSUInteger i = 0; i < length; i++)
+    {
+        bytes[i] = (uint8_t)('a' + (i % 26));
+    }
+    return payload;
+}
+
+- (NSData *)encryptBrokerPayload:(NSData *)payload
+{
+    NSData* key = [ADBrokerKeyHelper symmetricKey];
+    NSMutableData* encrypted = [NSMutableData dataWithLength:payload.length + kCCBlockSizeAES128];
+    size_t encryptedLength = 0;
+    CCCrypt(kCCEncrypt, kCCAlgorithmAES128, kCCOptionPKCS7Padding,
+            key.bytes, key.length, NULL,
+            payload.bytes, payload.length,
+            encrypted.mutableBytes, encrypted.length,
+            &encryptedLength);
+    encrypted.length = encryptedLength;
+    return encrypted;
+}
+
+- (NSString *)hashForBrokerPayload:(NSData *)payload
+{
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(payload.bytes, (CC_LONG)payload.length, digest);
+    
+    NSMutableString* hash = [NSMutableString new];
+    for (NSUInteger i = 0; i < sizeof(digest); i++)
+    {
+        [hash appendFormat:@"%02X", digest[i]];
+    }
+    return hash;
+}
+
 @end
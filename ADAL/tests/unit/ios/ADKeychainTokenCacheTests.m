@@ -31,6 +31,8 @@
 #import "ADTokenCacheItem+Internal.h"
 #import "ADUserInformation.h"
 #import "ADTokenCacheKey.h"
+#import "ADTokenCacheRegistry.h"
+#import "MSIDKeychainTokenCache.h"
 
 //Some logging constant to help with testing the persistence:
 NSString* const sPersisted = @"successfully persisted";
@@ -571,5 +573,61 @@ NSString* const sFileNameEmpty = @"Invalid or empty file name";
     XCTAssertEqual(status, errSecSuccess);
 }
 
+#pragma mark - Shared caches
+
+- (void)testKeychainCacheForGroup_whenSameGroup_shouldReturnSameInstance
+{
+    ADKeychainTokenCache *cache = [ADKeychainTokenCache keychainCacheForGroup:@"com.contoso.shared"];
+    
+    XCTAssertEqual(cache, [ADKeychainTokenCache keychainCacheForGroup:@"com.contoso.shared"]);
+    XCTAssertNotEqual(cache, [ADKeychainTokenCache keychainCacheForGroup:@"com.contoso.other"]);
+    XCTAssertEqual([ADKeychainTokenCache keychainCacheForGroup:nil], [ADKeychainTokenCache defaultKeychainCache]);
+}
+
+- (void)testRegistryKeychainCacheForGroup_whenSameGroup_shouldShareDataSourceAccessorAndWrapper
+{
+    ADTokenCacheRegistry *registry = [ADTokenCacheRegistry sharedRegistry];
+    MSIDKeychainTokenCache *dataSource = [registry keychainCacheForGroup:@"com.contoso.shared"];
+    
+    XCTAssertNotNil(dataSource);
+    XCTAssertEqual(dataSource, [registry keychainCacheForGroup:@"com.contoso.shared"]);
+    XCTAssertEqual([registry keychainCacheForGroup:nil], MSIDKeychainTokenCache.defaultKeychainCache);
+    
+    XCTAssertNotNil([registry accessorForDataSource:dataSource]);
+    XCTAssertEqual([registry accessorForDataSource:dataSource], [registry accessorForDataSource:dataSource]);
+    XCTAssertEqual([registry wrapperForDataSource:dataSource], [registry wrapperForDataSource:dataSource]);
+    XCTAssertNotEqual([registry accessorForDataSource:dataSource], [ADTokenCacheRegistry createAccessorForDataSource:dataSource]);
+}
+
+- (void)testRegistryAccessorForDataSource_whenCalledConcurrently_shouldCreateOneAccessor
+{
+    ADTokenCacheRegistry *registry = [ADTokenCacheRegistry sharedRegistry];
+    MSIDKeychainTokenCache *dataSource = [registry keychainCacheForGroup:@"com.contoso.concurrent"];
+    
+    // The registry keeps the accessor alive, so holding on to plain pointers is fine
+    void **accessors = calloc(64, sizeof(void *));
+    dispatch_apply(64, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        accessors[i] = (__bridge void *)[registry accessorForDataSource:dataSource];
+    });
+    
+    for (int i = 1; i < 64; i++)
+    {
+        XCTAssertEqual(accessors[0], accessors[i]);
+    }
+    
+    free(accessors);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformance_keychainCacheForGroup_whenCalledPerContext
+{
+    [self measureBlock:^{
+        for (int i = 0; i < 1000; i++)
+        {
+            [ADKeychainTokenCache keychainCacheForGroup:@"com.contoso.shared"];
+        }
+    }];
+}
 
 @end